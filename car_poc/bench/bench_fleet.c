@@ -0,0 +1,108 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "fleet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_VEHICLES (100000U)
+#define BENCH_DEFAULT_TICKS    (1000U)
+
+/* "close": every vehicle has an obstacle within time-to-collision reach
+ * and a new distance sample every tick, the worst case for the TTC pass.
+ * "cruise": 20-60 m gaps sampled at 10 Hz, so most vehicle-ticks skip it. */
+#define BENCH_CRUISE_GAP_MM     (20000U)
+#define BENCH_CRUISE_PERIOD_MS  (100U)
+
+static fleet_t fleet;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static void fill_inputs(uint32_t count, bool cruise) {
+    uint32_t seed = 12345U;
+    uint32_t v = 0U;
+    
+    for (v = 0U; v < count; v++) {
+        seed = (seed * 1103515245U) + 12345U;
+        fleet.in_distance_valid[v] = 1U;
+        fleet.in_distance_mm[v] = cruise ?
+            (uint16_t)(BENCH_CRUISE_GAP_MM + ((seed >> 8) % 40000U)) :
+            (uint16_t)(800U + ((seed >> 8) % 900U));
+        fleet.in_rain_valid[v] = 1U;
+        fleet.in_rain_pct[v] = (uint16_t)((seed >> 12) % 101U);
+        fleet.in_speed_valid[v] = 1U;
+        fleet.in_speed_kph[v] = (uint16_t)(30U + ((seed >> 16) % 60U));
+    }
+}
+
+static void refresh_timestamps(uint32_t count, uint32_t now_ms, bool cruise) {
+    uint32_t distance_ts_ms = cruise ? (now_ms - (now_ms % BENCH_CRUISE_PERIOD_MS)) : now_ms;
+    uint32_t v = 0U;
+    
+    for (v = 0U; v < count; v++) {
+        fleet.in_distance_ts_ms[v] = distance_ts_ms;
+        fleet.in_rain_ts_ms[v] = now_ms;
+        fleet.in_speed_ts_ms[v] = now_ms;
+    }
+}
+
+static void run_isa(fleet_isa_e isa, uint32_t count, uint32_t ticks, bool cruise, bool ttc) {
+    uint64_t busy_ns = 0U;
+    uint64_t start_ns = 0U;
+    uint32_t tick = 0U;
+    double vticks_per_s = 0.0;
+    
+    (void)fleet_init(&fleet, count);
+    if (!fleet_set_isa(&fleet, isa)) {
+        printf("%-8s not supported on this CPU\n", fleet_isa_name(isa));
+        return;
+    }
+    fleet.ttc_enabled = ttc;
+    fill_inputs(count, cruise);
+    
+    for (tick = 0U; tick < ticks; tick++) {
+        fleet.now_ms = tick * 10U;
+        refresh_timestamps(count, fleet.now_ms, cruise);
+        
+        start_ns = now_ns();
+        fleet_step(&fleet);
+        busy_ns += now_ns() - start_ns;
+    }
+    
+    vticks_per_s = ((double)count * (double)ticks) / ((double)busy_ns / 1e9);
+    printf("%-8s %-6s %-7s %8u vehicles x %6u ticks: %10.3f ms, %8.2f M vehicle-ticks/s\n",
+           fleet_isa_name(isa), cruise ? "cruise" : "close", ttc ? "ttc" : "no-ttc", count, ticks, (double)busy_ns / 1e6, vticks_per_s / 1e6);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t count = BENCH_DEFAULT_VEHICLES;
+    uint32_t ticks = BENCH_DEFAULT_TICKS;
+    
+    if (argc > 1) {
+        count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        ticks = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+    if ((count == 0U) || (count > FLEET_MAX_VEHICLES)) {
+        fprintf(stderr, "vehicle count must be 1..%u\n", FLEET_MAX_VEHICLES);
+        return 1;
+    }
+    
+    run_isa(FLEET_ISA_SCALAR, count, ticks, false, true);
+    run_isa(FLEET_ISA_SSE2, count, ticks, false, true);
+    run_isa(FLEET_ISA_AVX2, count, ticks, false, true);
+    run_isa(FLEET_ISA_SCALAR, count, ticks, true, true);
+    run_isa(FLEET_ISA_SSE2, count, ticks, true, true);
+    run_isa(FLEET_ISA_AVX2, count, ticks, true, true);
+    run_isa(FLEET_ISA_SCALAR, count, ticks, false, false);
+    run_isa(FLEET_ISA_SSE2, count, ticks, false, false);
+    run_isa(FLEET_ISA_AVX2, count, ticks, false, false);
+    
+    return 0;
+}
@@ -0,0 +1,213 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "scenario.h"
+#include "scenario_stream.h"
+#include "scenario_load.h"
+#include "scenario_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_ROWS (2000000U)
+#define BENCH_DEFAULT_PATH "/tmp/bench_scenario.csv"
+#define BENCH_HEADER "ms,distance_mm,rain_pct,speed_kph,sign_event,gap_found," \
+                     "gap_width_mm,cabin_tc_x10,ambient_tc_x10,humid_pct,setpoint_x10,"
+#define BENCH_MAX_EXTRA (SCENARIO_MAX_FIELDS - 12U)
+
+typedef bool (*open_fn)(scenario_reader_t* reader, const char* filename);
+
+static scenario_stream_t stream;
+static scenario_gen_t gen;
+static char gen_desc[64];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/* Writes `rows` synthetic rows. `extra` unknown columns before voice_cmd
+ * make the wide rows of logger exports, which the readers skip. */
+static long write_scenario(const char* path, uint32_t rows, uint32_t extra) {
+    FILE* file = fopen(path, "w");
+    uint32_t seed = 12345U;
+    uint32_t i = 0U;
+    uint32_t c = 0U;
+    long size = 0;
+    
+    if (file == NULL) {
+        return -1;
+    }
+    
+    fputs(BENCH_HEADER, file);
+    for (c = 0U; c < extra; c++) {
+        fprintf(file, "aux%u,", c);
+    }
+    fputs("voice_cmd\n", file);
+    for (i = 0U; i < rows; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        fprintf(file, "%u,%u,%u,%u,%u,%u,%u,%d,%d,%u,%d,",
+                i * 10U,
+                800U + ((seed >> 8) % 1500U),
+                (seed >> 12) % 101U,
+                30U + ((seed >> 16) % 90U),
+                ((seed % 97U) == 0U) ? 80U : 0U,
+                (seed >> 20) & 1U,
+                4000U + ((seed >> 4) % 3000U),
+                200 + (int)((seed >> 6) % 60U),
+                -50 + (int)((seed >> 10) % 400U),
+                30U + ((seed >> 14) % 50U),
+                220);
+        for (c = 0U; c < extra; c++) {
+            fprintf(file, "%u,", (seed >> (c % 16U)) % 1000U);
+        }
+        fprintf(file, "%s\n", ((seed % 1009U) == 0U) ? "hey car set temp 21" : "");
+    }
+    
+    size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static bool open_stream(scenario_reader_t* reader, const char* filename) {
+    return scenario_reader_open_stream(reader, &stream, filename, false);
+}
+
+static bool open_generated(scenario_reader_t* reader, const char* filename) {
+    (void)filename;
+    return scenario_reader_open_generated(reader, &gen, gen_desc);
+}
+
+static void run_reader(const char* label, open_fn open_reader, const char* path, long bytes) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    uint64_t start_ns = 0U;
+    uint64_t elapsed_ns = 0U;
+    uint32_t rows = 0U;
+    uint32_t checksum = 0U;
+    
+    if (!open_reader(&reader, path)) {
+        printf("%-12s failed to open %s\n", label, path);
+        return;
+    }
+    
+    start_ns = now_ns();
+    while (scenario_reader_next(&reader, &row)) {
+        checksum += row.ms + row.distance_mm + row.speed_kph + (uint32_t)(uint8_t)row.voice_cmd[0];
+        rows++;
+    }
+    elapsed_ns = now_ns() - start_ns;
+    scenario_reader_close(&reader);
+    
+    printf("%-12s %9u rows %8.1f MB/s %8.2f ns/row (checksum %08x)\n",
+           label, rows,
+           ((double)bytes / 1.0e6) / ((double)elapsed_ns / 1.0e9),
+           (double)elapsed_ns / (double)rows, checksum);
+}
+
+/* Whole-file parallel load into one row array; the array is sized by a
+ * first counting call and is not part of the timing. */
+static void run_load(const char* path, long bytes) {
+    scenario_load_result_t result;
+    scenario_row_t* rows = NULL;
+    uint64_t start_ns = 0U;
+    uint64_t elapsed_ns = 0U;
+    uint32_t checksum = 0U;
+    uint64_t i = 0U;
+    char label[32];
+    
+    (void)scenario_load(path, 0U, NULL, 0U, &result);
+    rows = (scenario_row_t*)malloc((size_t)result.row_count * sizeof(scenario_row_t));
+    if ((rows == NULL) || (result.row_count == 0U)) {
+        printf("%-12s cannot allocate %llu rows\n", "load", (unsigned long long)result.row_count);
+        free(rows);
+        return;
+    }
+    
+    start_ns = now_ns();
+    if (!scenario_load(path, 0U, rows, result.row_count, &result)) {
+        printf("%-12s %s at row %llu\n", "load", scenario_load_status_name(result.status),
+               (unsigned long long)result.error_row);
+        free(rows);
+        return;
+    }
+    elapsed_ns = now_ns() - start_ns;
+    
+    for (i = 0U; i < result.row_count; i++) {
+        checksum += rows[i].ms + rows[i].distance_mm + rows[i].speed_kph +
+                    (uint32_t)(uint8_t)rows[i].voice_cmd[0];
+    }
+    free(rows);
+    
+    (void)snprintf(label, sizeof(label), "load/%ut", result.threads);
+    printf("%-12s %9llu rows %8.1f MB/s %8.2f ns/row (checksum %08x)\n",
+           label, (unsigned long long)result.row_count,
+           ((double)bytes / 1.0e6) / ((double)elapsed_ns / 1.0e9),
+           (double)elapsed_ns / (double)result.row_count, checksum);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t rows = BENCH_DEFAULT_ROWS;
+    const char* path = BENCH_DEFAULT_PATH;
+    long bytes = 0;
+    FILE* compiled = NULL;
+    char label[32];
+    uint32_t isa = 0U;
+    uint32_t extra = 0U;
+    
+    if (argc > 1) {
+        rows = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        path = argv[2];
+    }
+    if (argc > 4) {
+        extra = (uint32_t)strtoul(argv[4], NULL, 10);
+        if (extra > BENCH_MAX_EXTRA) {
+            extra = BENCH_MAX_EXTRA;
+        }
+    }
+    
+    bytes = write_scenario(path, rows, extra);
+    if (bytes <= 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    printf("%s: %u rows, %u extra columns, %.1f MB\n", path, rows, extra,
+           (double)bytes / 1.0e6);
+    
+    run_reader("buffered", scenario_reader_open_buffered, path, bytes);
+    run_reader("stream", open_stream, path, bytes);
+    
+    /* The mapped path once per CSV tokenizer, best last so it stays active. */
+    for (isa = SCENARIO_ISA_SCALAR; isa <= SCENARIO_ISA_AVX2; isa++) {
+        if (scenario_set_isa((scenario_isa_e)isa)) {
+            (void)snprintf(label, sizeof(label), "mmap/%s", scenario_isa_name((scenario_isa_e)isa));
+            run_reader(label, scenario_reader_open, path, bytes);
+        }
+    }
+    run_load(path, bytes);
+    
+    /* Same row count from the generator; MB/s is of the equivalent CSV. */
+    (void)snprintf(gen_desc, sizeof(gen_desc), "rows=%u", rows);
+    run_reader("generated", open_generated, path, bytes);
+    
+    /* A compiled file made with scenario_compile is timed as-is; "-" skips
+     * it so extra columns can be given alone. */
+    if ((argc > 3) && (strcmp(argv[3], "-") != 0)) {
+        compiled = fopen(argv[3], "rb");
+        if (compiled != NULL) {
+            (void)fseek(compiled, 0L, SEEK_END);
+            bytes = ftell(compiled);
+            fclose(compiled);
+            run_reader("compiled", scenario_reader_open, argv[3], bytes);
+        }
+    }
+    
+    if (getenv("BENCH_KEEP") == NULL) {
+        (void)remove(path);
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#define _GNU_SOURCE
+
+#include "spsc_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_MESSAGES (20000000U)
+#define BENCH_RING_SLOTS       (1024U)
+#define BENCH_PING_SAMPLES     (100000U)
+/* Polls before a waiting side yields, so a host with a single CPU still
+ * makes progress when both threads share it. */
+#define BENCH_SPIN_LIMIT       (1000U)
+
+typedef struct {
+    spsc_ring_t ring;
+    uint64_t slots[BENCH_RING_SLOTS];
+} bench_channel_t;
+
+static bench_channel_t forward;
+static bench_channel_t backward;
+static uint32_t message_count = BENCH_DEFAULT_MESSAGES;
+static uint32_t consumer_cpu = 1U;
+static uint32_t ping_ns[BENCH_PING_SAMPLES];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static bool pin_to(uint32_t cpu) {
+    cpu_set_t set;
+    
+    CPU_ZERO(&set);
+    CPU_SET((size_t)cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+static void spin_wait(uint32_t* spins) {
+    (*spins)++;
+    if (*spins >= BENCH_SPIN_LIMIT) {
+        *spins = 0U;
+        (void)sched_yield();
+    }
+}
+
+static void channel_send(bench_channel_t* channel, uint64_t value) {
+    uint32_t slot = 0U;
+    uint32_t spins = 0U;
+    
+    while (!spsc_ring_acquire(&channel->ring, &slot)) {
+        spin_wait(&spins);
+    }
+    channel->slots[slot] = value;
+    spsc_ring_publish(&channel->ring);
+}
+
+static uint64_t channel_receive(bench_channel_t* channel) {
+    uint64_t value = 0U;
+    uint32_t slot = 0U;
+    uint32_t spins = 0U;
+    
+    while (!spsc_ring_peek(&channel->ring, &slot)) {
+        spin_wait(&spins);
+    }
+    value = channel->slots[slot];
+    spsc_ring_release(&channel->ring);
+    return value;
+}
+
+static void* consume_main(void* arg) {
+    uint64_t* sum = (uint64_t*)arg;
+    uint32_t i = 0U;
+    
+    (void)pin_to(consumer_cpu);
+    for (i = 0U; i < message_count; i++) {
+        *sum += channel_receive(&forward);
+    }
+    
+    return NULL;
+}
+
+static void* echo_main(void* arg) {
+    uint32_t i = 0U;
+    
+    (void)arg;
+    (void)pin_to(consumer_cpu);
+    for (i = 0U; i < BENCH_PING_SAMPLES; i++) {
+        channel_send(&backward, channel_receive(&forward));
+    }
+    
+    return NULL;
+}
+
+static void run_throughput(void) {
+    pthread_t consumer;
+    uint64_t expected = ((uint64_t)message_count * (uint64_t)(message_count - 1U)) / 2U;
+    uint64_t sum = 0U;
+    uint64_t start = 0U;
+    uint64_t elapsed = 0U;
+    uint32_t i = 0U;
+    
+    spsc_ring_init(&forward.ring, BENCH_RING_SLOTS);
+    if (pthread_create(&consumer, NULL, consume_main, &sum) != 0) {
+        printf("throughput   cannot start consumer\n");
+        return;
+    }
+    
+    start = now_ns();
+    for (i = 0U; i < message_count; i++) {
+        channel_send(&forward, i);
+    }
+    (void)pthread_join(consumer, NULL);
+    elapsed = now_ns() - start;
+    
+    printf("throughput   %9u msgs %8.2f M msgs/s %8.2f ns/msg (%s)\n",
+           message_count, ((double)message_count * 1000.0) / (double)elapsed,
+           (double)elapsed / (double)message_count, (sum == expected) ? "ok" : "MISMATCH");
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    
+    return (x > y) - (x < y);
+}
+
+/* One message there and back per sample; a one-way hand-over is about
+ * half the round trip. */
+static void run_latency(void) {
+    pthread_t echo;
+    uint64_t start = 0U;
+    uint32_t i = 0U;
+    
+    spsc_ring_init(&forward.ring, BENCH_RING_SLOTS);
+    spsc_ring_init(&backward.ring, BENCH_RING_SLOTS);
+    if (pthread_create(&echo, NULL, echo_main, NULL) != 0) {
+        printf("round trip   cannot start echo thread\n");
+        return;
+    }
+    
+    for (i = 0U; i < BENCH_PING_SAMPLES; i++) {
+        start = now_ns();
+        channel_send(&forward, i);
+        (void)channel_receive(&backward);
+        ping_ns[i] = (uint32_t)(now_ns() - start);
+    }
+    (void)pthread_join(echo, NULL);
+    
+    qsort(ping_ns, BENCH_PING_SAMPLES, sizeof(uint32_t), compare_u32);
+    printf("round trip   %9u msgs min %6u ns, p50 %6u ns, p99 %6u ns, max %8u ns\n",
+           BENCH_PING_SAMPLES, ping_ns[0], ping_ns[BENCH_PING_SAMPLES / 2U],
+           ping_ns[(BENCH_PING_SAMPLES * 99U) / 100U], ping_ns[BENCH_PING_SAMPLES - 1U]);
+}
+
+int main(int argc, char* argv[]) {
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t producer_cpu = 0U;
+    bool pinned = false;
+    
+    if (argc > 1) {
+        message_count = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        producer_cpu = (uint32_t)strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3) {
+        consumer_cpu = (uint32_t)strtoul(argv[3], NULL, 10);
+    } else if (online_cpus < 2) {
+        consumer_cpu = producer_cpu;
+    } else {
+    }
+    
+    if (message_count < 2U) {
+        fprintf(stderr, "message count must be at least 2\n");
+        return 1;
+    }
+    
+    pinned = pin_to(producer_cpu);
+    printf("producer on cpu %u, consumer on cpu %u%s, %ld cpus online, %s atomics\n",
+           producer_cpu, consumer_cpu, pinned ? "" : " (pinning failed)", online_cpus,
+           SPSC_RING_C11_ATOMICS ? "C11" : "builtin");
+    
+    run_throughput();
+    run_latency();
+    return 0;
+}
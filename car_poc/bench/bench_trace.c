@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "trace_log.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_CALLS (2000000U)
+#define BENCH_DRAIN_POLL_NS (100000L)
+
+static trace_log_t trace;
+static FILE* sink = NULL;
+static bool stop = false;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static void* drain_main(void* arg) {
+    struct timespec ts = {0, BENCH_DRAIN_POLL_NS};
+    uint64_t* drained = (uint64_t*)arg;
+    
+    while (!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+        *drained += trace_log_drain(&trace, sink);
+        (void)nanosleep(&ts, NULL);
+    }
+    *drained += trace_log_drain(&trace, sink);
+    return NULL;
+}
+
+/* What a call site paid before: format and write on the calling thread. */
+static void run_printf(uint32_t calls) {
+    uint64_t start = now_ns();
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < calls; i++) {
+        fprintf(sink, "Voice: %s -> %s\n", "hey car turn on radio", "Turning on radio");
+    }
+    printf("fprintf      %9u calls %8.1f ns/call\n", calls,
+           (double)(now_ns() - start) / (double)calls);
+}
+
+/* Times bursts of one ring's worth of calls and lets the drain thread
+ * catch up between them untimed, so every call finds a free entry. The
+ * best burst shows the cost without the drain thread preempting the
+ * caller, which it does on a host with a single CPU. */
+static void run_trace(uint32_t calls) {
+    pthread_t drainer;
+    uint64_t drained = 0U;
+    uint64_t start = 0U;
+    uint64_t elapsed = 0U;
+    uint64_t burst = 0U;
+    uint64_t best = UINT64_MAX;
+    uint32_t done = 0U;
+    uint32_t i = 0U;
+    
+    trace_log_init(&trace);
+    if (pthread_create(&drainer, NULL, drain_main, &drained) != 0) {
+        printf("trace        cannot start drain thread\n");
+        return;
+    }
+    
+    while (done < calls) {
+        start = now_ns();
+        for (i = 0U; (i < TRACE_LOG_SLOTS) && (done < calls); i++) {
+            if (trace_log_begin(&trace, TRACE_ID_VOICE_COMMAND)) {
+                trace_log_str(&trace, "hey car turn on radio");
+                trace_log_str(&trace, "Turning on radio");
+                trace_log_commit(&trace);
+            }
+            done++;
+        }
+        burst = now_ns() - start;
+        elapsed += burst;
+        best = ((i == TRACE_LOG_SLOTS) && (burst < best)) ? burst : best;
+        
+        while (SPSC_RING_LOAD_ACQUIRE(&trace.ring.tail) != trace.ring.head) {
+            (void)sched_yield();
+        }
+    }
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+    (void)pthread_join(drainer, NULL);
+    
+    printf("trace        %9u calls %8.1f ns/call, best burst %.1f ns/call "
+           "(%llu formatted, %u dropped)\n", calls, (double)elapsed / (double)calls,
+           (double)best / (double)TRACE_LOG_SLOTS, (unsigned long long)drained, trace.dropped);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t calls = BENCH_DEFAULT_CALLS;
+    
+    if (argc > 1) {
+        calls = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    
+    sink = fopen("/dev/null", "w");
+    if (sink == NULL) {
+        fprintf(stderr, "Cannot open /dev/null\n");
+        return 1;
+    }
+    
+    run_printf(calls);
+    run_trace(calls);
+    fclose(sink);
+    return 0;
+}
@@ -5,10 +5,32 @@
 
 #define AB_THRESHOLD_MM            (1220U)
 #define AB_DEBOUNCE_HITS          (3U)
+/* Distance-array sectors facing the driving corridor (bit per sector). */
+#define AB_SECTOR_MASK            (0x3CU)
+
+/* Time-to-collision path: a line fitted through the distance samples of
+ * the last AB_TTC_WINDOW_MS gives the closing rate. A fit from at least
+ * AB_TTC_FULL_SAMPLES samples counts twice towards AB_TTC_CONFIRM. Fits
+ * faster than own speed plus AB_TTC_SPEED_TOL_MM_S are treated as
+ * sensor glitches. */
+#define AB_TTC_HORIZON_MS         (1000U)
+#define AB_TTC_SAMPLES            (8U)
+#define AB_TTC_MIN_SAMPLES        (4U)
+#define AB_TTC_FULL_SAMPLES       (6U)
+#define AB_TTC_WINDOW_MS          (500U)
+#define AB_TTC_MIN_SPEED_KPH      (10U)
+#define AB_TTC_MIN_CLOSING_MM_S   (100U)
+#define AB_TTC_SPEED_TOL_MM_S     (2000U)
+#define AB_TTC_CONFIRM            (2U)
 
 #define WIPER_T_RAIN_INT          (20U)
 #define WIPER_T_RAIN_LOW          (45U)
 #define WIPER_T_RAIN_HIGH         (75U)
+/* Raw rain stream: each burst's mean without its largest sample is low-pass
+ * filtered by 1/2^RAIN_IIR_SHIFT per burst. The wipers follow a peak hold
+ * of that level, which falls by RAIN_PEAK_DECAY_Q8/256 % per burst. */
+#define RAIN_IIR_SHIFT            (4U)
+#define RAIN_PEAK_DECAY_Q8        (26U)
 
 #define SPEED_ALARM_TOL_KPH       (3U)
 #define SPEED_ALARM_DEBOUNCE      (2U)
@@ -20,5 +42,8 @@
 
 #define PARK_MIN_GAP_MM           (5000U)
 #define PARK_SCAN_LEN_SAMPLES     (50U)
+#define PARK_GAP_CONFIRM_MS       (30U)
+#define PARK_REVERSE_MS           (500U)
+#define PARK_STRAIGHTEN_MS        (200U)
 
 #endif /* CALIB_H */
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef FSM_CFG_H
+#define FSM_CFG_H
+
+#include "calib.h"
+#include "hyst_fsm.h"
+
+/* Hysteresis state machines, in the row format of inc/hyst_fsm.h:
+ * X(state, up_if, up_arg, up_to, down_if, down_arg, down_to). */
+
+/* Wiper mode (off, intermittent, low, high) by rain level in percent. A
+ * mode moves one level per step and drops 5 points below the threshold of
+ * the mode beneath it. */
+#define WIPER_FSM(X) \
+    X(0U, GE,    WIPER_T_RAIN_INT,  1U, NEVER, 0U,                    0U) \
+    X(1U, GE,    WIPER_T_RAIN_LOW,  2U, LT,    WIPER_T_RAIN_INT - 5U, 0U) \
+    X(2U, GE,    WIPER_T_RAIN_HIGH, 3U, LT,    WIPER_T_RAIN_INT - 5U, 1U) \
+    X(3U, NEVER, 0U,                3U, LT,    WIPER_T_RAIN_LOW - 5U, 2U)
+
+/* Overspeed alarm. The state is the overspeed count and the alarm is on
+ * in the last state, after SPEED_ALARM_DEBOUNCE ticks above the limit
+ * plus SPEED_ALARM_TOL_KPH (one arming row per tick). It clears below the
+ * limit less SPEED_HYSTERESIS_KPH. Both input bits can be set at once
+ * when the limit is under SPEED_HYSTERESIS_KPH. */
+#define SPEEDGOV_FSM_ABOVE    (1U)
+#define SPEEDGOV_FSM_CLEARING (2U)
+#define SPEEDGOV_FSM_ALARM    (SPEED_ALARM_DEBOUNCE)
+
+#define SPEEDGOV_FSM(X) \
+    X(0U, HAS,   SPEEDGOV_FSM_ABOVE, 1U, NEVER, 0U,                    0U) \
+    X(1U, HAS,   SPEEDGOV_FSM_ABOVE, 2U, LACKS, SPEEDGOV_FSM_ABOVE,    0U) \
+    X(2U, NEVER, 0U,                 2U, HAS,   SPEEDGOV_FSM_CLEARING, 0U)
+
+#endif /* FSM_CFG_H */
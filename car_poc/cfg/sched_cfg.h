@@ -0,0 +1,26 @@
+#ifndef SCHED_CFG_H
+#define SCHED_CFG_H
+
+#define SCHED_MINOR_FRAME_MS       (10U)
+#define SCHED_MAJOR_FRAME_MS       (1000U)
+
+#define SCHED_AUTOBRAKE_PERIOD_MS  (10U)
+#define SCHED_WIPERS_PERIOD_MS     (10U)
+#define SCHED_SPEEDGOV_PERIOD_MS   (10U)
+#define SCHED_AUTOPARK_PERIOD_MS   (50U)
+#define SCHED_VOICE_PERIOD_MS      (100U)
+#define SCHED_CLIMATE_PERIOD_MS    (1000U)
+
+/* One row per module: name, period, phase offset, priority (0 runs first,
+ * each value used once) and worst-case execution budget in microseconds.
+ * Phases keep the slower modules out of the same minor frame. `a` is passed
+ * through to X untouched. */
+#define SCHED_TABLE(X, a) \
+    X(a, autobrake, SCHED_AUTOBRAKE_PERIOD_MS,  0U, 0U, 200U) \
+    X(a, wipers,    SCHED_WIPERS_PERIOD_MS,     0U, 1U, 100U) \
+    X(a, speedgov,  SCHED_SPEEDGOV_PERIOD_MS,   0U, 2U, 100U) \
+    X(a, autopark,  SCHED_AUTOPARK_PERIOD_MS,  20U, 3U, 200U) \
+    X(a, climate,   SCHED_CLIMATE_PERIOD_MS,   40U, 4U, 300U) \
+    X(a, voice,     SCHED_VOICE_PERIOD_MS,     30U, 5U, 500U)
+
+#endif /* SCHED_CFG_H */
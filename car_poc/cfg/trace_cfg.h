@@ -0,0 +1,20 @@
+#ifndef TRACE_CFG_H
+#define TRACE_CFG_H
+
+/* One row per trace message: name and printf-style format. Only %u, %d,
+ * %x and %s are understood, and the call site has to put the arguments in
+ * format order with the matching trace_log_u32/i32/str(). A row's position
+ * is its ID in the log, so new rows go at the end. */
+#define TRACE_MESSAGES(X) \
+    X(VOICE_COMMAND, "Voice: %s -> %s\n") \
+    TRACE_TEST_MESSAGES(X)
+
+/* Rows only the unit test builds with, to cover every conversion. */
+#if defined(TRACE_TEST_BUILD) && TRACE_TEST_BUILD
+#define TRACE_TEST_MESSAGES(X) \
+    X(TEST_NUMBERS, "u=%u d=%d x=%x 100%%\n")
+#else
+#define TRACE_TEST_MESSAGES(X)
+#endif
+
+#endif /* TRACE_CFG_H */
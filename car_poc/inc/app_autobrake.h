@@ -1,7 +1,22 @@
 #ifndef APP_AUTOBRAKE_H
 #define APP_AUTOBRAKE_H
 
+#include "hal_io.h"
+#include "autobrake_ttc.h"
+
+/* Every sector in AB_SECTOR_MASK is debounced on its own; brake_active
+ * follows this distance-threshold path only, and the brake request is that
+ * or the time-to-collision path on the nearest sector. */
+typedef struct {
+    uint16_t hit_count[HAL_DISTANCE_SECTORS];
+    bool brake_active;
+    autobrake_ttc_t ttc;
+} autobrake_state_t;
+
 void app_autobrake_step(void);
 void app_autobrake_init(void);
 
-#endif /* APP_AUTOBRAKE_H */
\ No newline at end of file
+void app_autobrake_init_ctx(autobrake_state_t* ctx);
+void app_autobrake_step_ctx(autobrake_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_AUTOBRAKE_H */
@@ -1,7 +1,19 @@
 #ifndef APP_AUTOPARK_H
 #define APP_AUTOPARK_H
 
+#include "hal_io.h"
+
+typedef struct {
+    uint8_t state;
+    uint16_t step_counter;
+    uint8_t gap_detections;
+    bool gap_suitable;
+} autopark_state_t;
+
 void app_autopark_step(void);
 void app_autopark_init(void);
 
-#endif /* APP_AUTOPARK_H */
\ No newline at end of file
+void app_autopark_init_ctx(autopark_state_t* ctx);
+void app_autopark_step_ctx(autopark_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_AUTOPARK_H */
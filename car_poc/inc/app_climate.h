@@ -1,7 +1,21 @@
 #ifndef APP_CLIMATE_H
 #define APP_CLIMATE_H
 
+#include "hal_io.h"
+
+typedef struct {
+    int16_t setpoint_x10;
+    int32_t integral_accumulator;
+    uint32_t last_update_ms;
+    uint8_t current_fan_stage;
+    bool current_ac_on;
+    uint8_t current_blend_pct;
+} climate_state_t;
+
 void app_climate_step(void);
 void app_climate_init(void);
 
-#endif /* APP_CLIMATE_H */
\ No newline at end of file
+void app_climate_init_ctx(climate_state_t* ctx);
+void app_climate_step_ctx(climate_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_CLIMATE_H */
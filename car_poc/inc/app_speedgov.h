@@ -1,7 +1,18 @@
 #ifndef APP_SPEEDGOV_H
 #define APP_SPEEDGOV_H
 
+#include "hal_io.h"
+
+typedef struct {
+    uint16_t current_limit_kph;
+    uint8_t overspeed_count;
+    bool alarm_active;
+} speedgov_state_t;
+
 void app_speedgov_step(void);
 void app_speedgov_init(void);
 
-#endif /* APP_SPEEDGOV_H */
\ No newline at end of file
+void app_speedgov_init_ctx(speedgov_state_t* ctx);
+void app_speedgov_step_ctx(speedgov_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_SPEEDGOV_H */
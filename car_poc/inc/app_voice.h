@@ -1,7 +1,22 @@
 #ifndef APP_VOICE_H
 #define APP_VOICE_H
 
+#include "hal_io.h"
+#include "trace_log.h"
+
+#define VOICE_BUFFER_SIZE (64U)
+
+typedef struct {
+    char last_command[VOICE_BUFFER_SIZE];
+    char last_response[VOICE_BUFFER_SIZE];
+    /* Where recognised commands are traced; NULL traces nothing. */
+    trace_log_t* trace;
+} voice_state_t;
+
 void app_voice_step(void);
 void app_voice_init(void);
 
-#endif /* APP_VOICE_H */
\ No newline at end of file
+void app_voice_init_ctx(voice_state_t* ctx);
+void app_voice_step_ctx(voice_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_VOICE_H */
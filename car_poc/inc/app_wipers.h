@@ -1,7 +1,22 @@
 #ifndef APP_WIPERS_H
 #define APP_WIPERS_H
 
+#include "hal_io.h"
+
+/* Once raw rain bursts arrive, the wipers follow rain_peak_q8 (percent in
+ * Q8) instead of rain_pct, until the raw stream goes stale. */
+typedef struct {
+    uint8_t current_mode;
+    bool raw_seen;
+    uint32_t raw_ts_ms;
+    uint16_t rain_level_q8;
+    uint16_t rain_peak_q8;
+} wipers_state_t;
+
 void app_wipers_step(void);
 void app_wipers_init(void);
 
-#endif /* APP_WIPERS_H */
\ No newline at end of file
+void app_wipers_init_ctx(wipers_state_t* ctx);
+void app_wipers_step_ctx(wipers_state_t* ctx, hal_io_t* io);
+
+#endif /* APP_WIPERS_H */
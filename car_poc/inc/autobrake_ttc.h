@@ -0,0 +1,130 @@
+#ifndef AUTOBRAKE_TTC_H
+#define AUTOBRAKE_TTC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "calib.h"
+
+/* Time-to-collision estimate shared by app_autobrake and the fleet engine,
+ * so both decide bit for bit alike. Each new distance sample (a new
+ * timestamp) goes into a small ring; the closing rate is the fixed-point
+ * least-squares slope of distance over time across the samples in the
+ * window. Integer arithmetic only. */
+typedef struct {
+    uint16_t mm[AB_TTC_SAMPLES];
+    uint32_t ts_ms[AB_TTC_SAMPLES];
+    uint8_t next;
+    uint8_t count;
+    uint8_t score;
+} autobrake_ttc_t;
+
+static inline void autobrake_ttc_reset(autobrake_ttc_t* ttc) {
+    ttc->next = 0U;
+    ttc->count = 0U;
+    ttc->score = 0U;
+}
+
+/* Least-squares fit of distance over time across the samples no older
+ * than AB_TTC_WINDOW_MS. The closing rate in mm/s (positive when
+ * approaching) is rate_num / rate_den; rate_den > 0 whenever the result is
+ * true, which needs AB_TTC_MIN_SAMPLES samples. Times are taken relative
+ * to the newest sample so the sums stay small: with at most
+ * AB_TTC_SAMPLES samples every product below fits in 63 bits. */
+static inline bool autobrake_ttc_fit(const autobrake_ttc_t* ttc, int64_t* rate_num,
+                                     int64_t* rate_den, uint32_t* samples) {
+    uint32_t newest = (ttc->next + AB_TTC_SAMPLES - 1U) % AB_TTC_SAMPLES;
+    uint32_t ref_ms = ttc->ts_ms[newest];
+    uint32_t age = 0U;
+    int64_t sx = 0;
+    int64_t sy = 0;
+    int64_t sxx = 0;
+    int64_t sxy = 0;
+    int64_t n = 0;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < ttc->count; i++) {
+        age = ref_ms - ttc->ts_ms[i];
+        if (age <= AB_TTC_WINDOW_MS) {
+            sx += (int64_t)age;
+            sy += (int64_t)ttc->mm[i];
+            sxx += (int64_t)age * (int64_t)age;
+            sxy += (int64_t)age * (int64_t)ttc->mm[i];
+            n++;
+        }
+    }
+    
+    /* With x = -age the slope is -(n*Sxy - Sx*Sy) / (n*Sxx - Sx^2) mm/ms,
+     * so the closing rate is (n*Sxy - Sx*Sy) * 1000 / den mm/s. */
+    *samples = (uint32_t)n;
+    *rate_den = (n * sxx) - (sx * sx);
+    *rate_num = ((n * sxy) - (sx * sy)) * 1000;
+    return (n >= (int64_t)AB_TTC_MIN_SAMPLES) && (*rate_den > 0);
+}
+
+/* Fastest plausible closing rate in mm/s at speed_kph. */
+static inline int64_t autobrake_ttc_max_closing(uint16_t speed_kph) {
+    return (((int64_t)speed_kph * 2500) / 9) + (int64_t)AB_TTC_SPEED_TOL_MM_S;
+}
+
+/* Whether an obstacle at distance_mm could be reached within
+ * AB_TTC_HORIZON_MS. A step out of reach always scores zero. */
+static inline bool autobrake_ttc_in_reach(uint16_t distance_mm, bool speed_ok,
+                                          uint16_t speed_kph) {
+    return speed_ok && (speed_kph >= AB_TTC_MIN_SPEED_KPH) &&
+           (((int64_t)distance_mm * 1000) <
+            (autobrake_ttc_max_closing(speed_kph) * (int64_t)AB_TTC_HORIZON_MS));
+}
+
+/* One tick with a valid, fresh distance reading. True while the time to
+ * collision is under AB_TTC_HORIZON_MS with enough confidence. speed_ok
+ * says whether speed_kph is valid and fresh. The rate comparisons are
+ * cross-multiplied, so no division is needed. */
+static inline bool autobrake_ttc_step(autobrake_ttc_t* ttc, uint16_t distance_mm,
+                                      uint32_t distance_ts_ms, bool speed_ok,
+                                      uint16_t speed_kph) {
+    uint32_t last = (ttc->next + AB_TTC_SAMPLES - 1U) % AB_TTC_SAMPLES;
+    int64_t dist_x1000 = (int64_t)distance_mm * 1000;
+    int64_t max_closing = 0;
+    int64_t jump = 0;
+    int64_t num = 0;
+    int64_t den = 0;
+    uint32_t samples = 0U;
+    bool hit = false;
+    
+    max_closing = autobrake_ttc_max_closing(speed_kph);
+    
+    if ((ttc->count == 0U) || (ttc->ts_ms[last] != distance_ts_ms)) {
+        /* A jump no plausible closing rate explains is a different
+         * target (cut-in, or the old one passed): start a new fit. */
+        jump = (int64_t)distance_mm - (int64_t)ttc->mm[last];
+        jump = (jump < 0) ? -jump : jump;
+        if ((ttc->count > 0U) &&
+            ((jump * 1000) >
+             (max_closing * (int64_t)(uint32_t)(distance_ts_ms - ttc->ts_ms[last])))) {
+            ttc->next = 0U;
+            ttc->count = 0U;
+        }
+        ttc->mm[ttc->next] = distance_mm;
+        ttc->ts_ms[ttc->next] = distance_ts_ms;
+        ttc->next = (uint8_t)((ttc->next + 1U) % AB_TTC_SAMPLES);
+        ttc->count = (uint8_t)((ttc->count < AB_TTC_SAMPLES) ? (ttc->count + 1U) : AB_TTC_SAMPLES);
+    }
+    
+    /* Out of reach even at the fastest plausible closing rate: no fit. */
+    if (autobrake_ttc_in_reach(distance_mm, speed_ok, speed_kph) &&
+        autobrake_ttc_fit(ttc, &num, &den, &samples)) {
+        hit = (num >= ((int64_t)AB_TTC_MIN_CLOSING_MM_S * den)) && (num <= (max_closing * den)) &&
+              ((dist_x1000 * den) < (num * (int64_t)AB_TTC_HORIZON_MS));
+    }
+    
+    if (hit) {
+        ttc->score = (uint8_t)(ttc->score + ((samples >= AB_TTC_FULL_SAMPLES) ? 2U : 1U));
+        ttc->score = (uint8_t)((ttc->score > AB_TTC_CONFIRM) ? AB_TTC_CONFIRM : ttc->score);
+    } else {
+        ttc->score = 0U;
+    }
+    
+    return ttc->score >= AB_TTC_CONFIRM;
+}
+
+#endif /* AUTOBRAKE_TTC_H */
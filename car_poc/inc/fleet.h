@@ -0,0 +1,78 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "autobrake_ttc.h"
+
+/* Multiple of the widest kernel (16 lanes) so vector loops need no tail. */
+#define FLEET_MAX_VEHICLES (100000U)
+#define FLEET_LANES        (16U)
+
+#define FLEET_COLUMN(type, name) type name[FLEET_MAX_VEHICLES] __attribute__((aligned(32)))
+
+typedef enum {
+    FLEET_ISA_SCALAR = 0U,
+    FLEET_ISA_SSE2 = 1U,
+    FLEET_ISA_AVX2 = 2U
+} fleet_isa_e;
+
+/* Structure-of-arrays state for the autobrake, wipers and speed-governor
+ * modules of many vehicles. Booleans are stored as 0/1 in 16-bit lanes and
+ * every column is indexed by vehicle. All vehicles share one tick clock.
+ * in_limit_event is an edge: the caller raises it for a single tick.
+ *
+ * The time-to-collision pass is scalar and dominates a step: with an
+ * obstacle in reach and a new sample every tick it takes the fleet from
+ * about 440 to 30-40 M vehicle-ticks/s. Vehicles with no new sample and
+ * nothing in reach skip their ring. ttc_enabled (on after fleet_init())
+ * turns the pass off; the brake request is then the threshold path's
+ * alone and no longer matches app_autobrake. */
+typedef struct {
+    uint32_t count;
+    uint32_t now_ms;
+    fleet_isa_e isa;
+    bool ttc_enabled;
+    
+    FLEET_COLUMN(uint16_t, in_vehicle_ready);
+    FLEET_COLUMN(uint16_t, in_driver_brake);
+    FLEET_COLUMN(uint16_t, in_distance_valid);
+    FLEET_COLUMN(uint16_t, in_distance_mm);
+    FLEET_COLUMN(uint32_t, in_distance_ts_ms);
+    FLEET_COLUMN(uint16_t, in_rain_valid);
+    FLEET_COLUMN(uint16_t, in_rain_pct);
+    FLEET_COLUMN(uint32_t, in_rain_ts_ms);
+    FLEET_COLUMN(uint16_t, in_speed_valid);
+    FLEET_COLUMN(uint16_t, in_speed_kph);
+    FLEET_COLUMN(uint32_t, in_speed_ts_ms);
+    FLEET_COLUMN(uint16_t, in_limit_event);
+    FLEET_COLUMN(uint16_t, in_limit_kph);
+    
+    FLEET_COLUMN(uint16_t, ab_hit_count);
+    FLEET_COLUMN(uint16_t, ab_brake_active);
+    FLEET_COLUMN(uint16_t, wp_mode);
+    FLEET_COLUMN(uint16_t, sg_limit_kph);
+    FLEET_COLUMN(uint16_t, sg_overspeed_count);
+    FLEET_COLUMN(uint16_t, sg_alarm_active);
+    /* Per-vehicle sample rings of the time-to-collision path, and a
+     * column copy of what the pass needs to tell that a ring would not
+     * change: whether it holds samples, whether its score is non-zero, and
+     * the newest sample time. */
+    autobrake_ttc_t ab_ttc[FLEET_MAX_VEHICLES];
+    FLEET_COLUMN(uint16_t, ab_ttc_filled);
+    FLEET_COLUMN(uint16_t, ab_ttc_scoring);
+    FLEET_COLUMN(uint32_t, ab_ttc_last_ts_ms);
+    
+    FLEET_COLUMN(uint16_t, out_brake_request);
+    FLEET_COLUMN(uint16_t, out_alarm);
+    FLEET_COLUMN(uint16_t, out_limit_request);
+} fleet_t;
+
+bool fleet_init(fleet_t* fleet, uint32_t count);
+void fleet_step(fleet_t* fleet);
+
+bool fleet_isa_supported(fleet_isa_e isa);
+bool fleet_set_isa(fleet_t* fleet, fleet_isa_e isa);
+const char* fleet_isa_name(fleet_isa_e isa);
+
+#endif /* FLEET_H */
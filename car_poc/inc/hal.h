@@ -9,7 +9,30 @@ bool     hal_driver_brake_pressed(void);
 uint32_t hal_now_ms(void);
 
 bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms);
+
+/* Distance sensor array: sectors are numbered left to right across the
+ * front, each with its own sample time, and read UINT16_MAX with nothing
+ * in range. A single forward sensor reports as HAL_DISTANCE_FORWARD_SECTOR.
+ * At most 16 sectors, in groups of 8. */
+#define HAL_DISTANCE_SECTORS        (8U)
+#define HAL_DISTANCE_FORWARD_SECTOR (3U)
+
+typedef struct {
+    uint16_t mm[HAL_DISTANCE_SECTORS];
+    uint32_t ts_ms[HAL_DISTANCE_SECTORS];
+} distance_array_t;
+
+/* Bit s of the result is set when sector s has a reading. */
+uint16_t hal_read_distance_array(distance_array_t* out);
 bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms);
+
+/* Raw rain sensor samples (percent) taken at the sensor's own rate since
+ * the previous call, oldest first. Returns how many were written, at most
+ * max; when more arrived only the newest are kept. out_ts_ms is the time of
+ * the newest sample. 0 when the sensor has no raw stream. */
+#define HAL_RAIN_BURST_MAX (32U)
+
+uint8_t hal_read_rain_burst(uint8_t* out_pct, uint8_t max, uint32_t* out_ts_ms);
 bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms);
 bool hal_poll_speed_limit_kph(uint16_t* out_limit_kph);
 
@@ -0,0 +1,59 @@
+#ifndef HAL_IO_H
+#define HAL_IO_H
+
+#include "hal.h"
+
+#define HAL_VOICE_LINE_LEN (64U)
+
+typedef struct {
+    uint32_t now_ms;
+    bool vehicle_ready;
+    bool driver_brake;
+    uint16_t distance_valid;
+    distance_array_t distance;
+    bool rain_valid;
+    uint8_t rain_pct;
+    uint32_t rain_ts_ms;
+    uint8_t rain_burst_len;
+    uint8_t rain_burst[HAL_RAIN_BURST_MAX];
+    uint32_t rain_burst_ts_ms;
+    bool speed_valid;
+    uint16_t speed_kph;
+    uint32_t speed_ts_ms;
+    bool limit_event;
+    uint16_t limit_kph;
+    bool gap_valid;
+    park_gap_t gap;
+    uint32_t gap_ts_ms;
+    bool cabin_valid;
+    int16_t cabin_tc_x10;
+    uint32_t cabin_ts_ms;
+    bool ambient_valid;
+    int16_t ambient_tc_x10;
+    uint32_t ambient_ts_ms;
+    bool humid_valid;
+    uint8_t humid_pct;
+    uint32_t humid_ts_ms;
+    bool voice_valid;
+    char voice_line[HAL_VOICE_LINE_LEN];
+} hal_inputs_t;
+
+typedef struct {
+    bool brake_request;
+    uint8_t wiper_mode;
+    bool alarm;
+    uint16_t limit_request;
+    uint8_t fan_stage;
+    bool ac_on;
+    uint8_t blend_pct;
+    uint8_t park_step;
+} hal_outputs_t;
+
+/* HAL binding for one vehicle: the *_step_ctx() functions read sensors from
+ * `in` and write actuator commands to `out` instead of calling hal_*. */
+typedef struct {
+    hal_inputs_t in;
+    hal_outputs_t out;
+} hal_io_t;
+
+#endif /* HAL_IO_H */
@@ -0,0 +1,79 @@
+#ifndef HAL_MOCK_H
+#define HAL_MOCK_H
+
+#include "hal_io.h"
+#include "scenario.h"
+#include "output_log.h"
+
+/* Sensor values as seen by every module during one tick. Built once in
+ * hal_mock_begin_tick*() and only read afterwards. Every channel reports
+ * its own latest sample: ts_ms[] holds the sample times by scenario_col_e,
+ * and `valid` the SCENARIO_SAMPLED() bits of the channels sampled so far.
+ * A channel the recording does not have is never valid. */
+typedef struct {
+    uint16_t distance_mm;
+    uint8_t rain_pct;
+    uint16_t speed_kph;
+    park_gap_t gap;
+    int16_t cabin_tc_x10;
+    int16_t ambient_tc_x10;
+    uint8_t humid_pct;
+    uint16_t sector_mm[HAL_DISTANCE_SECTORS];
+    uint32_t ts_ms[SCENARIO_NUM_COLUMNS];
+    uint32_t valid;
+} hal_mock_frame_t;
+
+typedef char hal_mock_sectors_match[(SCENARIO_NUM_SECTORS == HAL_DISTANCE_SECTORS) ? 1 : -1];
+
+/* CSV-replay HAL for one simulated vehicle. Rows are merged in time order
+ * into `held_row`, which keeps each channel's latest sample and its time
+ * in held_ms[], so channels recorded at different rates age separately.
+ * `channels` are the ones the recording has; without sector columns the
+ * distance array reports distance_mm as its forward sector. Every rain_raw
+ * sample, not only the latest, is queued in rain_burst[] until read. */
+typedef struct {
+    scenario_reader_t* reader;
+    uint32_t channels;
+    hal_mock_frame_t frame;
+    scenario_row_t held_row;
+    uint32_t held_ms[SCENARIO_NUM_COLUMNS];
+    uint32_t held_sampled;
+    scenario_row_t next_row;
+    bool next_row_valid;
+    bool scenario_primed;
+    bool scenario_exhausted;
+    bool interpolate_gaps;
+    bool driver_brake;
+    bool vehicle_ready;
+    bool speed_limit_event_pending;
+    uint16_t pending_speed_limit;
+    bool voice_event_pending;
+    char pending_voice[HAL_VOICE_LINE_LEN];
+    uint8_t rain_burst_len;
+    uint8_t rain_burst[HAL_RAIN_BURST_MAX];
+    uint32_t rain_burst_ts_ms;
+    hal_outputs_t outputs;
+    output_log_t outputs_log;
+} hal_mock_t;
+
+void hal_mock_init_ctx(hal_mock_t* mock, scenario_reader_t* reader);
+void hal_mock_begin_tick_ctx(hal_mock_t* mock, uint32_t now_ms);
+void hal_mock_fill_inputs(hal_mock_t* mock, uint32_t now_ms, hal_inputs_t* in);
+/* The output log is binary for names ending in OUTPUT_LOG_SUFFIX and CSV
+ * otherwise; either way it is written on a background thread. */
+bool hal_mock_open_outputs(hal_mock_t* mock, const char* filename);
+void hal_mock_write_outputs(hal_mock_t* mock, uint32_t now_ms, const hal_outputs_t* out);
+bool hal_mock_scenario_finished_ctx(const hal_mock_t* mock);
+/* False when the output log could not be written completely. */
+bool hal_mock_close(hal_mock_t* mock);
+
+/* Default instance behind the global hal_* API, fed by scenario_init(). */
+void hal_mock_begin_tick(uint32_t now_ms);
+void hal_mock_end_tick(uint32_t now_ms);
+void hal_mock_set_interpolation(bool enable);
+/* Output log of the default instance, "outputs.csv" unless set. */
+void hal_mock_set_outputs_path(const char* filename);
+bool hal_mock_scenario_finished(void);
+void hal_mock_cleanup(void);
+
+#endif /* HAL_MOCK_H */
@@ -0,0 +1,65 @@
+#ifndef HYST_FSM_H
+#define HYST_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Fixed-size hysteresis state machines. A machine is an X-macro table with
+ * one row per state, in state order from 0:
+ *
+ *     X(state, up_if, up_arg, up_to, down_if, down_arg, down_to)
+ *
+ * An input for which down_if holds moves to down_to, otherwise one for
+ * which up_if holds moves to up_to, and any other input stays. Conditions
+ * are GE (input >= arg), LT (input < arg), HAS (input & arg non-zero),
+ * LACKS (input & arg zero) and NEVER.
+ *
+ * HYST_FSM_ROW_4 / HYST_FSM_ROW_256 expand each row at compile time into
+ * the next states for inputs 0..3 or 0..255, so
+ *
+ *     static const uint8_t next[HYST_FSM_STATES(T)][HYST_FSM_INPUTS_256] = {
+ *         T(HYST_FSM_ROW_256)
+ *     };
+ *
+ * makes a step one indexed load: state = next[state][input]. */
+#define HYST_FSM_INPUTS_4   (4U)
+#define HYST_FSM_INPUTS_256 (256U)
+
+#define HYST_FSM_IF_GE(in, arg)    ((in) >= (arg))
+#define HYST_FSM_IF_LT(in, arg)    ((in) < (arg))
+#define HYST_FSM_IF_HAS(in, arg)   (((in) & (arg)) != 0U)
+#define HYST_FSM_IF_LACKS(in, arg) (((in) & (arg)) == 0U)
+#define HYST_FSM_IF_NEVER(in, arg) (false)
+
+#define HYST_FSM_NEXT(in, state, up_if, up_arg, up_to, down_if, down_arg, down_to) \
+    (uint8_t)(HYST_FSM_IF_##down_if((in), (down_arg)) ? (down_to) : \
+              (HYST_FSM_IF_##up_if((in), (up_arg)) ? (up_to) : (state)))
+
+#define HYST_FSM_4(in, ...) \
+    HYST_FSM_NEXT((in), __VA_ARGS__), HYST_FSM_NEXT((in) + 1U, __VA_ARGS__), \
+    HYST_FSM_NEXT((in) + 2U, __VA_ARGS__), HYST_FSM_NEXT((in) + 3U, __VA_ARGS__)
+#define HYST_FSM_16(in, ...) \
+    HYST_FSM_4((in), __VA_ARGS__), HYST_FSM_4((in) + 4U, __VA_ARGS__), \
+    HYST_FSM_4((in) + 8U, __VA_ARGS__), HYST_FSM_4((in) + 12U, __VA_ARGS__)
+#define HYST_FSM_64(in, ...) \
+    HYST_FSM_16((in), __VA_ARGS__), HYST_FSM_16((in) + 16U, __VA_ARGS__), \
+    HYST_FSM_16((in) + 32U, __VA_ARGS__), HYST_FSM_16((in) + 48U, __VA_ARGS__)
+#define HYST_FSM_256(in, ...) \
+    HYST_FSM_64((in), __VA_ARGS__), HYST_FSM_64((in) + 64U, __VA_ARGS__), \
+    HYST_FSM_64((in) + 128U, __VA_ARGS__), HYST_FSM_64((in) + 192U, __VA_ARGS__)
+
+#define HYST_FSM_ROW_4(...)   { HYST_FSM_4(0U, __VA_ARGS__) },
+#define HYST_FSM_ROW_256(...) { HYST_FSM_256(0U, __VA_ARGS__) },
+
+#define HYST_FSM_COUNT_ROW(...) + 1U
+#define HYST_FSM_STATES(table)  (0U table(HYST_FSM_COUNT_ROW))
+
+/* Thresholds of GE/LT rows for kernels that compare instead of loading:
+ * an input at or above HYST_FSM_UP_AT_* goes up, one below
+ * HYST_FSM_DOWN_BELOW_* goes down. 256 and 0 never do. */
+#define HYST_FSM_UP_AT_GE(arg)        (arg)
+#define HYST_FSM_UP_AT_NEVER(arg)     (256U)
+#define HYST_FSM_DOWN_BELOW_LT(arg)    (arg)
+#define HYST_FSM_DOWN_BELOW_NEVER(arg) (0U)
+
+#endif /* HYST_FSM_H */
@@ -3,9 +3,51 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include "trace_log.h"
 
 #define TICK_MS (10U)
 
+#define PLATFORM_TIMER_BUCKETS       (10U)
+#define PLATFORM_TIMER_MAX_CATCHUP   (10U)
+
+/* Periodic timer on absolute deadlines: deadline n is start + n * period,
+ * so a late wake-up shortens the next wait instead of shifting every later
+ * tick. Lateness is the wake-up time minus the deadline. */
+typedef struct {
+    uint64_t period_us;
+    uint64_t next_deadline_us;
+    uint32_t ticks;
+    uint32_t overruns;
+    uint32_t resyncs;
+    uint64_t late_sum_us;
+    uint64_t late_max_us;
+    uint32_t late_hist[PLATFORM_TIMER_BUCKETS];
+} platform_timer_t;
+
 void platform_assert(bool cond);
 
-#endif /* PLATFORM_H */
\ No newline at end of file
+/* Monotonic time since platform start-up in microseconds. Never jumps with
+ * wall-clock adjustments; 64 bits do not wrap in practice. */
+uint64_t platform_get_time_us(void);
+
+/* Highest-resolution monotonic reading available, in nanoseconds from an
+ * arbitrary origin. Only differences are meaningful. */
+uint64_t platform_get_time_ns(void);
+
+void platform_timer_start(platform_timer_t* timer, uint32_t period_ms);
+void platform_timer_wait(platform_timer_t* timer);
+void platform_timer_print_stats(const platform_timer_t* timer, FILE* file);
+
+/* Shared bookkeeping used by the platform implementations. */
+void platform_timer_reset(platform_timer_t* timer, uint32_t period_ms, uint64_t now_us);
+void platform_timer_record(platform_timer_t* timer, uint64_t now_us);
+
+/* Formats `log` to `file` on a background thread so the tick only pays
+ * for copying trace arguments. Without a thread (start returned false)
+ * the entries simply wait for platform_trace_stop(), which drains what
+ * is left either way. */
+bool platform_trace_start(trace_log_t* log, FILE* file);
+void platform_trace_stop(void);
+
+#endif /* PLATFORM_H */
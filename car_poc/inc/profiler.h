@@ -0,0 +1,44 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "sched_table.h"
+
+#ifndef PROFILE_STEPS
+#define PROFILE_STEPS 0
+#endif
+
+/* Each power of two of nanoseconds is split into PROF_SUB_BUCKETS linear
+ * sub-buckets, so percentiles are reported within 1/PROF_SUB_BUCKETS of
+ * the true value. */
+#define PROF_SUB_BITS     (2U)
+#define PROF_SUB_BUCKETS  (1U << PROF_SUB_BITS)
+#define PROF_NUM_BUCKETS  (64U * PROF_SUB_BUCKETS)
+
+void prof_init(void);
+void prof_record(sched_id_e id, uint64_t elapsed_ns);
+/* `basis_points` is the percentile times 100, e.g. 9990U for p99.9. */
+uint64_t prof_percentile_ns(sched_id_e id, uint32_t basis_points);
+uint64_t prof_max_ns(sched_id_e id);
+void prof_report(FILE* file);
+void prof_poll_signal(void);
+
+#if PROFILE_STEPS
+#define PROF_STEP(id, call) \
+    do { \
+        uint64_t prof_t0_ = platform_get_time_ns(); \
+        call; \
+        prof_record((id), platform_get_time_ns() - prof_t0_); \
+    } while (0)
+#define PROF_INIT()         prof_init()
+#define PROF_POLL()         prof_poll_signal()
+#define PROF_REPORT(file)   prof_report(file)
+#else
+#define PROF_STEP(id, call) call
+#define PROF_INIT()
+#define PROF_POLL()
+#define PROF_REPORT(file)
+#endif
+
+#endif /* PROFILER_H */
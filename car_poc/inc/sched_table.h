@@ -0,0 +1,38 @@
+#ifndef SCHED_TABLE_H
+#define SCHED_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "sched_cfg.h"
+
+#define SCHED_ENUM_ENTRY(a, name, period_ms, phase_ms, priority, budget_us) SCHED_ID_##name,
+
+typedef enum {
+    SCHED_TABLE(SCHED_ENUM_ENTRY, 0)
+    SCHED_NUM_SLOTS
+} sched_id_e;
+
+#define SCHED_MAJOR_FRAMES (SCHED_MAJOR_FRAME_MS / SCHED_MINOR_FRAME_MS)
+#define SCHED_MAX_FRAMES   (100U)
+
+typedef struct {
+    const char* name;
+    uint32_t period_ms;
+    uint32_t phase_ms;
+    uint8_t priority;
+    uint32_t budget_us;
+} sched_slot_t;
+
+typedef void (*sched_dispatch_fn)(sched_id_e id, void* arg);
+
+/* Runs the slots released in minor frame `frame` (taken modulo the major
+ * frame) in priority order. */
+void sched_run_frame(uint32_t frame, sched_dispatch_fn dispatch, void* arg);
+uint32_t sched_next_frame(uint32_t frame);
+/* Bit n of the mask is set when the slot with priority n is released. */
+uint32_t sched_frame_mask(uint32_t frame);
+const sched_slot_t* sched_slot(sched_id_e id);
+void sched_print_table(FILE* file);
+
+#endif /* SCHED_TABLE_H */
@@ -0,0 +1,116 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Single-producer/single-consumer ring of slot indices. The ring does not
+ * own any storage: the caller keeps an array of `capacity` elements, fills
+ * the slot spsc_ring_acquire() names, publishes it, and the other thread
+ * reads the slot spsc_ring_peek() names before releasing it. No call
+ * blocks or allocates; waiting when full or empty is up to the caller.
+ *
+ * Each side's index sits on its own cache line next to a cached copy of
+ * the other side's, so a side only touches the shared line when its cache
+ * says the ring is full or empty. Indices run freely and wrap at 2^32.
+ *
+ * SPSC_RING_C11_ATOMICS=1 builds on <stdatomic.h>; the default uses the
+ * GCC/Clang __atomic builtins, which need no C11 mode. */
+#ifndef SPSC_RING_C11_ATOMICS
+#define SPSC_RING_C11_ATOMICS 0
+#endif
+
+#define SPSC_RING_CACHE_LINE (64U)
+#define SPSC_RING_ALIGNED    __attribute__((aligned(SPSC_RING_CACHE_LINE)))
+
+#if SPSC_RING_C11_ATOMICS
+#include <stdatomic.h>
+typedef _Atomic uint32_t spsc_ring_index_t;
+#define SPSC_RING_LOAD_ACQUIRE(p)     atomic_load_explicit((p), memory_order_acquire)
+#define SPSC_RING_LOAD_RELAXED(p)     atomic_load_explicit((p), memory_order_relaxed)
+#define SPSC_RING_STORE_RELEASE(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#define SPSC_RING_STORE_RELAXED(p, v) atomic_store_explicit((p), (v), memory_order_relaxed)
+#else
+typedef uint32_t spsc_ring_index_t;
+#define SPSC_RING_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_RING_LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define SPSC_RING_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define SPSC_RING_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#endif
+
+typedef struct {
+    /* Producer line: written by the producer only. */
+    spsc_ring_index_t head SPSC_RING_ALIGNED;
+    uint32_t head_slot;
+    uint32_t tail_cache;
+    
+    /* Consumer line: written by the consumer only. */
+    spsc_ring_index_t tail SPSC_RING_ALIGNED;
+    uint32_t tail_slot;
+    uint32_t head_cache;
+    
+    /* Read-only after spsc_ring_init(). */
+    uint32_t capacity SPSC_RING_ALIGNED;
+} spsc_ring_t;
+
+/* Not thread-safe: call before either side starts. capacity must be at
+ * least 1 and at most 2^31. */
+static inline void spsc_ring_init(spsc_ring_t* ring, uint32_t capacity) {
+    SPSC_RING_STORE_RELAXED(&ring->head, 0U);
+    ring->head_slot = 0U;
+    ring->tail_cache = 0U;
+    SPSC_RING_STORE_RELAXED(&ring->tail, 0U);
+    ring->tail_slot = 0U;
+    ring->head_cache = 0U;
+    ring->capacity = capacity;
+}
+
+/* Producer: the slot to fill next, or false while the ring is full.
+ * Repeated calls name the same slot until it is published. */
+static inline bool spsc_ring_acquire(spsc_ring_t* ring, uint32_t* slot) {
+    uint32_t head = SPSC_RING_LOAD_RELAXED(&ring->head);
+    
+    if ((head - ring->tail_cache) >= ring->capacity) {
+        ring->tail_cache = SPSC_RING_LOAD_ACQUIRE(&ring->tail);
+        if ((head - ring->tail_cache) >= ring->capacity) {
+            return false;
+        }
+    }
+    
+    *slot = ring->head_slot;
+    return true;
+}
+
+/* Producer: hands the acquired slot to the consumer. */
+static inline void spsc_ring_publish(spsc_ring_t* ring) {
+    uint32_t head = SPSC_RING_LOAD_RELAXED(&ring->head);
+    
+    ring->head_slot = ((ring->head_slot + 1U) == ring->capacity) ? 0U : (ring->head_slot + 1U);
+    SPSC_RING_STORE_RELEASE(&ring->head, head + 1U);
+}
+
+/* Consumer: the oldest published slot, or false while the ring is empty.
+ * Repeated calls name the same slot until it is released. */
+static inline bool spsc_ring_peek(spsc_ring_t* ring, uint32_t* slot) {
+    uint32_t tail = SPSC_RING_LOAD_RELAXED(&ring->tail);
+    
+    if (ring->head_cache == tail) {
+        ring->head_cache = SPSC_RING_LOAD_ACQUIRE(&ring->head);
+        if (ring->head_cache == tail) {
+            return false;
+        }
+    }
+    
+    *slot = ring->tail_slot;
+    return true;
+}
+
+/* Consumer: gives the peeked slot back to the producer. */
+static inline void spsc_ring_release(spsc_ring_t* ring) {
+    uint32_t tail = SPSC_RING_LOAD_RELAXED(&ring->tail);
+    
+    ring->tail_slot = ((ring->tail_slot + 1U) == ring->capacity) ? 0U : (ring->tail_slot + 1U);
+    SPSC_RING_STORE_RELEASE(&ring->tail, tail + 1U);
+}
+
+#endif /* SPSC_RING_H */
@@ -0,0 +1,66 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "spsc_ring.h"
+#include "trace_cfg.h"
+
+/* Deferred text logging for the tick path. A call site names a message
+ * from TRACE_MESSAGES by its compile-time ID and copies its raw arguments
+ * into a preallocated entry; no formatting or I/O happens there. Whoever
+ * drains the log (a background thread, or the owner between runs) turns
+ * the entries into text with the format from the table.
+ *
+ * One thread writes a log and one drains it. A full log drops the entry
+ * and counts it instead of waiting. */
+#define TRACE_LOG_SLOTS     (128U)
+#define TRACE_LOG_ARG_BYTES (124U)
+/* Room for the longest text one entry formats to. */
+#define TRACE_LOG_TEXT_MAX  (512U)
+
+#define TRACE_ID_ENTRY(name, format) TRACE_ID_##name,
+
+typedef enum {
+    TRACE_MESSAGES(TRACE_ID_ENTRY)
+    TRACE_NUM_IDS
+} trace_id_e;
+
+typedef struct {
+    uint16_t id;
+    uint16_t len;
+    uint8_t args[TRACE_LOG_ARG_BYTES];
+} trace_entry_t;
+
+typedef struct {
+    spsc_ring_t ring;
+    trace_entry_t entries[TRACE_LOG_SLOTS];
+    /* Writer side. */
+    trace_entry_t* open_entry;
+    uint32_t dropped;
+} trace_log_t;
+
+void trace_log_init(trace_log_t* log);
+
+/* Starts an entry for message `id`. False when `log` is NULL or full; the
+ * argument calls and trace_log_commit() must then be skipped. */
+bool trace_log_begin(trace_log_t* log, trace_id_e id);
+void trace_log_u32(trace_log_t* log, uint32_t value);
+void trace_log_i32(trace_log_t* log, int32_t value);
+/* Copies at most 255 bytes of `text`; what does not fit is cut off. */
+void trace_log_str(trace_log_t* log, const char* text);
+void trace_log_commit(trace_log_t* log);
+
+/* Drain side: formats every committed entry to `file` and returns how
+ * many there were. */
+uint32_t trace_log_drain(trace_log_t* log, FILE* file);
+/* Formats one entry into `text` (at most `size` bytes, always terminated)
+ * and returns the length. */
+uint32_t trace_log_format(const trace_entry_t* entry, char* text, uint32_t size);
+
+/* Log for the module-level (non-_ctx) entry points. Drops everything
+ * until trace_log_init() is called on it. */
+trace_log_t* trace_log_default(void);
+
+#endif /* TRACE_LOG_H */
@@ -0,0 +1,30 @@
+#ifndef VEHICLE_H
+#define VEHICLE_H
+
+#include "hal_io.h"
+#include "app_autobrake.h"
+#include "app_wipers.h"
+#include "app_speedgov.h"
+#include "app_autopark.h"
+#include "app_climate.h"
+#include "app_voice.h"
+#include "sched_table.h"
+
+/* All feature state of one simulated car plus its HAL binding. Instances
+ * share nothing, so any number of them can be stepped in one process. */
+typedef struct {
+    autobrake_state_t autobrake;
+    wipers_state_t wipers;
+    speedgov_state_t speedgov;
+    autopark_state_t autopark;
+    climate_state_t climate;
+    voice_state_t voice;
+    hal_io_t io;
+    uint32_t frame;
+} vehicle_t;
+
+void vehicle_init(vehicle_t* vehicle);
+/* Runs the modules released in the current minor frame of the schedule. */
+void vehicle_step(vehicle_t* vehicle);
+
+#endif /* VEHICLE_H */
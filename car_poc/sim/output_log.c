@@ -0,0 +1,522 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "output_log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The I/O thread sleeps longer than the simulation: a block holds seconds
+ * of scenario time, so there is nothing to gain from polling it faster. */
+#define OUTPUT_LOG_IDLE_NS  (1000000L)
+#define OUTPUT_LOG_STALL_NS (50000L)
+
+typedef char output_record_is_packed[(sizeof(output_record_t) == 12U) ? 1 : -1];
+
+static void wait_ns(long ns) {
+    struct timespec ts = {0, ns};
+    
+    (void)nanosleep(&ts, NULL);
+}
+
+static bool has_suffix(const char* name, const char* suffix) {
+    size_t name_len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    
+    return (name_len >= suffix_len) && (strcmp(name + (name_len - suffix_len), suffix) == 0);
+}
+
+output_log_format_e output_log_format_for(const char* filename) {
+    if (has_suffix(filename, OUTPUT_LOG_SUFFIX)) {
+        return OUTPUT_LOG_BINARY;
+    }
+    
+    return has_suffix(filename, OUTPUT_DELTA_SUFFIX) ? OUTPUT_LOG_DELTA : OUTPUT_LOG_CSV;
+}
+
+static bool write_all(int fd, const void* data, size_t len) {
+    const char* p = (const char*)data;
+    ssize_t done = 0;
+    
+    while (len > 0U) {
+        done = write(fd, p, len);
+        if ((done < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (done <= 0) {
+            return false;
+        }
+        p += done;
+        len -= (size_t)done;
+    }
+    
+    return true;
+}
+
+void output_log_pack(output_record_t* record, uint32_t now_ms, const hal_outputs_t* out) {
+    record->ms = now_ms;
+    record->limit_request = out->limit_request;
+    record->wiper_mode = out->wiper_mode;
+    record->fan_stage = out->fan_stage;
+    record->blend_pct = out->blend_pct;
+    record->park_step = out->park_step;
+    record->flags = (uint8_t)((out->brake_request ? OUTPUT_FLAG_BRAKE : 0U) |
+                              (out->alarm ? OUTPUT_FLAG_ALARM : 0U) |
+                              (out->ac_on ? OUTPUT_FLAG_AC_ON : 0U));
+    record->reserved = 0U;
+}
+
+static char* put_uint(char* p, uint32_t value) {
+    char digits[10];
+    uint32_t n = 0U;
+    
+    do {
+        digits[n] = (char)('0' + (value % 10U));
+        value /= 10U;
+        n++;
+    } while (value != 0U);
+    
+    while (n > 0U) {
+        n--;
+        *p = digits[n];
+        p++;
+    }
+    *p = ',';
+    return p + 1;
+}
+
+static char* put_flag(char* p, uint8_t flags, uint8_t mask) {
+    p[0] = ((flags & mask) != 0U) ? '1' : '0';
+    p[1] = ',';
+    return p + 2;
+}
+
+uint32_t output_log_format_csv(const output_record_t* record, char* line) {
+    char* p = line;
+    
+    p = put_uint(p, record->ms);
+    p = put_flag(p, record->flags, OUTPUT_FLAG_BRAKE);
+    p = put_uint(p, record->wiper_mode);
+    p = put_flag(p, record->flags, OUTPUT_FLAG_ALARM);
+    p = put_uint(p, record->limit_request);
+    p = put_uint(p, record->fan_stage);
+    p = put_flag(p, record->flags, OUTPUT_FLAG_AC_ON);
+    p = put_uint(p, record->blend_pct);
+    p = put_uint(p, record->park_step);
+    p[-1] = '\n';
+    return (uint32_t)(p - line);
+}
+
+/* Collects bytes for the next write(), writing out what is already there
+ * first when they do not fit. */
+static bool stage(output_log_t* log, const void* data, uint32_t len) {
+    bool ok = true;
+    
+    if ((log->staged + len) > sizeof(log->text)) {
+        ok = write_all(log->fd, log->text, log->staged);
+        log->staged = 0U;
+    }
+    
+    memcpy(&log->text[log->staged], data, len);
+    log->staged += len;
+    return ok;
+}
+
+static uint32_t put_varint(uint8_t* p, uint32_t value) {
+    uint32_t n = 0U;
+    
+    while (value >= 0x80U) {
+        p[n] = (uint8_t)((value & 0x7FU) | 0x80U);
+        value >>= 7;
+        n++;
+    }
+    p[n] = (uint8_t)value;
+    return n + 1U;
+}
+
+static void delta_flush_run(output_log_t* log) {
+    if (log->run_ticks == 0U) {
+        return;
+    }
+    
+    log->chunk[log->chunk_len] = OUTPUT_DELTA_RUN;
+    log->chunk_len++;
+    log->chunk_len += put_varint(&log->chunk[log->chunk_len], log->run_ticks);
+    log->chunk_len += put_varint(&log->chunk[log->chunk_len], log->run_dt);
+    log->run_ticks = 0U;
+}
+
+static bool delta_finish_chunk(output_log_t* log) {
+    output_delta_chunk_t header;
+    bool ok = true;
+    
+    if (log->chunk_ticks == 0U) {
+        return true;
+    }
+    
+    delta_flush_run(log);
+    memcpy(header.sync, OUTPUT_DELTA_SYNC, 4U);
+    header.first_ms = log->chunk_first_ms;
+    header.last_ms = log->delta_prev.ms;
+    header.ticks = log->chunk_ticks;
+    header.payload_len = log->chunk_len;
+    ok = stage(log, &header, (uint32_t)sizeof(header));
+    ok = stage(log, log->chunk, log->chunk_len) && ok;
+    
+    log->chunk_len = 0U;
+    log->chunk_ticks = 0U;
+    return ok;
+}
+
+static uint8_t changed_fields(const output_record_t* a, const output_record_t* b) {
+    uint8_t flags = (uint8_t)(a->flags ^ b->flags);
+    
+    return (uint8_t)((((flags & OUTPUT_FLAG_BRAKE) != 0U) ? OUTPUT_CHANGED_BRAKE : 0U) |
+                     ((a->wiper_mode != b->wiper_mode) ? OUTPUT_CHANGED_WIPER : 0U) |
+                     (((flags & OUTPUT_FLAG_ALARM) != 0U) ? OUTPUT_CHANGED_ALARM : 0U) |
+                     ((a->limit_request != b->limit_request) ? OUTPUT_CHANGED_LIMIT : 0U) |
+                     ((a->fan_stage != b->fan_stage) ? OUTPUT_CHANGED_FAN : 0U) |
+                     (((flags & OUTPUT_FLAG_AC_ON) != 0U) ? OUTPUT_CHANGED_AC_ON : 0U) |
+                     ((a->blend_pct != b->blend_pct) ? OUTPUT_CHANGED_BLEND : 0U) |
+                     ((a->park_step != b->park_step) ? OUTPUT_CHANGED_PARK : 0U));
+}
+
+static void delta_put_change(output_log_t* log, uint8_t mask, uint32_t dt,
+                             const output_record_t* record) {
+    uint8_t* p = &log->chunk[log->chunk_len];
+    
+    *p = mask;
+    p++;
+    p += put_varint(p, dt);
+    if ((mask & OUTPUT_CHANGED_WIPER) != 0U) {
+        *p = record->wiper_mode;
+        p++;
+    }
+    if ((mask & OUTPUT_CHANGED_LIMIT) != 0U) {
+        memcpy(p, &record->limit_request, sizeof(record->limit_request));
+        p += sizeof(record->limit_request);
+    }
+    if ((mask & OUTPUT_CHANGED_FAN) != 0U) {
+        *p = record->fan_stage;
+        p++;
+    }
+    if ((mask & OUTPUT_CHANGED_BLEND) != 0U) {
+        *p = record->blend_pct;
+        p++;
+    }
+    if ((mask & OUTPUT_CHANGED_PARK) != 0U) {
+        *p = record->park_step;
+        p++;
+    }
+    log->chunk_len = (uint32_t)(p - log->chunk);
+}
+
+/* A new chunk starts with a keyframe once the current one spans the
+ * keyframe interval or is close to full. Unchanged ticks at a steady
+ * interval collapse into one run entry. */
+static bool delta_encode(output_log_t* log, const output_record_t* record) {
+    uint32_t dt = record->ms - log->delta_prev.ms;
+    uint8_t mask = 0U;
+    bool ok = true;
+    
+    if ((log->chunk_ticks > 0U) &&
+        (((record->ms - log->chunk_first_ms) >= OUTPUT_DELTA_KEYFRAME_MS) ||
+         ((log->chunk_len + (2U * OUTPUT_DELTA_ENTRY_MAX)) > OUTPUT_DELTA_CHUNK_MAX) ||
+         (log->chunk_ticks == UINT32_MAX))) {
+        ok = delta_finish_chunk(log);
+    }
+    
+    if (log->chunk_ticks == 0U) {
+        memcpy(log->chunk, record, sizeof(output_record_t));
+        log->chunk_len = (uint32_t)sizeof(output_record_t);
+        log->chunk_first_ms = record->ms;
+    } else {
+        mask = changed_fields(&log->delta_prev, record);
+        if ((mask != 0U) || ((log->run_ticks > 0U) && (dt != log->run_dt))) {
+            delta_flush_run(log);
+        }
+        if (mask != 0U) {
+            delta_put_change(log, mask, dt, record);
+        } else {
+            log->run_dt = dt;
+            log->run_ticks++;
+        }
+    }
+    
+    log->delta_prev = *record;
+    log->chunk_ticks++;
+    return ok;
+}
+
+static bool write_block(output_log_t* log, const output_log_block_t* block) {
+    uint32_t i = 0U;
+    bool ok = true;
+    
+    if (log->format == OUTPUT_LOG_BINARY) {
+        return write_all(log->fd, block->records, block->count * sizeof(output_record_t));
+    }
+    
+    if (log->format == OUTPUT_LOG_DELTA) {
+        for (i = 0U; i < block->count; i++) {
+            ok = delta_encode(log, &block->records[i]) && ok;
+        }
+    } else {
+        for (i = 0U; i < block->count; i++) {
+            log->staged += output_log_format_csv(&block->records[i], &log->text[log->staged]);
+        }
+    }
+    
+    ok = write_all(log->fd, log->text, log->staged) && ok;
+    log->staged = 0U;
+    return ok;
+}
+
+/* The open change-only chunk is only written when the log is closed. */
+static bool write_tail(output_log_t* log) {
+    bool ok = true;
+    
+    if (log->format == OUTPUT_LOG_DELTA) {
+        ok = delta_finish_chunk(log);
+        ok = write_all(log->fd, log->text, log->staged) && ok;
+        log->staged = 0U;
+    }
+    
+    return ok;
+}
+
+/* Drains the ring until the log is closed. After a failed write the rest
+ * is still released, so the simulation never blocks on a broken file. */
+static void* writer_main(void* arg) {
+    output_log_t* log = (output_log_t*)arg;
+    uint32_t slot = 0U;
+    bool ok = true;
+    
+    for (;;) {
+        while (!spsc_ring_peek(&log->ring, &slot)) {
+            if (__atomic_load_n(&log->closing, __ATOMIC_ACQUIRE) &&
+                !spsc_ring_peek(&log->ring, &slot)) {
+                ok = ok && write_tail(log);
+                __atomic_store_n(&log->failed, !ok, __ATOMIC_RELEASE);
+                return NULL;
+            }
+            wait_ns(OUTPUT_LOG_IDLE_NS);
+        }
+        
+        ok = ok && write_block(log, &log->blocks[slot]);
+        spsc_ring_release(&log->ring);
+    }
+}
+
+bool output_log_open(output_log_t* log, const char* filename, output_log_format_e format) {
+    output_log_header_t header;
+    output_delta_header_t delta_header;
+    bool ok = false;
+    
+    if ((log == NULL) || (filename == NULL)) {
+        return false;
+    }
+    
+    memset(log, 0, sizeof(output_log_t));
+    log->format = format;
+    spsc_ring_init(&log->ring, OUTPUT_LOG_BLOCKS);
+    log->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log->fd < 0) {
+        return false;
+    }
+    
+    if (format == OUTPUT_LOG_BINARY) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, OUTPUT_LOG_MAGIC, 4U);
+        header.version = OUTPUT_LOG_VERSION;
+        header.byte_order = OUTPUT_LOG_BYTE_ORDER;
+        header.record_size = (uint32_t)sizeof(output_record_t);
+        ok = write_all(log->fd, &header, sizeof(header));
+    } else if (format == OUTPUT_LOG_DELTA) {
+        memset(&delta_header, 0, sizeof(delta_header));
+        memcpy(delta_header.magic, OUTPUT_DELTA_MAGIC, 4U);
+        delta_header.version = OUTPUT_LOG_VERSION;
+        delta_header.byte_order = OUTPUT_LOG_BYTE_ORDER;
+        delta_header.record_size = (uint32_t)sizeof(output_record_t);
+        delta_header.keyframe_ms = OUTPUT_DELTA_KEYFRAME_MS;
+        ok = write_all(log->fd, &delta_header, sizeof(delta_header));
+    } else {
+        ok = write_all(log->fd, OUTPUT_LOG_CSV_HEADER, sizeof(OUTPUT_LOG_CSV_HEADER) - 1U);
+    }
+    
+    if (!ok || (pthread_create(&log->thread, NULL, writer_main, log) != 0)) {
+        (void)close(log->fd);
+        log->fd = -1;
+        return false;
+    }
+    log->thread_started = true;
+    return true;
+}
+
+bool output_log_is_open(const output_log_t* log) {
+    return log->thread_started;
+}
+
+static void publish_block(output_log_t* log) {
+    log->blocks[log->slot].count = log->fill;
+    log->fill = 0U;
+    spsc_ring_publish(&log->ring);
+}
+
+void output_log_append(output_log_t* log, uint32_t now_ms, const hal_outputs_t* out) {
+    bool stalled = false;
+    
+    if (!log->thread_started) {
+        return;
+    }
+    
+    if (log->fill == 0U) {
+        while (!spsc_ring_acquire(&log->ring, &log->slot)) {
+            stalled = true;
+            wait_ns(OUTPUT_LOG_STALL_NS);
+        }
+        if (stalled) {
+            log->stalls++;
+        }
+    }
+    
+    output_log_pack(&log->blocks[log->slot].records[log->fill], now_ms, out);
+    log->fill++;
+    if (log->fill == OUTPUT_LOG_BLOCK_RECORDS) {
+        publish_block(log);
+    }
+}
+
+bool output_log_close(output_log_t* log) {
+    bool ok = true;
+    
+    if ((log == NULL) || !log->thread_started) {
+        return true;
+    }
+    
+    if (log->fill > 0U) {
+        publish_block(log);
+    }
+    __atomic_store_n(&log->closing, true, __ATOMIC_RELEASE);
+    (void)pthread_join(log->thread, NULL);
+    log->thread_started = false;
+    
+    ok = !log->failed;
+    if (close(log->fd) != 0) {
+        ok = false;
+    }
+    log->fd = -1;
+    return ok;
+}
+
+void output_delta_decode_start(output_delta_decoder_t* decoder, const output_delta_chunk_t* chunk,
+                               const uint8_t* payload) {
+    memset(decoder, 0, sizeof(output_delta_decoder_t));
+    decoder->p = payload;
+    decoder->end = payload + chunk->payload_len;
+    decoder->ticks_left = chunk->ticks;
+    
+    if ((chunk->payload_len < sizeof(output_record_t)) || (chunk->ticks == 0U)) {
+        decoder->failed = true;
+        return;
+    }
+    
+    memcpy(&decoder->current, payload, sizeof(output_record_t));
+    decoder->p += sizeof(output_record_t);
+    decoder->keyframe_pending = true;
+}
+
+static bool get_varint(output_delta_decoder_t* decoder, uint32_t* value) {
+    uint32_t shift = 0U;
+    uint8_t byte = 0U;
+    
+    *value = 0U;
+    do {
+        if ((decoder->p >= decoder->end) || (shift > 28U)) {
+            return false;
+        }
+        byte = *decoder->p;
+        decoder->p++;
+        *value |= (uint32_t)(byte & 0x7FU) << shift;
+        shift += 7U;
+    } while ((byte & 0x80U) != 0U);
+    
+    return true;
+}
+
+static bool get_bytes(output_delta_decoder_t* decoder, void* value, uint32_t len) {
+    if ((uint32_t)(decoder->end - decoder->p) < len) {
+        return false;
+    }
+    
+    memcpy(value, decoder->p, len);
+    decoder->p += len;
+    return true;
+}
+
+static bool decode_entry(output_delta_decoder_t* decoder) {
+    output_record_t* current = &decoder->current;
+    uint32_t toggled = 0U;
+    uint32_t dt = 0U;
+    uint8_t tag = 0U;
+    bool ok = true;
+    
+    ok = get_bytes(decoder, &tag, 1U) && get_varint(decoder, &dt);
+    if (ok && (tag == OUTPUT_DELTA_RUN)) {
+        /* Run length first, then the interval. */
+        decoder->run_ticks = dt;
+        ok = (dt > 0U) && get_varint(decoder, &decoder->run_dt);
+        dt = decoder->run_dt;
+        decoder->run_ticks--;
+    } else if (ok) {
+        toggled = (((tag & OUTPUT_CHANGED_BRAKE) != 0U) ? OUTPUT_FLAG_BRAKE : 0U) |
+                  (((tag & OUTPUT_CHANGED_ALARM) != 0U) ? OUTPUT_FLAG_ALARM : 0U) |
+                  (((tag & OUTPUT_CHANGED_AC_ON) != 0U) ? OUTPUT_FLAG_AC_ON : 0U);
+        current->flags ^= (uint8_t)toggled;
+        if ((tag & OUTPUT_CHANGED_WIPER) != 0U) {
+            ok = ok && get_bytes(decoder, &current->wiper_mode, 1U);
+        }
+        if ((tag & OUTPUT_CHANGED_LIMIT) != 0U) {
+            ok = ok && get_bytes(decoder, &current->limit_request, sizeof(current->limit_request));
+        }
+        if ((tag & OUTPUT_CHANGED_FAN) != 0U) {
+            ok = ok && get_bytes(decoder, &current->fan_stage, 1U);
+        }
+        if ((tag & OUTPUT_CHANGED_BLEND) != 0U) {
+            ok = ok && get_bytes(decoder, &current->blend_pct, 1U);
+        }
+        if ((tag & OUTPUT_CHANGED_PARK) != 0U) {
+            ok = ok && get_bytes(decoder, &current->park_step, 1U);
+        }
+    } else {
+    }
+    
+    current->ms += dt;
+    return ok;
+}
+
+bool output_delta_decode_next(output_delta_decoder_t* decoder, output_record_t* record) {
+    if (decoder->failed || (decoder->ticks_left == 0U)) {
+        return false;
+    }
+    
+    if (decoder->keyframe_pending) {
+        decoder->keyframe_pending = false;
+    } else if (decoder->run_ticks > 0U) {
+        decoder->current.ms += decoder->run_dt;
+        decoder->run_ticks--;
+    } else if (!decode_entry(decoder)) {
+        decoder->failed = true;
+        return false;
+    } else {
+    }
+    
+    decoder->ticks_left--;
+    *record = decoder->current;
+    return true;
+}
+
+bool output_delta_decode_complete(const output_delta_decoder_t* decoder) {
+    return !decoder->failed && (decoder->ticks_left == 0U) && (decoder->run_ticks == 0U) &&
+           (decoder->p == decoder->end);
+}
@@ -0,0 +1,177 @@
+#ifndef OUTPUT_LOG_H
+#define OUTPUT_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "hal_io.h"
+#include "spsc_ring.h"
+
+/* Binary output log: a header followed by one fixed-size record per tick.
+ * Like the compiled scenario format, values are in host byte order and
+ * byte_order lets a reader reject a foreign file. */
+#define OUTPUT_LOG_MAGIC       "CPOL"
+#define OUTPUT_LOG_VERSION     (1U)
+#define OUTPUT_LOG_BYTE_ORDER  (0x0102U)
+#define OUTPUT_LOG_SUFFIX      ".outb"
+
+/* Change-only output log: after a header like the binary one, the ticks
+ * are grouped into chunks of about OUTPUT_DELTA_KEYFRAME_MS. Each chunk
+ * has an output_delta_chunk_t header and then a payload. The payload
+ * starts with a full output_record_t, the keyframe. After that come
+ * entries, each starting with a tag byte:
+ *  - OUTPUT_DELTA_RUN, varint n, varint dt: n ticks dt ms apart, no
+ *    output changed;
+ *  - a nonzero OUTPUT_CHANGED_* mask, varint dt: one tick dt ms after the
+ *    previous one. The new values of the changed byte and word fields
+ *    follow in mask bit order; a changed boolean just toggles.
+ * Varints are little-endian base 128. A reader can hop from chunk header to
+ * chunk header to reach a point in time without decoding what lies before
+ * it. */
+#define OUTPUT_DELTA_MAGIC        "CPOD"
+#define OUTPUT_DELTA_SUFFIX       ".outd"
+#define OUTPUT_DELTA_SYNC         "KEYF"
+#define OUTPUT_DELTA_KEYFRAME_MS  (10000U)
+#define OUTPUT_DELTA_CHUNK_MAX    (16384U)
+#define OUTPUT_DELTA_ENTRY_MAX    (16U)
+
+#define OUTPUT_DELTA_RUN          (0x00U)
+#define OUTPUT_CHANGED_BRAKE      (0x01U)
+#define OUTPUT_CHANGED_WIPER      (0x02U)
+#define OUTPUT_CHANGED_ALARM      (0x04U)
+#define OUTPUT_CHANGED_LIMIT      (0x08U)
+#define OUTPUT_CHANGED_FAN        (0x10U)
+#define OUTPUT_CHANGED_AC_ON      (0x20U)
+#define OUTPUT_CHANGED_BLEND      (0x40U)
+#define OUTPUT_CHANGED_PARK       (0x80U)
+
+#define OUTPUT_LOG_CSV_HEADER  "ms,brake,wiper_mode,alarm,limit_req,fan_stage,ac_on,blend,park_step\n"
+/* Room for the longest line output_log_format_csv() produces. */
+#define OUTPUT_LOG_CSV_LINE_MAX (48U)
+
+#define OUTPUT_LOG_BLOCK_RECORDS (1024U)
+#define OUTPUT_LOG_BLOCKS        (3U)
+
+#define OUTPUT_FLAG_BRAKE (0x01U)
+#define OUTPUT_FLAG_ALARM (0x02U)
+#define OUTPUT_FLAG_AC_ON (0x04U)
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint32_t record_size;
+} output_log_header_t;
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint32_t record_size;
+    uint32_t keyframe_ms;
+} output_delta_header_t;
+
+typedef struct {
+    char sync[4];
+    uint32_t first_ms;
+    uint32_t last_ms;
+    uint32_t ticks;
+    uint32_t payload_len;
+} output_delta_chunk_t;
+
+/* One tick of hal_outputs_t; its booleans are packed into `flags`. */
+typedef struct {
+    uint32_t ms;
+    uint16_t limit_request;
+    uint8_t wiper_mode;
+    uint8_t fan_stage;
+    uint8_t blend_pct;
+    uint8_t park_step;
+    uint8_t flags;
+    uint8_t reserved;
+} output_record_t;
+
+typedef enum {
+    OUTPUT_LOG_CSV = 0U,
+    OUTPUT_LOG_BINARY,
+    OUTPUT_LOG_DELTA
+} output_log_format_e;
+
+typedef struct {
+    uint32_t count;
+    output_record_t records[OUTPUT_LOG_BLOCK_RECORDS];
+} output_log_block_t;
+
+/* Background output writer: the simulation packs one record per tick into
+ * the current ring block and hands full blocks to an I/O thread through a
+ * spsc_ring_t. The thread writes them as they are or formats them as CSV.
+ * Memory use is fixed by the constants above. */
+typedef struct output_log {
+    int fd;
+    pthread_t thread;
+    bool thread_started;
+    output_log_format_e format;
+    
+    spsc_ring_t ring;
+    bool closing;
+    bool failed;
+    output_log_block_t blocks[OUTPUT_LOG_BLOCKS];
+    
+    /* Simulation side. */
+    uint32_t slot;
+    uint32_t fill;
+    uint32_t stalls;
+    
+    /* I/O thread side. CSV lines and finished delta chunks are collected
+     * in `text` and written together. */
+    char text[OUTPUT_LOG_BLOCK_RECORDS * OUTPUT_LOG_CSV_LINE_MAX];
+    uint32_t staged;
+    output_record_t delta_prev;
+    uint32_t run_ticks;
+    uint32_t run_dt;
+    uint32_t chunk_first_ms;
+    uint32_t chunk_ticks;
+    uint32_t chunk_len;
+    uint8_t chunk[OUTPUT_DELTA_CHUNK_MAX];
+} output_log_t;
+
+/* Walks the ticks of one change-only chunk. */
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    output_record_t current;
+    uint32_t ticks_left;
+    uint32_t run_ticks;
+    uint32_t run_dt;
+    bool keyframe_pending;
+    bool failed;
+} output_delta_decoder_t;
+
+/* Binary for names ending in OUTPUT_LOG_SUFFIX, change-only for
+ * OUTPUT_DELTA_SUFFIX, CSV otherwise. */
+output_log_format_e output_log_format_for(const char* filename);
+/* Creates the file, writes its header and starts the I/O thread. */
+bool output_log_open(output_log_t* log, const char* filename, output_log_format_e format);
+bool output_log_is_open(const output_log_t* log);
+/* Only waits when the I/O thread has fallen a full ring behind; each such
+ * wait is counted in `stalls`. */
+void output_log_append(output_log_t* log, uint32_t now_ms, const hal_outputs_t* out);
+/* Hands over the last partial block, waits for the I/O thread and closes
+ * the file. False when any write failed. */
+bool output_log_close(output_log_t* log);
+
+void output_log_pack(output_record_t* record, uint32_t now_ms, const hal_outputs_t* out);
+/* Formats `record` as one line of the CSV layout, '\n' included, and
+ * returns its length. */
+uint32_t output_log_format_csv(const output_record_t* record, char* line);
+
+/* `payload` must hold chunk->payload_len bytes. */
+void output_delta_decode_start(output_delta_decoder_t* decoder, const output_delta_chunk_t* chunk,
+                               const uint8_t* payload);
+/* The chunk's next tick, or false after its last one or on a malformed
+ * payload (then `failed` is set). */
+bool output_delta_decode_next(output_delta_decoder_t* decoder, output_record_t* record);
+/* True once every tick was decoded and the payload was used up exactly. */
+bool output_delta_decode_complete(const output_delta_decoder_t* decoder);
+
+#endif /* OUTPUT_LOG_H */
@@ -1,106 +1,465 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include "scenario.h"
-#include <stdio.h>
+#include "scenario_bin.h"
+#include "scenario_gen.h"
+#include "scenario_stream.h"
 #include <string.h>
-#include <stdlib.h>
 
-static FILE* scenario_file = NULL;
-static bool header_read = false;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENARIO_HAVE_MMAP 1
+#else
+#define SCENARIO_HAVE_MMAP 0
+#endif
 
-bool scenario_init(const char* filename) {
-    if (filename == NULL) {
+#define SCENARIO_LINE_MAX (2048U)
+#define SCENARIO_UTF8_BOM  "\xEF\xBB\xBF"
+
+static scenario_reader_t default_reader;
+static scenario_stream_t default_stream;
+static scenario_gen_t default_gen;
+
+#define SCENARIO_COLUMN_NAME(name, type) #name,
+
+static const char* const column_names[SCENARIO_NUM_COLUMNS] = {
+    SCENARIO_COLUMNS(SCENARIO_COLUMN_NAME)
+};
+
+/* The built-in layout has no sector columns. */
+void scenario_schema_default(scenario_schema_t* schema) {
+    uint8_t c = 0U;
+    
+    for (c = 0U; c < (uint8_t)SCENARIO_COL_sector0_mm; c++) {
+        schema->slot[c] = c;
+    }
+    schema->slot[SCENARIO_COL_sector0_mm] = SCENARIO_SLOT_VOICE;
+    schema->field_count = (uint8_t)(SCENARIO_COL_sector0_mm + 1);
+    schema->voice_last = true;
+}
+
+static uint8_t slot_for_name(const char* name, size_t len, const bool* taken) {
+    uint8_t c = 0U;
+    
+    if ((len == (sizeof(SCENARIO_VOICE_COLUMN) - 1U)) &&
+        (memcmp(name, SCENARIO_VOICE_COLUMN, len) == 0)) {
+        return taken[SCENARIO_SLOT_VOICE] ? SCENARIO_SLOT_SKIP : SCENARIO_SLOT_VOICE;
+    }
+    
+    for (c = 0U; c < (uint8_t)SCENARIO_NUM_COLUMNS; c++) {
+        if ((strlen(column_names[c]) == len) && (memcmp(column_names[c], name, len) == 0)) {
+            return taken[c] ? SCENARIO_SLOT_SKIP : c;
+        }
+    }
+    
+    return SCENARIO_SLOT_SKIP;
+}
+
+/* The first occurrence of a repeated name wins; later copies are skipped. */
+bool scenario_schema_resolve(scenario_schema_t* schema, const char* header, size_t len) {
+    const char* p = header;
+    const char* end = header + len;
+    const char* name = NULL;
+    const char* name_end = NULL;
+    bool taken[SCENARIO_NUM_SLOTS] = {false};
+    uint8_t slot = 0U;
+    
+    memset(schema, 0, sizeof(scenario_schema_t));
+    if ((len >= (sizeof(SCENARIO_UTF8_BOM) - 1U)) &&
+        (memcmp(p, SCENARIO_UTF8_BOM, sizeof(SCENARIO_UTF8_BOM) - 1U) == 0)) {
+        p += sizeof(SCENARIO_UTF8_BOM) - 1U;
+    }
+    
+    while ((p < end) && (*p != '\n') && (schema->field_count < SCENARIO_MAX_FIELDS)) {
+        name = p;
+        while ((p < end) && (*p != ',') && (*p != '\n')) {
+            p++;
+        }
+        name_end = p;
+        while ((name < name_end) && (*name == ' ')) {
+            name++;
+        }
+        while ((name_end > name) && ((name_end[-1] == ' ') || (name_end[-1] == '\r'))) {
+            name_end--;
+        }
+        
+        slot = slot_for_name(name, (size_t)(name_end - name), taken);
+        taken[slot] = true;
+        schema->slot[schema->field_count] = slot;
+        schema->field_count++;
+        
+        if ((p < end) && (*p == ',')) {
+            p++;
+        } else {
+            break;
+        }
+    }
+    
+    schema->voice_last = (schema->field_count > 0U) &&
+                         (schema->slot[schema->field_count - 1U] == SCENARIO_SLOT_VOICE);
+    return taken[SCENARIO_COL_ms];
+}
+
+/* Reads up to SCENARIO_LINE_MAX - 1 bytes of the next line and drops the
+ * rest of an over-long one, so it cannot turn into an extra row. */
+static bool read_line(FILE* file, char* line, size_t* len) {
+    int c = 0;
+    
+    if (fgets(line, (int)SCENARIO_LINE_MAX, file) == NULL) {
+        return false;
+    }
+    
+    *len = strlen(line);
+    if ((*len == (SCENARIO_LINE_MAX - 1U)) && (line[*len - 1U] != '\n')) {
+        do {
+            c = fgetc(file);
+        } while ((c != EOF) && (c != '\n'));
+    }
+    return true;
+}
+
+/* Reads the header line of a stdio stream into `schema`. An empty file
+ * keeps the default layout and simply has no rows. */
+static bool read_header(FILE* file, scenario_schema_t* schema) {
+    char line[SCENARIO_LINE_MAX];
+    size_t len = 0U;
+    
+    scenario_schema_default(schema);
+    if (!read_line(file, line, &len)) {
+        return true;
+    }
+    
+    return scenario_schema_resolve(schema, line, len);
+}
+
+bool scenario_reader_open_buffered(scenario_reader_t* reader, const char* filename) {
+    if ((reader == NULL) || (filename == NULL)) {
+        return false;
+    }
+    
+    memset(reader, 0, sizeof(scenario_reader_t));
+    reader->file = fopen(filename, "r");
+    if (reader->file == NULL) {
         return false;
     }
     
-    scenario_file = fopen(filename, "r");
-    if (scenario_file == NULL) {
+    if (!read_header(reader->file, &reader->schema)) {
+        scenario_reader_close(reader);
         return false;
     }
     
-    header_read = false;
     return true;
 }
 
-bool scenario_get_next_row(scenario_row_t* row) {
-    char line[512];
-    char* token;
-    uint8_t field_idx = 0U;
+/* The header is resolved here, before the producer thread starts, so a
+ * file without an `ms` column is rejected by the open call. */
+bool scenario_reader_open_stream(scenario_reader_t* reader, scenario_stream_t* stream,
+                                 const char* filename, bool direct_io) {
+    FILE* file = NULL;
+    bool header_ok = false;
+    
+    if ((reader == NULL) || (stream == NULL) || (filename == NULL)) {
+        return false;
+    }
+    
+    memset(reader, 0, sizeof(scenario_reader_t));
+    file = fopen(filename, "r");
+    if (file == NULL) {
+        return false;
+    }
+    header_ok = read_header(file, &reader->schema);
+    fclose(file);
+    
+    if (!header_ok || !scenario_stream_open(stream, filename, direct_io, &reader->schema)) {
+        return false;
+    }
+    
+    reader->stream = stream;
+    return true;
+}
+
+bool scenario_reader_open_generated(scenario_reader_t* reader, scenario_gen_t* gen,
+                                    const char* description) {
+    scenario_gen_params_t params;
+    
+    if ((reader == NULL) || (gen == NULL)) {
+        return false;
+    }
+    
+    memset(reader, 0, sizeof(scenario_reader_t));
+    if (!scenario_gen_parse(&params, description)) {
+        return false;
+    }
+    
+    scenario_gen_start(gen, &params);
+    reader->gen = gen;
+    return true;
+}
+
+static const char* find_line_end(const char* p, const char* end) {
+    const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+    
+    return (nl != NULL) ? nl : end;
+}
+
+#if SCENARIO_HAVE_MMAP
+static bool map_file(scenario_reader_t* reader, const char* filename) {
+    struct stat st;
+    void* map = NULL;
+    int fd = open(filename, O_RDONLY);
+    
+    if (fd < 0) {
+        return false;
+    }
     
-    if ((scenario_file == NULL) || (row == NULL)) {
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size <= 0)) {
+        (void)close(fd);
         return false;
     }
     
-    if (!header_read) {
-        if (fgets(line, sizeof(line), scenario_file) == NULL) {
-            return false;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    
+    (void)posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    reader->map = (const char*)map;
+    reader->map_len = (size_t)st.st_size;
+    return true;
+}
+#endif
+
+#define SCENARIO_BIN_COLUMN_FITS(name, type) \
+    && ((hdr->column_offset[SCENARIO_COL_##name] % SCENARIO_BIN_ALIGN) == 0U) \
+    && (hdr->column_offset[SCENARIO_COL_##name] <= len) \
+    && (((uint64_t)hdr->row_count * sizeof(type)) <= \
+        (len - hdr->column_offset[SCENARIO_COL_##name]))
+
+static bool is_compiled(const scenario_reader_t* reader) {
+    return (reader->map_len >= sizeof(scenario_bin_header_t)) &&
+           (memcmp(reader->map, SCENARIO_BIN_MAGIC, 4U) == 0);
+}
+
+/* Header checks only, so opening stays constant time whatever the row
+ * count. Voice entries are range-checked as they are used. */
+static bool compiled_header_valid(const scenario_reader_t* reader) {
+    const scenario_bin_header_t* hdr = (const scenario_bin_header_t*)(const void*)reader->map;
+    uint64_t len = (uint64_t)reader->map_len;
+    
+    return (hdr->version == SCENARIO_BIN_VERSION) &&
+           (hdr->byte_order == SCENARIO_BIN_BYTE_ORDER) &&
+           (hdr->num_columns == (uint32_t)SCENARIO_BIN_NUM_COLUMNS) &&
+           (hdr->file_size == len)
+           SCENARIO_BIN_COLUMNS(SCENARIO_BIN_COLUMN_FITS) &&
+           ((hdr->voice_index_offset % SCENARIO_BIN_ALIGN) == 0U) &&
+           (hdr->voice_index_offset <= len) &&
+           (((uint64_t)hdr->voice_count * sizeof(scenario_bin_voice_t)) <=
+            (len - hdr->voice_index_offset)) &&
+           (hdr->voice_strings_offset <= len) &&
+           (hdr->voice_strings_len <= (len - hdr->voice_strings_offset)) &&
+           ((hdr->voice_strings_len == 0U) ||
+            (reader->map[hdr->voice_strings_offset + hdr->voice_strings_len - 1U] == '\0'));
+}
+
+/* Maps regular files and falls back to stdio for pipes, empty files, CSV
+ * without a trailing newline and platforms without mmap. A compiled file
+ * with a bad header is rejected rather than parsed as text. */
+bool scenario_reader_open(scenario_reader_t* reader, const char* filename) {
+    const char* header_end = NULL;
+    
+    if ((reader == NULL) || (filename == NULL)) {
+        return false;
+    }
+    
+    memset(reader, 0, sizeof(scenario_reader_t));
+#if SCENARIO_HAVE_MMAP
+    if (map_file(reader, filename)) {
+        if (is_compiled(reader)) {
+            if (!compiled_header_valid(reader)) {
+                scenario_reader_close(reader);
+                return false;
+            }
+            reader->compiled = true;
+            return true;
         }
-        header_read = true;
-    }
-    
-    if (fgets(line, sizeof(line), scenario_file) == NULL) {
-        return false;
-    }
-    
-    memset(row, 0, sizeof(scenario_row_t));
-    
-    token = strtok(line, ",");
-    while ((token != NULL) && (field_idx < 11U)) {
-        switch (field_idx) {
-            case 0U:
-                row->ms = (uint32_t)strtoul(token, NULL, 10);
-                break;
-            case 1U:
-                row->distance_mm = (uint16_t)strtoul(token, NULL, 10);
-                break;
-            case 2U:
-                row->rain_pct = (uint8_t)strtoul(token, NULL, 10);
-                break;
-            case 3U:
-                row->speed_kph = (uint16_t)strtoul(token, NULL, 10);
-                break;
-            case 4U:
-                row->sign_event = (uint16_t)strtoul(token, NULL, 10);
-                break;
-            case 5U:
-                row->gap_found = (strtoul(token, NULL, 10) != 0U);
-                break;
-            case 6U:
-                row->gap_width_mm = (uint16_t)strtoul(token, NULL, 10);
-                break;
-            case 7U:
-                row->cabin_tc_x10 = (int16_t)strtol(token, NULL, 10);
-                break;
-            case 8U:
-                row->ambient_tc_x10 = (int16_t)strtol(token, NULL, 10);
-                break;
-            case 9U:
-                row->humid_pct = (uint8_t)strtoul(token, NULL, 10);
-                break;
-            case 10U:
-                row->setpoint_x10 = (int16_t)strtol(token, NULL, 10);
-                break;
-            default:
-                break;
+        
+        /* The CSV parser relies on a final '\n' as its end marker. */
+        if (reader->map[reader->map_len - 1U] == '\n') {
+            header_end = find_line_end(reader->map, reader->map + reader->map_len);
+            reader->map_pos = (size_t)(header_end - reader->map) + 1U;
+            if (!scenario_schema_resolve(&reader->schema, reader->map,
+                                         (size_t)(header_end - reader->map))) {
+                scenario_reader_close(reader);
+                return false;
+            }
+            return true;
         }
-        field_idx++;
-        token = strtok(NULL, ",");
+        
+        scenario_reader_close(reader);
+    }
+#else
+    (void)header_end;
+#endif
+    
+    return scenario_reader_open_buffered(reader, filename);
+}
+
+static bool next_mapped_row(scenario_reader_t* reader, scenario_row_t* row) {
+    const char* next = NULL;
+    
+    if (reader->map_pos >= reader->map_len) {
+        return false;
+    }
+    
+    next = scenario_parse_csv_line(&reader->schema, reader->map + reader->map_pos,
+                                   reader->map + reader->map_len, row);
+    reader->map_pos = (size_t)(next - reader->map);
+    return true;
+}
+
+#define SCENARIO_BIN_LOAD(name, type) \
+    row->name = ((const type*)(const void*)(reader->map + \
+                 hdr->column_offset[SCENARIO_COL_##name]))[reader->row_index];
+
+static bool next_compiled_row(scenario_reader_t* reader, scenario_row_t* row) {
+    const scenario_bin_header_t* hdr = (const scenario_bin_header_t*)(const void*)reader->map;
+    const scenario_bin_voice_t* voice = NULL;
+    
+    if (reader->row_index >= hdr->row_count) {
+        return false;
     }
     
-    if (token != NULL) {
-        char* newline = strchr(token, '\n');
-        if (newline != NULL) {
-            *newline = '\0';
+    SCENARIO_BIN_COLUMNS(SCENARIO_BIN_LOAD)
+    row->sampled = (uint32_t)SCENARIO_SAMPLED_ALL;
+    
+    row->voice_cmd[0] = '\0';
+    if (reader->voice_index < hdr->voice_count) {
+        voice = (const scenario_bin_voice_t*)(const void*)(reader->map + hdr->voice_index_offset);
+        voice += reader->voice_index;
+        if (voice->row == reader->row_index) {
+            if (voice->string_offset < hdr->voice_strings_len) {
+                strncpy(row->voice_cmd,
+                        reader->map + hdr->voice_strings_offset + voice->string_offset,
+                        MAX_VOICE_CMD_LEN - 1U);
+                row->voice_cmd[MAX_VOICE_CMD_LEN - 1U] = '\0';
+            }
+            reader->voice_index++;
         }
-        strncpy(row->voice_cmd, token, MAX_VOICE_CMD_LEN - 1U);
-        row->voice_cmd[MAX_VOICE_CMD_LEN - 1U] = '\0';
     }
     
+    reader->row_index++;
     return true;
 }
 
-void scenario_close(void) {
-    if (scenario_file != NULL) {
-        fclose(scenario_file);
-        scenario_file = NULL;
-        header_read = false;
+bool scenario_reader_next(scenario_reader_t* reader, scenario_row_t* row) {
+    /* Room for the '\n' that a last line may lack, the terminator and a
+     * full vector load past the longest line. */
+    char line[SCENARIO_LINE_MAX + 1U + SCENARIO_CSV_LOOKAHEAD];
+    size_t len = 0U;
+    
+    if ((reader == NULL) || (row == NULL)) {
+        return false;
+    }
+    
+    if (reader->stream != NULL) {
+        return scenario_stream_next(reader->stream, row);
+    }
+    
+    if (reader->gen != NULL) {
+        return scenario_gen_next(reader->gen, row);
+    }
+    
+    if (reader->compiled) {
+        return next_compiled_row(reader, row);
+    }
+    
+    if (reader->map != NULL) {
+        return next_mapped_row(reader, row);
+    }
+    
+    if (reader->file == NULL) {
+        return false;
     }
-}
\ No newline at end of file
+    
+    if (!read_line(reader->file, line, &len)) {
+        return false;
+    }
+    
+    if ((len == 0U) || (line[len - 1U] != '\n')) {
+        line[len] = '\n';
+        line[len + 1U] = '\0';
+    }
+    
+    (void)scenario_parse_csv_line(&reader->schema, line, line + sizeof(line), row);
+    return true;
+}
+
+uint32_t scenario_reader_channels(const scenario_reader_t* reader) {
+    const scenario_bin_header_t* hdr = NULL;
+    uint32_t channels = 0U;
+    uint8_t f = 0U;
+    
+    if (reader->gen != NULL) {
+        return (uint32_t)(SCENARIO_SAMPLED_ALL &
+                          ~(SCENARIO_SECTOR_CHANNELS | SCENARIO_SAMPLED(rain_raw)));
+    }
+    
+    if (reader->compiled) {
+        hdr = (const scenario_bin_header_t*)(const void*)reader->map;
+        return hdr->channels & (uint32_t)SCENARIO_SAMPLED_ALL;
+    }
+    
+    for (f = 0U; f < reader->schema.field_count; f++) {
+        if (reader->schema.slot[f] < SCENARIO_SLOT_VOICE) {
+            channels |= (uint32_t)1U << reader->schema.slot[f];
+        }
+    }
+    return channels;
+}
+
+void scenario_reader_close(scenario_reader_t* reader) {
+    if (reader == NULL) {
+        return;
+    }
+    
+    if (reader->stream != NULL) {
+        scenario_stream_close(reader->stream);
+    }
+#if SCENARIO_HAVE_MMAP
+    if (reader->map != NULL) {
+        (void)munmap((void*)(uintptr_t)reader->map, reader->map_len);
+    }
+#endif
+    if (reader->file != NULL) {
+        fclose(reader->file);
+    }
+    memset(reader, 0, sizeof(scenario_reader_t));
+}
+
+bool scenario_init(const char* filename) {
+    return scenario_reader_open(&default_reader, filename);
+}
+
+bool scenario_init_streaming(const char* filename, bool direct_io) {
+    return scenario_reader_open_stream(&default_reader, &default_stream, filename, direct_io);
+}
+
+bool scenario_init_generated(const char* description) {
+    return scenario_reader_open_generated(&default_reader, &default_gen, description);
+}
+
+bool scenario_get_next_row(scenario_row_t* row) {
+    return scenario_reader_next(&default_reader, row);
+}
+
+uint32_t scenario_channels(void) {
+    return scenario_reader_channels(&default_reader);
+}
+
+void scenario_close(void) {
+    scenario_reader_close(&default_reader);
+}
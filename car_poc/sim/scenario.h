@@ -3,9 +3,63 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 #define MAX_VOICE_CMD_LEN (64U)
 
+/* Numeric scenario channels: CSV header name, which is also the
+ * scenario_row_t member, and the width the value is stored with. A new
+ * sensor channel is one row here plus its member; recordings then name it
+ * in their header line. */
+#define SCENARIO_COLUMNS(X) \
+    X(ms,             uint32_t) \
+    X(distance_mm,    uint16_t) \
+    X(rain_pct,       uint8_t)  \
+    X(speed_kph,      uint16_t) \
+    X(sign_event,     uint16_t) \
+    X(gap_found,      uint8_t)  \
+    X(gap_width_mm,   uint16_t) \
+    X(cabin_tc_x10,   int16_t)  \
+    X(ambient_tc_x10, int16_t)  \
+    X(humid_pct,      uint8_t)  \
+    X(setpoint_x10,   int16_t)  \
+    X(sector0_mm,     uint16_t) \
+    X(sector1_mm,     uint16_t) \
+    X(sector2_mm,     uint16_t) \
+    X(sector3_mm,     uint16_t) \
+    X(sector4_mm,     uint16_t) \
+    X(sector5_mm,     uint16_t) \
+    X(sector6_mm,     uint16_t) \
+    X(sector7_mm,     uint16_t) \
+    X(rain_raw,       uint8_t)
+
+#define SCENARIO_VOICE_COLUMN "voice_cmd"
+
+#define SCENARIO_COL_ENUM(name, type) SCENARIO_COL_##name,
+
+typedef enum {
+    SCENARIO_COLUMNS(SCENARIO_COL_ENUM)
+    SCENARIO_NUM_COLUMNS
+} scenario_col_e;
+
+/* Bit of a channel in scenario_row_t.sampled. */
+#define SCENARIO_SAMPLED(name)  (1UL << SCENARIO_COL_##name)
+#define SCENARIO_SAMPLED_ALL    ((1UL << SCENARIO_NUM_COLUMNS) - 1UL)
+
+/* The distance-array sectors: consecutive from sector0_mm and after the
+ * built-in column layout. A recording without them has a single forward
+ * sensor in distance_mm. */
+#define SCENARIO_NUM_SECTORS    (SCENARIO_COL_sector7_mm - SCENARIO_COL_sector0_mm + 1)
+#define SCENARIO_SECTOR_CHANNELS \
+    (((1UL << SCENARIO_NUM_SECTORS) - 1UL) << SCENARIO_COL_sector0_mm)
+
+/* `sampled` marks the channels that carry a new sample at `ms`. In a
+ * multi-rate recording each channel is written only at its own rate and
+ * the other cells of the row are left empty. In compiled files and
+ * generated rows every channel is sampled in every row. Bits of channels
+ * the recording does not have are meaningless: mask `sampled` with
+ * scenario_reader_channels(), as the HAL mock does. */
 typedef struct {
     uint32_t ms;
     uint16_t distance_mm;
@@ -18,11 +72,115 @@ typedef struct {
     int16_t ambient_tc_x10;
     uint8_t humid_pct;
     int16_t setpoint_x10;
+    uint16_t sector0_mm;
+    uint16_t sector1_mm;
+    uint16_t sector2_mm;
+    uint16_t sector3_mm;
+    uint16_t sector4_mm;
+    uint16_t sector5_mm;
+    uint16_t sector6_mm;
+    uint16_t sector7_mm;
+    uint8_t rain_raw;
     char voice_cmd[MAX_VOICE_CMD_LEN];
+    uint32_t sampled;
 } scenario_row_t;
 
+typedef char scenario_sampled_fits[(SCENARIO_NUM_COLUMNS <= 31) ? 1 : -1];
+
+/* Column dispatch table resolved once from the header line: slot[i] is the
+ * scenario_col_e that CSV field i feeds, SCENARIO_SLOT_VOICE or
+ * SCENARIO_SLOT_SKIP. Channels the header does not name are left zero (see
+ * scenario_reader_channels()), and fields past SCENARIO_MAX_FIELDS are
+ * ignored. When voice_cmd is the last field it takes the rest of the line,
+ * commas included. */
+#define SCENARIO_MAX_FIELDS  (64U)
+#define SCENARIO_SLOT_VOICE  ((uint8_t)SCENARIO_NUM_COLUMNS)
+#define SCENARIO_SLOT_SKIP   ((uint8_t)(SCENARIO_NUM_COLUMNS + 1))
+#define SCENARIO_NUM_SLOTS   (SCENARIO_NUM_COLUMNS + 2)
+
+typedef struct {
+    uint8_t field_count;
+    bool voice_last;
+    uint8_t slot[SCENARIO_MAX_FIELDS];
+} scenario_schema_t;
+
+struct scenario_stream;
+struct scenario_gen;
+
+/* One open scenario file. Readers share no state, so each simulation
+ * instance (or worker thread) can own one. Regular files are mapped: CSV is
+ * parsed in place, compiled files (scenario_bin.h) are read column by
+ * column. `file` is only used for the stdio fallback. */
+typedef struct {
+    FILE* file;
+    scenario_schema_t schema;
+    const char* map;
+    size_t map_len;
+    size_t map_pos;
+    bool compiled;
+    uint32_t row_index;
+    uint32_t voice_index;
+    struct scenario_stream* stream;
+    struct scenario_gen* gen;
+} scenario_reader_t;
+
+/* Column order of the built-in scenarios; readers start from it until a
+ * header line has been resolved. */
+void scenario_schema_default(scenario_schema_t* schema);
+/* Builds the dispatch table from `len` bytes of header line. Unknown names
+ * are skipped; fails if there is no `ms` column to time the rows by. */
+bool scenario_schema_resolve(scenario_schema_t* schema, const char* header, size_t len);
+
+/* CSV row tokenizers; the best supported one is picked on first use. */
+typedef enum {
+    SCENARIO_ISA_SCALAR = 0U,
+    SCENARIO_ISA_SSE42 = 1U,
+    SCENARIO_ISA_AVX2 = 2U
+} scenario_isa_e;
+
+/* Bytes the vector tokenizers may load past the current position. Buffers
+ * with this much slack after their last line are parsed entirely with
+ * vector loads; otherwise the tail falls back to scalar code. */
+#define SCENARIO_CSV_LOOKAHEAD (80U)
+
+bool scenario_isa_supported(scenario_isa_e isa);
+bool scenario_set_isa(scenario_isa_e isa);
+scenario_isa_e scenario_get_isa(void);
+const char* scenario_isa_name(scenario_isa_e isa);
+
+/* Parses one CSV data row. The line must be terminated by '\n', which also
+ * bounds every scan; `end` is the end of readable memory, which no load
+ * crosses. Returns the first byte of the following line. */
+const char* scenario_parse_csv_line(const scenario_schema_t* schema, const char* line,
+                                    const char* end, scenario_row_t* row);
+/* True if the '\n'-terminated line is a well-formed row for `schema`; the
+ * parser itself reads bad fields as zero. Empty channel cells are valid:
+ * they are the unsampled channels of a multi-rate row. */
+bool scenario_csv_line_valid(const scenario_schema_t* schema, const char* line);
+
+bool scenario_reader_open(scenario_reader_t* reader, const char* filename);
+bool scenario_reader_open_buffered(scenario_reader_t* reader, const char* filename);
+/* CSV read and parsed ahead on a background thread into `stream`, which
+ * the caller owns and must keep alive until scenario_reader_close(). */
+bool scenario_reader_open_stream(scenario_reader_t* reader, struct scenario_stream* stream,
+                                 const char* filename, bool direct_io);
+/* Rows made on demand by the procedural generator (scenario_gen.h) from a
+ * description string; `gen` is owned by the caller like `stream`. */
+bool scenario_reader_open_generated(scenario_reader_t* reader, struct scenario_gen* gen,
+                                    const char* description);
+bool scenario_reader_next(scenario_reader_t* reader, scenario_row_t* row);
+/* SCENARIO_SAMPLED() bits of the channels the recording has: the columns
+ * a CSV header names, those stored with a compiled file, and every channel
+ * but the sectors and rain_raw for generated rows. The others are left zero
+ * and the HAL mock reports them invalid. */
+uint32_t scenario_reader_channels(const scenario_reader_t* reader);
+void scenario_reader_close(scenario_reader_t* reader);
+
 bool scenario_init(const char* filename);
+bool scenario_init_streaming(const char* filename, bool direct_io);
+bool scenario_init_generated(const char* description);
 bool scenario_get_next_row(scenario_row_t* row);
+uint32_t scenario_channels(void);
 void scenario_close(void);
 
-#endif /* SCENARIO_H */
\ No newline at end of file
+#endif /* SCENARIO_H */
@@ -0,0 +1,44 @@
+#ifndef SCENARIO_BIN_H
+#define SCENARIO_BIN_H
+
+#include <stdint.h>
+#include "scenario.h"
+
+/* Compiled scenario: a header, one packed array per sensor column and a
+ * sparse voice table. Every section starts on an 8-byte boundary, so a
+ * mapped file can be read through typed pointers. Values are stored in
+ * host byte order; byte_order lets a reader reject a foreign file. */
+#define SCENARIO_BIN_MAGIC       "SCNB"
+#define SCENARIO_BIN_VERSION     (2U)
+#define SCENARIO_BIN_BYTE_ORDER  (0x0102U)
+#define SCENARIO_BIN_ALIGN       (8U)
+
+/* Columns are stored in SCENARIO_COLUMNS order and widths. Adding a
+ * channel changes num_columns, so older compiled files are rejected and
+ * must be recompiled. */
+#define SCENARIO_BIN_COLUMNS(X)   SCENARIO_COLUMNS(X)
+#define SCENARIO_BIN_NUM_COLUMNS  SCENARIO_NUM_COLUMNS
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint32_t num_columns;
+    uint32_t row_count;
+    uint32_t voice_count;
+    /* scenario_reader_channels() of the source recording. */
+    uint32_t channels;
+    uint64_t column_offset[SCENARIO_BIN_NUM_COLUMNS];
+    uint64_t voice_index_offset;
+    uint64_t voice_strings_offset;
+    uint64_t voice_strings_len;
+    uint64_t file_size;
+} scenario_bin_header_t;
+
+/* One entry per row that carries a voice command, sorted by row. */
+typedef struct {
+    uint32_t row;
+    uint32_t string_offset;
+} scenario_bin_voice_t;
+
+#endif /* SCENARIO_BIN_H */
@@ -0,0 +1,475 @@
+#include "scenario.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#define SCENARIO_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define SCENARIO_HAVE_X86 0
+#endif
+
+/* No tokenizer chosen yet; the first parse picks the best supported one. */
+#define SCENARIO_ISA_UNSET (0xFFFFFFFFU)
+
+/* Vector tokenizers classify a CSV_WINDOW-byte window at a time and load
+ * 16 bytes for a digit run starting anywhere inside it. */
+#define CSV_WINDOW     (64U)
+#define CSV_DIGIT_LOAD (16U)
+#define CSV_MAX_DIGITS (8U)
+
+typedef char csv_lookahead_covers_window[
+    (SCENARIO_CSV_LOOKAHEAD >= (CSV_WINDOW + CSV_DIGIT_LOAD)) ? 1 : -1];
+
+static uint32_t active_isa = SCENARIO_ISA_UNSET;
+
+bool scenario_isa_supported(scenario_isa_e isa) {
+    bool supported = false;
+    
+    switch (isa) {
+        case SCENARIO_ISA_SCALAR:
+            supported = true;
+            break;
+#if SCENARIO_HAVE_X86
+        case SCENARIO_ISA_SSE42:
+            supported = (__builtin_cpu_supports("sse4.2") != 0);
+            break;
+        case SCENARIO_ISA_AVX2:
+            supported = (__builtin_cpu_supports("avx2") != 0);
+            break;
+#endif
+        default:
+            supported = false;
+            break;
+    }
+    
+    return supported;
+}
+
+const char* scenario_isa_name(scenario_isa_e isa) {
+    const char* name = "unknown";
+    
+    if (isa == SCENARIO_ISA_SCALAR) {
+        name = "scalar";
+    } else if (isa == SCENARIO_ISA_SSE42) {
+        name = "sse4.2";
+    } else if (isa == SCENARIO_ISA_AVX2) {
+        name = "avx2";
+    } else {
+    }
+    
+    return name;
+}
+
+bool scenario_set_isa(scenario_isa_e isa) {
+    if (!scenario_isa_supported(isa)) {
+        return false;
+    }
+    
+    __atomic_store_n(&active_isa, (uint32_t)isa, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Readers on several threads may race to make the first choice; they all
+ * pick the same ISA, so the relaxed store is harmless. */
+scenario_isa_e scenario_get_isa(void) {
+    uint32_t isa = __atomic_load_n(&active_isa, __ATOMIC_RELAXED);
+    
+    if (isa == SCENARIO_ISA_UNSET) {
+        isa = (uint32_t)SCENARIO_ISA_SCALAR;
+        if (scenario_isa_supported(SCENARIO_ISA_AVX2)) {
+            isa = (uint32_t)SCENARIO_ISA_AVX2;
+        } else if (scenario_isa_supported(SCENARIO_ISA_SSE42)) {
+            isa = (uint32_t)SCENARIO_ISA_SSE42;
+        } else {
+        }
+        __atomic_store_n(&active_isa, isa, __ATOMIC_RELAXED);
+    }
+    
+    return (scenario_isa_e)isa;
+}
+
+/* Reads one decimal field with an optional leading '-'. Negative values are
+ * returned in two's complement so the narrowing casts give the same result
+ * as strtol(). Needs no bounds: every line ends in '\n', which stops the
+ * digit loop. */
+static const char* parse_field(const char* p, uint32_t* out) {
+    uint32_t value = 0U;
+    uint32_t digit = 0U;
+    bool negative = (*p == '-');
+    
+    if (negative) {
+        p++;
+    }
+    
+    digit = (uint32_t)(uint8_t)*p - (uint32_t)'0';
+    while (digit < 10U) {
+        value = (value * 10U) + digit;
+        p++;
+        digit = (uint32_t)(uint8_t)*p - (uint32_t)'0';
+    }
+    
+    *out = negative ? (0U - value) : value;
+    return p;
+}
+
+/* Copies a voice field that ends at ',' or, when it is the last header
+ * field, at the end of the line. */
+static const char* copy_voice(const char* p, scenario_row_t* row, bool rest_of_line) {
+    const char* voice = p;
+    size_t voice_len = 0U;
+    
+    while ((*p != '\n') && (*p != '\r') && (rest_of_line || (*p != ','))) {
+        p++;
+    }
+    voice_len = (size_t)(p - voice);
+    if (voice_len > (MAX_VOICE_CMD_LEN - 1U)) {
+        voice_len = MAX_VOICE_CMD_LEN - 1U;
+    }
+    memcpy(row->voice_cmd, voice, voice_len);
+    row->voice_cmd[voice_len] = '\0';
+    return p;
+}
+
+static const char* skip_to_delimiter(const char* p) {
+    while ((*p != ',') && (*p != '\n')) {
+        p++;
+    }
+    return p;
+}
+
+#define SCENARIO_STORE_COLUMN(name, type) row->name = (type)values[SCENARIO_COL_##name];
+
+/* An empty cell: the channel has no sample in this row. */
+static uint32_t cell_empty(char c) {
+    return ((c == ',') || (c == '\n') || (c == '\r')) ? 1U : 0U;
+}
+
+/* Fields from field_idx on are missing from a short row; their channels
+ * have no sample in it. */
+static void mark_missing_fields(const scenario_schema_t* schema, uint32_t field_idx,
+                                scenario_row_t* row) {
+    while (field_idx < schema->field_count) {
+        if (schema->slot[field_idx] < SCENARIO_SLOT_VOICE) {
+            row->sampled &= ~((uint32_t)1U << schema->slot[field_idx]);
+        }
+        field_idx++;
+    }
+}
+
+/* Parses fields `field_idx` onwards starting at p. Each field is routed
+ * through the schema's slot table: skipped fields land in a scratch slot,
+ * so the loop has no per-column branches. Empty cells, and the cells a
+ * short row lacks, read as zero and clear the channel's sampled bit;
+ * anything after a number up to the next ',' is ignored. */
+static const char* parse_fields_scalar(const scenario_schema_t* schema, uint32_t field_idx,
+                                       const char* p, uint32_t* values, scenario_row_t* row) {
+    uint8_t slot = 0U;
+    
+    while (field_idx < schema->field_count) {
+        slot = schema->slot[field_idx];
+        field_idx++;
+        if (slot == SCENARIO_SLOT_VOICE) {
+            p = copy_voice(p, row, schema->voice_last);
+        } else {
+            row->sampled &= ~(cell_empty(*p) << slot);
+            p = parse_field(p, &values[slot]);
+        }
+        p = skip_to_delimiter(p);
+        if (*p == '\n') {
+            break;
+        }
+        p++;
+    }
+    
+    mark_missing_fields(schema, field_idx, row);
+    return p;
+}
+
+/* Stores the parsed values and returns the start of the next line. The
+ * stores of adjacent narrow columns are vectorized, so this is inlined to
+ * compile for the caller's ISA: a legacy-SSE copy called from the AVX2
+ * tokenizer with dirty upper registers costs a state transition per row. */
+static inline __attribute__((always_inline))
+const char* finish_line(const char* p, const uint32_t* values, scenario_row_t* row) {
+    SCENARIO_COLUMNS(SCENARIO_STORE_COLUMN)
+    
+    while (*p != '\n') {
+        p++;
+    }
+    return p + 1;
+}
+
+static const char* parse_line_scalar(const scenario_schema_t* schema, const char* line,
+                                     scenario_row_t* row) {
+    uint32_t values[SCENARIO_NUM_SLOTS] = {0U};
+    const char* p = NULL;
+    
+    row->voice_cmd[0] = '\0';
+    row->sampled = (uint32_t)SCENARIO_SAMPLED_ALL;
+    p = parse_fields_scalar(schema, 0U, line, values, row);
+    return finish_line(p, values, row);
+}
+
+/* Strict form of the row grammar: every channel cell is empty or holds an
+ * optional '-' and one to ten digits (ms may not be empty), skipped
+ * columns may hold anything, and the row has exactly the header's field
+ * count unless voice_cmd is last and takes the rest of the line. A '\r'
+ * before the '\n' is allowed. */
+bool scenario_csv_line_valid(const scenario_schema_t* schema, const char* line) {
+    const char* p = line;
+    const char* digits = NULL;
+    uint32_t field_idx = 0U;
+    uint8_t slot = 0U;
+    bool negative = false;
+    
+    while (field_idx < schema->field_count) {
+        slot = schema->slot[field_idx];
+        field_idx++;
+        if (slot < SCENARIO_SLOT_VOICE) {
+            negative = (*p == '-');
+            if (negative) {
+                p++;
+            }
+            digits = p;
+            while (((uint32_t)(uint8_t)*p - (uint32_t)'0') < 10U) {
+                p++;
+            }
+            if (((negative || (slot == (uint8_t)SCENARIO_COL_ms)) && (p == digits)) ||
+                ((p - digits) > 10)) {
+                return false;
+            }
+            if ((*p == '\r') && (p[1] == '\n')) {
+                p++;
+            }
+            if ((*p != ',') && (*p != '\n')) {
+                return false;
+            }
+        } else if ((slot == SCENARIO_SLOT_VOICE) && schema->voice_last) {
+            return true;
+        } else {
+            p = skip_to_delimiter(p);
+        }
+        
+        if (*p == '\n') {
+            return (field_idx == schema->field_count);
+        }
+        p++;
+    }
+    
+    return false;
+}
+
+#if SCENARIO_HAVE_X86
+
+/* ---- Vector tokenizers: one load classifies a window of bytes into a
+ * delimiter bitmask (',' and '\n') and a digit bitmask. A field's digit
+ * run is the count of trailing ones in the digit mask; runs of up to eight
+ * digits are converted in one go, longer ones by the scalar loop. */
+
+#define SSE_TARGET __attribute__((target("sse4.2")))
+#define AVX_TARGET __attribute__((target("avx2")))
+
+typedef struct {
+    uint64_t delim;
+    uint64_t newline;
+    uint64_t minus;
+    uint64_t digit;
+} csv_masks_t;
+
+/* pshufb controls that right-align n digits in the low eight bytes and
+ * zero the rest, indexed by n. */
+static const uint8_t align_digits[CSV_MAX_DIGITS + 1U][16] __attribute__((aligned(16))) = {
+    {0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0U, 1U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0U, 1U, 2U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0x80U, 0x80U, 0U, 1U, 2U, 3U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0x80U, 0U, 1U, 2U, 3U, 4U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0x80U, 0U, 1U, 2U, 3U, 4U, 5U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0x80U, 0U, 1U, 2U, 3U, 4U, 5U, 6U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U},
+    {0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U,
+     0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U, 0x80U}
+};
+
+/* Converts the n <= 8 digits at p; p + 16 must be readable. Pairs, then
+ * quads, then the two halves are combined with multiply-adds. */
+static inline SSE_TARGET uint32_t sse_digits_to_u32(const char* p, uint32_t n) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(const void*)p);
+    
+    v = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    v = _mm_shuffle_epi8(v, _mm_load_si128((const __m128i*)(const void*)align_digits[n]));
+    v = _mm_maddubs_epi16(v, _mm_set1_epi16((short)0x010A));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00010064));
+    v = _mm_packus_epi32(v, v);
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00012710));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+static inline SSE_TARGET uint64_t sse_eq_mask(__m128i v, char c) {
+    return (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+static inline SSE_TARGET uint64_t sse_digit_mask(__m128i v) {
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    
+    return (uint64_t)(uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d));
+}
+
+static inline SSE_TARGET csv_masks_t scan_sse42(const char* p) {
+    csv_masks_t m = {0U, 0U, 0U, 0U};
+    __m128i v;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < CSV_WINDOW; i += 16U) {
+        v = _mm_loadu_si128((const __m128i*)(const void*)(p + i));
+        m.delim |= sse_eq_mask(v, ',') << i;
+        m.newline |= sse_eq_mask(v, '\n') << i;
+        m.minus |= sse_eq_mask(v, '-') << i;
+        m.digit |= sse_digit_mask(v) << i;
+    }
+    m.delim |= m.newline;
+    return m;
+}
+
+static inline AVX_TARGET uint64_t avx_eq_mask(__m256i v, char c) {
+    return (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+
+static inline AVX_TARGET csv_masks_t scan_avx2(const char* p) {
+    csv_masks_t m = {0U, 0U, 0U, 0U};
+    __m256i v;
+    __m256i d;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < CSV_WINDOW; i += 32U) {
+        v = _mm256_loadu_si256((const __m256i*)(const void*)(p + i));
+        d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        m.delim |= avx_eq_mask(v, ',') << i;
+        m.newline |= avx_eq_mask(v, '\n') << i;
+        m.minus |= avx_eq_mask(v, '-') << i;
+        m.digit |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d)) << i;
+    }
+    m.delim |= m.newline;
+    return m;
+}
+
+/* Same fields as parse_fields_scalar(), but field boundaries come from the
+ * delimiter mask alone: each field's end is the lowest remaining bit, so
+ * fields do not wait on the parse of the one before. A line of up to
+ * CSV_WINDOW bytes needs one scan; a field that reaches past the window
+ * rescans from its start, and near `end` the scalar loop finishes the
+ * line. Inlined into each ISA entry point so the scans compile for it. */
+static inline __attribute__((always_inline))
+const char* parse_line_vector(const scenario_schema_t* schema, const char* line,
+                              const char* end, scenario_row_t* row, bool wide) {
+    const char* window = line;
+    csv_masks_t m = {0U, 0U, 0U, 0U};
+    uint32_t values[SCENARIO_NUM_SLOTS] = {0U};
+    uint32_t field_idx = 0U;
+    uint32_t start = 0U;
+    uint32_t stop = 0U;
+    uint32_t off = 0U;
+    uint32_t run = 0U;
+    uint32_t negative = 0U;
+    uint32_t value = 0U;
+    uint64_t delims = 0U;
+    uint8_t slot = 0U;
+    
+    row->voice_cmd[0] = '\0';
+    row->sampled = (uint32_t)SCENARIO_SAMPLED_ALL;
+    while (field_idx < schema->field_count) {
+        if (delims == 0U) {
+            window += start;
+            start = 0U;
+            if ((size_t)(end - window) >= SCENARIO_CSV_LOOKAHEAD) {
+                m = wide ? scan_avx2(window) : scan_sse42(window);
+                delims = m.delim;
+            }
+            if (delims == 0U) {
+                return finish_line(parse_fields_scalar(schema, field_idx, window, values, row),
+                                   values, row);
+            }
+        }
+        
+        slot = schema->slot[field_idx];
+        field_idx++;
+        stop = (uint32_t)__builtin_ctzll(delims);
+        delims &= delims - 1U;
+        
+        if (slot == SCENARIO_SLOT_VOICE) {
+            if (schema->voice_last) {
+                /* Takes the rest of the line, commas included. */
+                return finish_line(copy_voice(window + start, row, true), values, row);
+            }
+            (void)copy_voice(window + start, row, false);
+        } else if (slot == SCENARIO_SLOT_SKIP) {
+            /* Unused column: its end is already known from the mask. */
+        } else {
+            row->sampled &= ~((((uint32_t)(m.delim >> start) & 1U) |
+                               (uint32_t)(window[start] == '\r')) << slot);
+            negative = (uint32_t)(m.minus >> start) & 1U;
+            off = start + negative;
+            run = (uint32_t)__builtin_ctzll(~(m.digit >> off));
+            if (run <= CSV_MAX_DIGITS) {
+                value = sse_digits_to_u32(window + off, run);
+                values[slot] = (negative != 0U) ? (0U - value) : value;
+            } else {
+                (void)parse_field(window + start, &values[slot]);
+            }
+        }
+        
+        if (((m.newline >> stop) & 1U) != 0U) {
+            mark_missing_fields(schema, field_idx, row);
+            return finish_line(window + stop, values, row);
+        }
+        start = stop + 1U;
+    }
+    
+    return finish_line(window + start, values, row);
+}
+
+static SSE_TARGET const char* parse_line_sse42(const scenario_schema_t* schema,
+                                               const char* line, const char* end,
+                                               scenario_row_t* row) {
+    return parse_line_vector(schema, line, end, row, false);
+}
+
+static AVX_TARGET const char* parse_line_avx2(const scenario_schema_t* schema,
+                                              const char* line, const char* end,
+                                              scenario_row_t* row) {
+    return parse_line_vector(schema, line, end, row, true);
+}
+
+#endif /* SCENARIO_HAVE_X86 */
+
+const char* scenario_parse_csv_line(const scenario_schema_t* schema, const char* line,
+                                    const char* end, scenario_row_t* row) {
+    const char* next = NULL;
+    
+    switch (scenario_get_isa()) {
+#if SCENARIO_HAVE_X86
+        case SCENARIO_ISA_AVX2:
+            next = parse_line_avx2(schema, line, end, row);
+            break;
+        case SCENARIO_ISA_SSE42:
+            next = parse_line_sse42(schema, line, end, row);
+            break;
+#endif
+        default:
+            (void)end;
+            next = parse_line_scalar(schema, line, row);
+            break;
+    }
+    
+    return next;
+}
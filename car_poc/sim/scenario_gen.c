@@ -0,0 +1,228 @@
+#include "scenario_gen.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_CLEAR_MM        (4000U)
+#define GEN_OBSTACLE_MIN_MM (250U)
+#define GEN_CABIN_DRIFT_MS  (10000U)
+#define GEN_HUMID_MIN       (30)
+#define GEN_HUMID_MAX       (80)
+#define GEN_AMBIENT_SWING   (50)
+#define GEN_NUM_SIGNS       (5U)
+#define GEN_NUM_VOICE       (6U)
+
+/* Event kinds, mixed into the per-event hash so each feature draws its own
+ * numbers. */
+#define GEN_KIND_RAIN     (1U)
+#define GEN_KIND_GAP      (2U)
+#define GEN_KIND_SIGN     (3U)
+#define GEN_KIND_VOICE    (4U)
+
+static const uint16_t sign_limits[GEN_NUM_SIGNS] = {30U, 50U, 80U, 100U, 120U};
+
+static const char* const voice_lines[GEN_NUM_VOICE] = {
+    "hey car set temp 21",
+    "hey car open sunroof",
+    "hey car close sunroof",
+    "hey car turn on radio",
+    "hey car navigate home",
+    "hey car sing a song"
+};
+
+#define SCENARIO_GEN_PARAM_DEFAULT(name, value) params->name = (value);
+
+void scenario_gen_defaults(scenario_gen_params_t* params) {
+    SCENARIO_GEN_PARAMS(SCENARIO_GEN_PARAM_DEFAULT)
+}
+
+#define SCENARIO_GEN_PARAM_MATCH(name, value) \
+    if ((len == (sizeof(#name) - 1U)) && (memcmp(key, #name, len) == 0)) { \
+        params->name = number; \
+        return true; \
+    }
+
+static bool set_param(scenario_gen_params_t* params, const char* key, size_t len,
+                      int32_t number) {
+    SCENARIO_GEN_PARAMS(SCENARIO_GEN_PARAM_MATCH)
+    
+    return false;
+}
+
+static bool is_separator(char c) {
+    return (c == ',') || (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+bool scenario_gen_parse(scenario_gen_params_t* params, const char* description) {
+    const char* p = description;
+    const char* key = NULL;
+    char* value_end = NULL;
+    long number = 0;
+    size_t len = 0U;
+    
+    scenario_gen_defaults(params);
+    if (description == NULL) {
+        return false;
+    }
+    
+    while (*p != '\0') {
+        while (is_separator(*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        
+        key = p;
+        while ((*p != '=') && (*p != '\0') && !is_separator(*p)) {
+            p++;
+        }
+        if (*p != '=') {
+            return false;
+        }
+        len = (size_t)(p - key);
+        p++;
+        
+        errno = 0;
+        number = strtol(p, &value_end, 10);
+        if ((value_end == p) || (errno != 0) || (number > INT32_MAX) || (number < INT32_MIN) ||
+            ((*value_end != '\0') && !is_separator(*value_end))) {
+            return false;
+        }
+        if (!set_param(params, key, len, (int32_t)number)) {
+            return false;
+        }
+        p = value_end;
+    }
+    
+    return (params->step_ms > 0);
+}
+
+void scenario_gen_start(scenario_gen_t* gen, const scenario_gen_params_t* params) {
+    memset(gen, 0, sizeof(scenario_gen_t));
+    gen->params = *params;
+    gen->noise = (uint32_t)params->seed;
+    gen->distance_mm = GEN_CLEAR_MM;
+    gen->cabin_x10 = params->cabin_start_x10;
+    gen->ambient_x10 = params->ambient_x10;
+    gen->humid_pct = (GEN_HUMID_MIN + GEN_HUMID_MAX) / 2;
+}
+
+/* Per-event numbers come from a hash of (seed, kind, event index), so an
+ * event looks the same whatever the other features drew before it. */
+static uint32_t event_hash(uint32_t seed, uint32_t kind, uint64_t index) {
+    uint32_t h = seed ^ (kind * 0x9E3779B9U) ^ ((uint32_t)index * 0x85EBCA6BU) ^
+                 (uint32_t)(index >> 32);
+    
+    h ^= h >> 16;
+    h *= 0x7FEB352DU;
+    h ^= h >> 15;
+    h *= 0x846CA68BU;
+    h ^= h >> 16;
+    return h;
+}
+
+/* True on the first row at or after each multiple of `period`. */
+static bool event_due(uint64_t t, uint64_t step, int32_t period) {
+    return (period > 0) && (t >= (uint64_t)period) && ((t % (uint64_t)period) < step);
+}
+
+/* 0 at the start of each period, 1 << 16 halfway, back to 0 at the end. */
+static uint32_t triangle_q16(uint64_t t, int32_t period) {
+    uint64_t phase = 0U;
+    uint64_t half = 0U;
+    
+    if (period < 2) {
+        return 0U;
+    }
+    
+    half = (uint64_t)period / 2U;
+    phase = t % (uint64_t)period;
+    if (phase >= half) {
+        phase = (uint64_t)period - phase;
+    }
+    return (uint32_t)((phase << 16) / half);
+}
+
+static int32_t clamp_i32(int32_t value, int32_t lo, int32_t hi) {
+    return (value < lo) ? lo : ((value > hi) ? hi : value);
+}
+
+/* Speed ramps up and down between the limits; rain rises and falls once a
+ * period towards a peak drawn per period; an obstacle appears every so
+ * often and closes in at the current speed until it is passed. */
+bool scenario_gen_next(scenario_gen_t* gen, scenario_row_t* row) {
+    const scenario_gen_params_t* prm = &gen->params;
+    uint64_t step = (uint64_t)prm->step_ms;
+    uint64_t t = gen->row_index * step;
+    uint32_t seed = (uint32_t)prm->seed;
+    uint32_t closing = 0U;
+    uint32_t h = 0U;
+    int32_t speed = 0;
+    int32_t rain = 0;
+    
+    if ((prm->rows > 0) && (gen->row_index >= (uint64_t)prm->rows)) {
+        return false;
+    }
+    
+    gen->noise = (gen->noise * 1103515245U) + 12345U;
+    memset(row, 0, sizeof(scenario_row_t));
+    row->ms = (uint32_t)t;
+    row->sampled = (uint32_t)SCENARIO_SAMPLED_ALL;
+    
+    speed = prm->speed_min_kph +
+            (int32_t)(((int64_t)(prm->speed_max_kph - prm->speed_min_kph) *
+                       (int64_t)triangle_q16(t, prm->speed_ramp_ms)) >> 16);
+    speed += (int32_t)((gen->noise >> 16) % 5U) - 2;
+    row->speed_kph = (uint16_t)clamp_i32(speed, 0, 400);
+    
+    if (prm->rain_period_ms > 0) {
+        h = event_hash(seed, GEN_KIND_RAIN, t / (uint64_t)prm->rain_period_ms);
+        rain = (int32_t)(h % ((uint32_t)clamp_i32(prm->rain_max_pct, 0, 100) + 1U));
+        rain = (int32_t)(((int64_t)rain * (int64_t)triangle_q16(t, prm->rain_period_ms)) >> 16);
+    }
+    row->rain_pct = (uint8_t)rain;
+    
+    if (event_due(t, step, prm->obstacle_every_ms)) {
+        gen->distance_mm = (uint32_t)clamp_i32(prm->obstacle_start_mm, 0, UINT16_MAX);
+    } else if (gen->distance_mm < GEN_CLEAR_MM) {
+        closing = ((uint32_t)row->speed_kph * (uint32_t)step * 10U) / 36U;
+        gen->distance_mm = (gen->distance_mm > (GEN_OBSTACLE_MIN_MM + closing)) ?
+                           (gen->distance_mm - closing) : GEN_CLEAR_MM;
+    } else {
+    }
+    row->distance_mm = (uint16_t)gen->distance_mm;
+    
+    if (event_due(t, step, prm->gap_every_ms)) {
+        h = event_hash(seed, GEN_KIND_GAP, t / (uint64_t)prm->gap_every_ms);
+        row->gap_found = true;
+        row->gap_width_mm = (uint16_t)(4000U + (h % 3000U));
+    }
+    
+    if (event_due(t, step, prm->sign_every_ms)) {
+        h = event_hash(seed, GEN_KIND_SIGN, t / (uint64_t)prm->sign_every_ms);
+        row->sign_event = sign_limits[h % GEN_NUM_SIGNS];
+    }
+    
+    gen->ambient_x10 = clamp_i32(gen->ambient_x10 + (int32_t)((gen->noise >> 20) % 3U) - 1,
+                                 prm->ambient_x10 - GEN_AMBIENT_SWING,
+                                 prm->ambient_x10 + GEN_AMBIENT_SWING);
+    gen->humid_pct = clamp_i32(gen->humid_pct + (int32_t)((gen->noise >> 24) % 3U) - 1,
+                               GEN_HUMID_MIN, GEN_HUMID_MAX);
+    if (event_due(t, step, (int32_t)GEN_CABIN_DRIFT_MS)) {
+        gen->cabin_x10 += (gen->cabin_x10 < prm->setpoint_x10) ? 1 :
+                          ((gen->cabin_x10 > prm->setpoint_x10) ? -1 : 0);
+    }
+    row->cabin_tc_x10 = (int16_t)clamp_i32(gen->cabin_x10, INT16_MIN, INT16_MAX);
+    row->ambient_tc_x10 = (int16_t)clamp_i32(gen->ambient_x10, INT16_MIN, INT16_MAX);
+    row->humid_pct = (uint8_t)gen->humid_pct;
+    row->setpoint_x10 = (int16_t)clamp_i32(prm->setpoint_x10, INT16_MIN, INT16_MAX);
+    
+    if (event_due(t, step, prm->voice_every_ms)) {
+        h = event_hash(seed, GEN_KIND_VOICE, t / (uint64_t)prm->voice_every_ms);
+        (void)strncpy(row->voice_cmd, voice_lines[h % GEN_NUM_VOICE], MAX_VOICE_CMD_LEN - 1U);
+    }
+    
+    gen->row_index++;
+    return true;
+}
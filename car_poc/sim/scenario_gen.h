@@ -0,0 +1,57 @@
+#ifndef SCENARIO_GEN_H
+#define SCENARIO_GEN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scenario.h"
+
+/* Generator description: name, default. A description string sets any of
+ * them as comma-separated name=value pairs, e.g.
+ * "seed=7,rows=100000000,speed_max_kph=90". Periods are in milliseconds of
+ * scenario time; a period of 0 switches that feature off. */
+#define SCENARIO_GEN_PARAMS(X) \
+    X(seed,              1)      \
+    X(rows,              0)      \
+    X(step_ms,           100)    \
+    X(speed_min_kph,     30)     \
+    X(speed_max_kph,     120)    \
+    X(speed_ramp_ms,     120000) \
+    X(rain_period_ms,    300000) \
+    X(rain_max_pct,      90)     \
+    X(obstacle_every_ms, 45000)  \
+    X(obstacle_start_mm, 3000)   \
+    X(gap_every_ms,      60000)  \
+    X(sign_every_ms,     30000)  \
+    X(ambient_x10,       150)    \
+    X(cabin_start_x10,   300)    \
+    X(setpoint_x10,      220)    \
+    X(voice_every_ms,    90000)
+
+#define SCENARIO_GEN_PARAM_MEMBER(name, value) int32_t name;
+
+typedef struct {
+    SCENARIO_GEN_PARAMS(SCENARIO_GEN_PARAM_MEMBER)
+} scenario_gen_params_t;
+
+/* Generator state: the next row is computed from the previous one, so
+ * memory use does not depend on the row count. rows == 0 never ends. Row
+ * times are uint32_t milliseconds like every scenario, so a replay through
+ * the HAL mock is limited to 2^32 ms of scenario time. */
+typedef struct scenario_gen {
+    scenario_gen_params_t params;
+    uint64_t row_index;
+    uint32_t noise;
+    uint32_t distance_mm;
+    int32_t cabin_x10;
+    int32_t ambient_x10;
+    int32_t humid_pct;
+} scenario_gen_t;
+
+void scenario_gen_defaults(scenario_gen_params_t* params);
+/* Applies `description` on top of the defaults. Fails on an unknown name,
+ * a value that is not an integer or a step_ms of zero. */
+bool scenario_gen_parse(scenario_gen_params_t* params, const char* description);
+void scenario_gen_start(scenario_gen_t* gen, const scenario_gen_params_t* params);
+bool scenario_gen_next(scenario_gen_t* gen, scenario_row_t* row);
+
+#endif /* SCENARIO_GEN_H */
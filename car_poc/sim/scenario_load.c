@@ -0,0 +1,307 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "scenario_load.h"
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENARIO_LOAD_HAVE_MMAP 1
+#else
+#define SCENARIO_LOAD_HAVE_MMAP 0
+#endif
+
+#define SCENARIO_LOAD_LINE_MAX (2048U)
+
+const char* scenario_load_status_name(scenario_load_status_e status) {
+    const char* name = "unknown";
+    
+    switch (status) {
+        case SCENARIO_LOAD_OK:
+            name = "ok";
+            break;
+        case SCENARIO_LOAD_OPEN_FAILED:
+            name = "cannot open or map file";
+            break;
+        case SCENARIO_LOAD_BAD_HEADER:
+            name = "header has no ms column";
+            break;
+        case SCENARIO_LOAD_TOO_SMALL:
+            name = "row array too small";
+            break;
+        case SCENARIO_LOAD_BAD_ROW:
+            name = "malformed row";
+            break;
+        default:
+            break;
+    }
+    
+    return name;
+}
+
+#if SCENARIO_LOAD_HAVE_MMAP
+
+/* One thread's share of the file: whole lines in [begin, end), parsed into
+ * rows[first_row] onwards. */
+typedef struct {
+    pthread_t thread;
+    const scenario_schema_t* schema;
+    const char* begin;
+    const char* end;
+    const char* map_end;
+    scenario_row_t* rows;
+    uint64_t first_row;
+    uint64_t row_count;
+    bool failed;
+    uint64_t error_row;
+    const char* error_line;
+} load_chunk_t;
+
+typedef void* (*chunk_fn)(void* arg);
+
+static void* count_chunk(void* arg) {
+    load_chunk_t* chunk = (load_chunk_t*)arg;
+    const char* p = chunk->begin;
+    const char* nl = NULL;
+    
+    chunk->row_count = 0U;
+    while (p < chunk->end) {
+        nl = (const char*)memchr(p, '\n', (size_t)(chunk->end - p));
+        if (nl == NULL) {
+            break;
+        }
+        chunk->row_count++;
+        p = nl + 1;
+    }
+    
+    return NULL;
+}
+
+/* Stops at the chunk's first malformed line; later chunks cannot hold an
+ * earlier one, so the caller only needs the first failed chunk. */
+static void* parse_chunk(void* arg) {
+    load_chunk_t* chunk = (load_chunk_t*)arg;
+    const char* p = chunk->begin;
+    uint64_t i = 0U;
+    
+    for (i = 0U; (i < chunk->row_count) && (p < chunk->end); i++) {
+        if (!scenario_csv_line_valid(chunk->schema, p)) {
+            chunk->failed = true;
+            chunk->error_row = i;
+            chunk->error_line = p;
+            break;
+        }
+        p = scenario_parse_csv_line(chunk->schema, p, chunk->map_end, &chunk->rows[i]);
+    }
+    
+    return NULL;
+}
+
+/* Runs fn over every chunk on its own thread; a chunk whose thread cannot
+ * be started runs on the caller instead. */
+static void run_chunks(load_chunk_t* chunks, uint32_t count, chunk_fn fn) {
+    bool started[SCENARIO_LOAD_MAX_THREADS] = {false};
+    uint32_t i = 0U;
+    
+    for (i = 1U; i < count; i++) {
+        started[i] = (pthread_create(&chunks[i].thread, NULL, fn, &chunks[i]) == 0);
+    }
+    (void)fn(&chunks[0]);
+    for (i = 1U; i < count; i++) {
+        if (started[i]) {
+            (void)pthread_join(chunks[i].thread, NULL);
+        } else {
+            (void)fn(&chunks[i]);
+        }
+    }
+}
+
+static uint32_t pick_threads(uint32_t threads, size_t bytes) {
+    long online_cpus = 0;
+    size_t by_size = 0U;
+    
+    if (threads == 0U) {
+        online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online_cpus > 0) ? (uint32_t)online_cpus : 1U;
+        by_size = (bytes / SCENARIO_LOAD_MIN_CHUNK) + 1U;
+        if (by_size < (size_t)threads) {
+            threads = (uint32_t)by_size;
+        }
+    }
+    
+    return (threads > SCENARIO_LOAD_MAX_THREADS) ? SCENARIO_LOAD_MAX_THREADS : threads;
+}
+
+/* Cuts [begin, end) into `count` pieces of about equal size, each moved
+ * forward to just after a '\n'. Pieces may be empty. */
+static void split_chunks(load_chunk_t* chunks, uint32_t count, const char* begin,
+                         const char* end) {
+    size_t size = (size_t)(end - begin);
+    const char* cut = begin;
+    const char* nl = NULL;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < count; i++) {
+        chunks[i].begin = cut;
+        if ((i + 1U) == count) {
+            cut = end;
+        } else {
+            cut = begin + ((size / count) * (i + 1U));
+            if (cut < chunks[i].begin) {
+                cut = chunks[i].begin;
+            } else if (cut > begin) {
+                nl = (const char*)memchr(cut - 1, '\n', (size_t)(end - (cut - 1)));
+                cut = (nl != NULL) ? (nl + 1) : end;
+            } else {
+            }
+        }
+        chunks[i].end = cut;
+    }
+}
+
+/* A last line without '\n' is parsed from a terminated copy, as the
+ * buffered reader does. Over-long ones are reported as malformed. */
+static bool parse_tail(const scenario_schema_t* schema, const char* tail, size_t len,
+                       scenario_row_t* row) {
+    char line[SCENARIO_LOAD_LINE_MAX + 1U + SCENARIO_CSV_LOOKAHEAD];
+    
+    if (len >= SCENARIO_LOAD_LINE_MAX) {
+        return false;
+    }
+    
+    memcpy(line, tail, len);
+    line[len] = '\n';
+    if (!scenario_csv_line_valid(schema, line)) {
+        return false;
+    }
+    (void)scenario_parse_csv_line(schema, line, line + sizeof(line), row);
+    return true;
+}
+
+static bool load_mapped(const char* map, size_t map_len, uint32_t threads,
+                        scenario_row_t* rows, uint64_t capacity,
+                        scenario_load_result_t* result) {
+    load_chunk_t chunks[SCENARIO_LOAD_MAX_THREADS];
+    scenario_schema_t schema;
+    const char* map_end = map + map_len;
+    const char* header_end = (const char*)memchr(map, '\n', map_len);
+    const char* body = (header_end != NULL) ? (header_end + 1) : map_end;
+    const char* body_end = map_end;
+    uint64_t row = 0U;
+    uint32_t count = 0U;
+    uint32_t i = 0U;
+    
+    if (!scenario_schema_resolve(&schema, map, (size_t)(body - map))) {
+        result->status = SCENARIO_LOAD_BAD_HEADER;
+        return false;
+    }
+    
+    while ((body_end > body) && (body_end[-1] != '\n')) {
+        body_end--;
+    }
+    
+    count = pick_threads(threads, (size_t)(body_end - body));
+    result->threads = count;
+    memset(chunks, 0, sizeof(chunks));
+    split_chunks(chunks, count, body, body_end);
+    run_chunks(chunks, count, count_chunk);
+    
+    for (i = 0U; i < count; i++) {
+        chunks[i].first_row = row;
+        row += chunks[i].row_count;
+    }
+    result->row_count = row + ((body_end < map_end) ? 1U : 0U);
+    if ((result->row_count > 0U) && ((rows == NULL) || (capacity < result->row_count))) {
+        result->status = SCENARIO_LOAD_TOO_SMALL;
+        return false;
+    }
+    if (result->row_count == 0U) {
+        return true;
+    }
+    
+    for (i = 0U; i < count; i++) {
+        chunks[i].schema = &schema;
+        chunks[i].map_end = map_end;
+        chunks[i].rows = &rows[chunks[i].first_row];
+    }
+    run_chunks(chunks, count, parse_chunk);
+    
+    for (i = 0U; i < count; i++) {
+        if (chunks[i].failed) {
+            result->status = SCENARIO_LOAD_BAD_ROW;
+            result->error_row = chunks[i].first_row + chunks[i].error_row;
+            result->error_offset = (uint64_t)(chunks[i].error_line - map);
+            return false;
+        }
+    }
+    
+    if ((body_end < map_end) &&
+        !parse_tail(&schema, body_end, (size_t)(map_end - body_end), &rows[row])) {
+        result->status = SCENARIO_LOAD_BAD_ROW;
+        result->error_row = row;
+        result->error_offset = (uint64_t)(body_end - map);
+        return false;
+    }
+    
+    return true;
+}
+
+bool scenario_load(const char* filename, uint32_t threads, scenario_row_t* rows,
+                   uint64_t capacity, scenario_load_result_t* result) {
+    struct stat st;
+    void* map = NULL;
+    bool ok = false;
+    int fd = -1;
+    
+    if ((filename == NULL) || (result == NULL)) {
+        return false;
+    }
+    
+    memset(result, 0, sizeof(scenario_load_result_t));
+    result->status = SCENARIO_LOAD_OPEN_FAILED;
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+        (void)close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        (void)close(fd);
+        result->status = SCENARIO_LOAD_OK;
+        return true;
+    }
+    
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    
+    result->status = SCENARIO_LOAD_OK;
+    ok = load_mapped((const char*)map, (size_t)st.st_size, threads, rows, capacity, result);
+    (void)munmap(map, (size_t)st.st_size);
+    return ok;
+}
+
+#else
+
+bool scenario_load(const char* filename, uint32_t threads, scenario_row_t* rows,
+                   uint64_t capacity, scenario_load_result_t* result) {
+    (void)filename;
+    (void)threads;
+    (void)rows;
+    (void)capacity;
+    if (result != NULL) {
+        memset(result, 0, sizeof(scenario_load_result_t));
+        result->status = SCENARIO_LOAD_OPEN_FAILED;
+    }
+    return false;
+}
+
+#endif /* SCENARIO_LOAD_HAVE_MMAP */
@@ -0,0 +1,43 @@
+#ifndef SCENARIO_LOAD_H
+#define SCENARIO_LOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scenario.h"
+
+#define SCENARIO_LOAD_MAX_THREADS (64U)
+/* With threads == 0 the loader uses every online CPU, but gives each at
+ * least this many bytes so small files are not split pointlessly. */
+#define SCENARIO_LOAD_MIN_CHUNK   (1048576U)
+
+typedef enum {
+    SCENARIO_LOAD_OK = 0U,
+    SCENARIO_LOAD_OPEN_FAILED,
+    SCENARIO_LOAD_BAD_HEADER,
+    SCENARIO_LOAD_TOO_SMALL,
+    SCENARIO_LOAD_BAD_ROW
+} scenario_load_status_e;
+
+/* row_count is the number of data rows in the file, also when the array
+ * was too small. For SCENARIO_LOAD_BAD_ROW, error_row is the index the
+ * first malformed row would have had in the array and error_offset the
+ * file offset of its first byte; rows before it are loaded. */
+typedef struct {
+    scenario_load_status_e status;
+    uint64_t row_count;
+    uint64_t error_row;
+    uint64_t error_offset;
+    uint32_t threads;
+} scenario_load_result_t;
+
+/* Loads a whole CSV scenario into `rows` in file order. The file is mapped,
+ * cut into per-thread chunks at line boundaries, and the chunks are parsed
+ * at the same time, each straight into its slice of the array. Call with
+ * rows == NULL to learn the row count. Rows are checked strictly with
+ * scenario_csv_line_valid(). Needs an mmap-capable host. */
+bool scenario_load(const char* filename, uint32_t threads, scenario_row_t* rows,
+                   uint64_t capacity, scenario_load_result_t* result);
+
+const char* scenario_load_status_name(scenario_load_status_e status);
+
+#endif /* SCENARIO_LOAD_H */
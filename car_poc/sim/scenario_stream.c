@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+
+#include "scenario_stream.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STREAM_WAIT_NS (50000L)
+
+static void wait_briefly(void) {
+    struct timespec ts = {0, STREAM_WAIT_NS};
+    
+    (void)nanosleep(&ts, NULL);
+}
+
+static char* aligned_area(scenario_stream_t* stream) {
+    uintptr_t base = (uintptr_t)&stream->raw[SCENARIO_STREAM_MAX_LINE];
+    
+    base = (base + (SCENARIO_STREAM_ALIGN - 1U)) & ~(uintptr_t)(SCENARIO_STREAM_ALIGN - 1U);
+    return (char*)base;
+}
+
+/* Blocks until the producer may write the next ring slot, or returns NULL
+ * when the stream is being closed. */
+static scenario_stream_block_t* acquire_block(scenario_stream_t* stream) {
+    uint32_t slot = 0U;
+    
+    while (!spsc_ring_acquire(&stream->ring, &slot)) {
+        if (__atomic_load_n(&stream->stop, __ATOMIC_RELAXED)) {
+            return NULL;
+        }
+        wait_briefly();
+    }
+    
+    stream->blocks[slot].count = 0U;
+    return &stream->blocks[slot];
+}
+
+/* Parses every complete line in [begin, end) into the ring and returns the
+ * start of the trailing partial line. */
+static const char* parse_lines(scenario_stream_t* stream, scenario_stream_block_t** block,
+                               const char* begin, const char* end) {
+    const char* stream_end = &stream->raw[sizeof(stream->raw)];
+    const char* p = begin;
+    const char* nl = NULL;
+    
+    while ((*block != NULL) && (p < end)) {
+        nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (nl == NULL) {
+            break;
+        }
+        
+        (void)scenario_parse_csv_line(&stream->schema, p, stream_end,
+                                      &(*block)->rows[(*block)->count]);
+        (*block)->count++;
+        p = nl + 1;
+        
+        if ((*block)->count == SCENARIO_STREAM_BLOCK_ROWS) {
+            spsc_ring_publish(&stream->ring);
+            *block = acquire_block(stream);
+        }
+    }
+    
+    return p;
+}
+
+static void* producer_main(void* arg) {
+    scenario_stream_t* stream = (scenario_stream_t*)arg;
+    char* area = aligned_area(stream);
+    const char* start = area;
+    const char* rest = NULL;
+    const char* nl = NULL;
+    scenario_stream_block_t* block = acquire_block(stream);
+    size_t carry = 0U;
+    ssize_t got = 0;
+    bool header_skipped = false;
+    bool truncated = false;
+    
+    while (block != NULL) {
+        got = read(stream->fd, area, SCENARIO_STREAM_CHUNK);
+        if ((got < 0) && (errno == EINTR)) {
+            continue;
+        }
+#ifdef O_DIRECT
+        if ((got < 0) && (errno == EINVAL) &&
+            ((fcntl(stream->fd, F_GETFL) & O_DIRECT) != 0)) {
+            /* The filesystem accepted O_DIRECT at open() but not on read(). */
+            (void)fcntl(stream->fd, F_SETFL, fcntl(stream->fd, F_GETFL) & ~O_DIRECT);
+            continue;
+        }
+#endif
+        if (got <= 0) {
+            break;
+        }
+        
+        start = area - carry;
+        if (truncated) {
+            /* Drop the rest of an over-long line and end its head with the
+             * '\n' that ends the line. */
+            nl = (const char*)memchr(area, '\n', (size_t)got);
+            if (nl == NULL) {
+                continue;
+            }
+            memmove((char*)nl - carry, area - carry, carry);
+            start = nl - carry;
+            truncated = false;
+        }
+        if (!header_skipped) {
+            rest = (const char*)memchr(start, '\n', carry + (size_t)got);
+            if (rest == NULL) {
+                carry = 0U;
+                continue;
+            }
+            start = rest + 1;
+            header_skipped = true;
+        }
+        
+        rest = parse_lines(stream, &block, start, area + got);
+        carry = (size_t)((area + got) - rest);
+        if (carry > SCENARIO_STREAM_MAX_LINE) {
+            /* Over-long line: keep its head, as the stdio reader does. */
+            carry = SCENARIO_STREAM_MAX_LINE;
+            truncated = true;
+        }
+        memmove(area - carry, rest, carry);
+    }
+    
+    /* A last line without '\n' still counts as a row. */
+    if ((block != NULL) && header_skipped && (carry > 0U)) {
+        area[0] = '\n';
+        (void)parse_lines(stream, &block, area - carry, area + 1);
+    }
+    
+    if ((block != NULL) && (block->count > 0U)) {
+        spsc_ring_publish(&stream->ring);
+    }
+    __atomic_store_n(&stream->finished, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+bool scenario_stream_open(scenario_stream_t* stream, const char* filename, bool direct_io,
+                          const scenario_schema_t* schema) {
+    int flags = O_RDONLY;
+    
+    if ((stream == NULL) || (filename == NULL) || (schema == NULL)) {
+        return false;
+    }
+    
+    memset(stream, 0, sizeof(scenario_stream_t));
+    stream->schema = *schema;
+    stream->fd = -1;
+    spsc_ring_init(&stream->ring, SCENARIO_STREAM_BLOCKS);
+#ifdef O_DIRECT
+    if (direct_io) {
+        flags |= O_DIRECT;
+    }
+#else
+    (void)direct_io;
+#endif
+    
+    stream->fd = open(filename, flags);
+    if ((stream->fd < 0) && (flags != O_RDONLY)) {
+        /* Not every filesystem supports O_DIRECT (tmpfs, some overlays). */
+        stream->fd = open(filename, O_RDONLY);
+    }
+    if (stream->fd < 0) {
+        return false;
+    }
+    
+    (void)posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    if (pthread_create(&stream->thread, NULL, producer_main, stream) != 0) {
+        (void)close(stream->fd);
+        stream->fd = -1;
+        return false;
+    }
+    stream->thread_started = true;
+    return true;
+}
+
+/* Only waits when the producer has fallen a full ring behind; each such
+ * wait is counted in `stalls`. */
+bool scenario_stream_next(scenario_stream_t* stream, scenario_row_t* row) {
+    scenario_stream_block_t* block = NULL;
+    uint32_t slot = 0U;
+    bool stalled = false;
+    
+    while (!spsc_ring_peek(&stream->ring, &slot)) {
+        if (__atomic_load_n(&stream->finished, __ATOMIC_ACQUIRE) &&
+            !spsc_ring_peek(&stream->ring, &slot)) {
+            return false;
+        }
+        stalled = true;
+        wait_briefly();
+    }
+    if (stalled) {
+        stream->stalls++;
+    }
+    
+    block = &stream->blocks[slot];
+    *row = block->rows[stream->read_pos];
+    stream->read_pos++;
+    
+    if (stream->read_pos >= block->count) {
+        stream->read_pos = 0U;
+        spsc_ring_release(&stream->ring);
+    }
+    
+    return true;
+}
+
+void scenario_stream_close(scenario_stream_t* stream) {
+    if (stream == NULL) {
+        return;
+    }
+    
+    if (stream->thread_started) {
+        __atomic_store_n(&stream->stop, true, __ATOMIC_RELAXED);
+        (void)pthread_join(stream->thread, NULL);
+        stream->thread_started = false;
+    }
+    if (stream->fd >= 0) {
+        (void)close(stream->fd);
+        stream->fd = -1;
+    }
+}
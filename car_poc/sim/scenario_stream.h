@@ -0,0 +1,51 @@
+#ifndef SCENARIO_STREAM_H
+#define SCENARIO_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "scenario.h"
+#include "spsc_ring.h"
+
+#define SCENARIO_STREAM_CHUNK       (1048576U)
+#define SCENARIO_STREAM_ALIGN       (4096U)
+#define SCENARIO_STREAM_MAX_LINE    (SCENARIO_STREAM_ALIGN)
+#define SCENARIO_STREAM_BLOCK_ROWS  (1024U)
+#define SCENARIO_STREAM_BLOCKS      (3U)
+
+typedef struct {
+    uint32_t count;
+    scenario_row_t rows[SCENARIO_STREAM_BLOCK_ROWS];
+} scenario_stream_block_t;
+
+/* Background CSV reader: an I/O thread reads large chunks, parses them and
+ * hands full row blocks to the consumer through a three-slot spsc_ring_t.
+ * Memory use is fixed by the constants above. */
+typedef struct scenario_stream {
+    int fd;
+    pthread_t thread;
+    bool thread_started;
+    scenario_schema_t schema;
+    
+    spsc_ring_t ring;
+    bool finished;
+    bool stop;
+    scenario_stream_block_t blocks[SCENARIO_STREAM_BLOCKS];
+    
+    /* Consumer side. */
+    uint32_t read_pos;
+    uint32_t stalls;
+    
+    /* Producer side: a line carried over from the previous chunk is placed
+     * just in front of the aligned read area. */
+    char raw[SCENARIO_STREAM_MAX_LINE + SCENARIO_STREAM_CHUNK + SCENARIO_STREAM_ALIGN +
+             SCENARIO_CSV_LOOKAHEAD];
+} scenario_stream_t;
+
+/* `schema` is copied; the producer skips the header line it came from. */
+bool scenario_stream_open(scenario_stream_t* stream, const char* filename, bool direct_io,
+                          const scenario_schema_t* schema);
+bool scenario_stream_next(scenario_stream_t* stream, scenario_row_t* row);
+void scenario_stream_close(scenario_stream_t* stream);
+
+#endif /* SCENARIO_STREAM_H */
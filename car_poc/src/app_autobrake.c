@@ -3,68 +3,186 @@
 #include "calib.h"
 #include "platform.h"
 
+#ifndef AUTOBRAKE_SECTORS_SSE2
+#if defined(__SSE2__)
+#define AUTOBRAKE_SECTORS_SSE2 1
+#else
+#define AUTOBRAKE_SECTORS_SSE2 0
+#endif
+#endif
+
+#if AUTOBRAKE_SECTORS_SSE2
+#include <immintrin.h>
+#endif
+
+typedef char autobrake_sector_groups[((HAL_DISTANCE_SECTORS % 8U) == 0U) &&
+                                     (HAL_DISTANCE_SECTORS <= 16U) ? 1 : -1];
+
+/* Result of one pass over the distance array, as sector bit masks. Only
+ * fresh sectors count: valid, in AB_SECTOR_MASK and no older than
+ * SENSOR_STALE_MS. `armed` sectors have hit AB_DEBOUNCE_HITS in a row. The
+ * nearest fresh sector is the lowest-numbered one with the smallest
+ * distance. */
 typedef struct {
-    uint8_t hit_count;
-    bool brake_active;
-} autobrake_state_t;
+    uint32_t fresh;
+    uint32_t armed;
+    uint16_t nearest_mm;
+    uint32_t nearest;
+} sector_scan_t;
+
+static autobrake_state_t state;
+static hal_io_t default_io;
+
+#if AUTOBRAKE_SECTORS_SSE2
+
+/* 8 sectors per iteration in 16-bit lanes, with the compare idioms of the
+ * fleet kernels: a <= b as subs_epu16(a, b) == 0, and unsigned compares on
+ * sign-flipped values. The horizontal minimum runs on flipped values too. */
+/* One bit per 16-bit lane of a compare mask. */
+static uint32_t sector_bits(__m128i mask) {
+    return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(mask, _mm_setzero_si128()));
+}
+
+static void scan_sectors(autobrake_state_t* ctx, const hal_inputs_t* in, sector_scan_t* scan) {
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    const __m128i bias32 = _mm_set1_epi32((int)0x80000000U);
+    const __m128i now = _mm_set1_epi32((int)in->now_ms);
+    const __m128i lim = _mm_xor_si128(_mm_set1_epi32((int)SENSOR_STALE_MS), bias32);
+    const __m128i thr = _mm_set1_epi16((short)AB_THRESHOLD_MM);
+    const __m128i deb = _mm_set1_epi16((short)AB_DEBOUNCE_HITS);
+    const __m128i lane_bit = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+    uint32_t selected = (uint32_t)in->distance_valid & (uint32_t)AB_SECTOR_MASK;
+    uint32_t g = 0U;
+    
+    for (g = 0U; g < HAL_DISTANCE_SECTORS; g += 8U) {
+        __m128i sel = _mm_set1_epi16((short)((selected >> g) & 0xFFU));
+        __m128i d0 = _mm_sub_epi32(now, _mm_loadu_si128((const __m128i*)&in->distance.ts_ms[g]));
+        __m128i d1 = _mm_sub_epi32(now,
+                                   _mm_loadu_si128((const __m128i*)&in->distance.ts_ms[g + 4U]));
+        __m128i stale = _mm_packs_epi32(_mm_cmpgt_epi32(_mm_xor_si128(d0, bias32), lim),
+                                        _mm_cmpgt_epi32(_mm_xor_si128(d1, bias32), lim));
+        __m128i fresh = _mm_andnot_si128(stale, _mm_cmpeq_epi16(_mm_and_si128(sel, lane_bit),
+                                                                lane_bit));
+        __m128i mm = _mm_loadu_si128((const __m128i*)&in->distance.mm[g]);
+        __m128i near = _mm_cmpeq_epi16(_mm_subs_epu16(mm, thr), _mm_setzero_si128());
+        __m128i hit = _mm_loadu_si128((const __m128i*)&ctx->hit_count[g]);
+        __m128i hit_new = _mm_and_si128(_mm_and_si128(fresh, near),
+                                        _mm_min_epi16(_mm_add_epi16(hit, _mm_set1_epi16(1)),
+                                                      deb));
+        __m128i key = _mm_xor_si128(_mm_or_si128(mm, _mm_andnot_si128(fresh,
+                                                                      _mm_set1_epi16(-1))),
+                                    bias16);
+        __m128i low = _mm_min_epi16(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(1, 0, 3, 2)));
+        uint32_t at_min = 0U;
+        uint16_t group_mm = 0U;
+        
+        _mm_storeu_si128((__m128i*)&ctx->hit_count[g], hit_new);
+        scan->armed |= sector_bits(_mm_cmpeq_epi16(hit_new, deb)) << g;
+        
+        low = _mm_min_epi16(low, _mm_shufflelo_epi16(low, _MM_SHUFFLE(1, 0, 3, 2)));
+        low = _mm_min_epi16(low, _mm_shufflelo_epi16(low, _MM_SHUFFLE(2, 3, 0, 1)));
+        low = _mm_shuffle_epi32(_mm_unpacklo_epi16(low, low), 0);
+        at_min = sector_bits(_mm_and_si128(fresh, _mm_cmpeq_epi16(key, low)));
+        group_mm = (uint16_t)((uint32_t)_mm_cvtsi128_si32(_mm_xor_si128(low, bias16)) & 0xFFFFU);
+        
+        if ((at_min != 0U) && ((scan->fresh == 0U) || (group_mm < scan->nearest_mm))) {
+            scan->nearest_mm = group_mm;
+            scan->nearest = g + (uint32_t)__builtin_ctz(at_min);
+        }
+        scan->fresh |= sector_bits(fresh) << g;
+    }
+}
+
+#else
+
+static void scan_sectors(autobrake_state_t* ctx, const hal_inputs_t* in, sector_scan_t* scan) {
+    uint32_t selected = (uint32_t)in->distance_valid & (uint32_t)AB_SECTOR_MASK;
+    uint32_t s = 0U;
+    
+    for (s = 0U; s < HAL_DISTANCE_SECTORS; s++) {
+        uint32_t fresh = ((selected >> s) & 1U) &
+                         (uint32_t)((in->now_ms - in->distance.ts_ms[s]) <= SENSOR_STALE_MS);
+        uint32_t near = (uint32_t)(in->distance.mm[s] <= AB_THRESHOLD_MM);
+        uint32_t hit = ctx->hit_count[s];
+        uint32_t hit_new = (fresh & near) * (hit + (uint32_t)(hit < AB_DEBOUNCE_HITS));
+        uint32_t closer = fresh & ((uint32_t)(scan->fresh == 0U) |
+                                   (uint32_t)(in->distance.mm[s] < scan->nearest_mm));
+        
+        ctx->hit_count[s] = (uint16_t)hit_new;
+        scan->armed |= (uint32_t)(hit_new >= AB_DEBOUNCE_HITS) << s;
+        scan->nearest_mm = (closer != 0U) ? in->distance.mm[s] : scan->nearest_mm;
+        scan->nearest = (closer != 0U) ? s : scan->nearest;
+        scan->fresh |= fresh << s;
+    }
+}
 
-static autobrake_state_t state = {0U, false};
+#endif
+
+static void reset_ctx(autobrake_state_t* ctx) {
+    uint32_t s = 0U;
+    
+    for (s = 0U; s < HAL_DISTANCE_SECTORS; s++) {
+        ctx->hit_count[s] = 0U;
+    }
+    ctx->brake_active = false;
+    autobrake_ttc_reset(&ctx->ttc);
+}
+
+void app_autobrake_init_ctx(autobrake_state_t* ctx) {
+    reset_ctx(ctx);
+}
 
 void app_autobrake_init(void) {
-    state.hit_count = 0U;
-    state.brake_active = false;
+    app_autobrake_init_ctx(&state);
 }
 
-void app_autobrake_step(void) {
-    uint16_t distance_mm = 0U;
-    uint32_t sensor_ts_ms = 0U;
-    uint32_t current_time_ms = hal_now_ms();
-    bool sensor_valid = false;
+void app_autobrake_step_ctx(autobrake_state_t* ctx, hal_io_t* io) {
+    const hal_inputs_t* in = &io->in;
+    sector_scan_t scan = {0U, 0U, 0U, 0U};
     bool should_brake = false;
+    bool speed_ok = false;
     
-    if (!hal_get_vehicle_ready()) {
-        state.hit_count = 0U;
-        state.brake_active = false;
-        hal_set_brake_request(false);
+    if (!in->vehicle_ready) {
+        reset_ctx(ctx);
+        io->out.brake_request = false;
         return;
     }
     
-    if (hal_driver_brake_pressed()) {
-        state.hit_count = 0U;
-        state.brake_active = false;
-        hal_set_brake_request(false);
+    if (in->driver_brake) {
+        reset_ctx(ctx);
+        io->out.brake_request = false;
         return;
     }
     
-    sensor_valid = hal_read_distance_mm(&distance_mm, &sensor_ts_ms);
-    
-    if (!sensor_valid) {
-        state.hit_count = 0U;
-        state.brake_active = false;
-        hal_set_brake_request(false);
+    scan_sectors(ctx, in, &scan);
+    if (scan.fresh == 0U) {
+        reset_ctx(ctx);
+        io->out.brake_request = false;
         return;
     }
     
-    if ((current_time_ms - sensor_ts_ms) > SENSOR_STALE_MS) {
-        state.hit_count = 0U;
-        state.brake_active = false;
-        hal_set_brake_request(false);
-        return;
-    }
+    ctx->brake_active = (scan.armed != 0U);
+    should_brake = ctx->brake_active;
     
-    if (distance_mm <= AB_THRESHOLD_MM) {
-        if (state.hit_count < AB_DEBOUNCE_HITS) {
-            state.hit_count++;
-        }
-        
-        if (state.hit_count >= AB_DEBOUNCE_HITS) {
-            should_brake = true;
-            state.brake_active = true;
-        }
-    } else {
-        state.hit_count = 0U;
-        state.brake_active = false;
+    speed_ok = in->speed_valid && ((in->now_ms - in->speed_ts_ms) <= SENSOR_STALE_MS);
+    if (autobrake_ttc_step(&ctx->ttc, scan.nearest_mm, in->distance.ts_ms[scan.nearest],
+                           speed_ok, in->speed_kph)) {
+        should_brake = true;
     }
     
-    hal_set_brake_request(should_brake);
-}
\ No newline at end of file
+    io->out.brake_request = should_brake;
+}
+
+void app_autobrake_step(void) {
+    hal_inputs_t* in = &default_io.in;
+    
+    in->now_ms = hal_now_ms();
+    in->vehicle_ready = hal_get_vehicle_ready();
+    in->driver_brake = hal_driver_brake_pressed();
+    in->distance_valid = hal_read_distance_array(&in->distance);
+    in->speed_valid = hal_read_vehicle_speed_kph(&in->speed_kph, &in->speed_ts_ms);
+    
+    app_autobrake_step_ctx(&state, &default_io);
+    
+    hal_set_brake_request(default_io.out.brake_request);
+}
@@ -2,6 +2,13 @@
 #include "hal.h"
 #include "calib.h"
 #include "platform.h"
+#include "sched_cfg.h"
+
+#define PARK_REVERSE_STEPS     (PARK_REVERSE_MS / SCHED_AUTOPARK_PERIOD_MS)
+#define PARK_STRAIGHTEN_STEPS  (PARK_STRAIGHTEN_MS / SCHED_AUTOPARK_PERIOD_MS)
+/* Rounded up: a slot longer than the confirm time still needs one sighting. */
+#define PARK_GAP_CONFIRM_STEPS \
+    ((PARK_GAP_CONFIRM_MS + SCHED_AUTOPARK_PERIOD_MS - 1U) / SCHED_AUTOPARK_PERIOD_MS)
 
 typedef enum {
     PARK_STATE_SCANNING = 0U,
@@ -11,108 +18,107 @@ typedef enum {
     PARK_STATE_DONE = 4U
 } park_state_e;
 
-typedef struct {
-    uint8_t state;
-    uint16_t step_counter;
-    uint8_t gap_detections;
-    bool gap_suitable;
-} autopark_state_t;
-
 static autopark_state_t state = {PARK_STATE_SCANNING, 0U, 0U, false};
+static hal_io_t default_io;
+
+void app_autopark_init_ctx(autopark_state_t* ctx) {
+    ctx->state = PARK_STATE_SCANNING;
+    ctx->step_counter = 0U;
+    ctx->gap_detections = 0U;
+    ctx->gap_suitable = false;
+}
 
 void app_autopark_init(void) {
-    state.state = PARK_STATE_SCANNING;
-    state.step_counter = 0U;
-    state.gap_detections = 0U;
-    state.gap_suitable = false;
+    app_autopark_init_ctx(&state);
 }
 
-static bool is_speed_suitable_for_parking(void) {
-    uint16_t speed_kph = 0U;
-    uint32_t ts_ms = 0U;
-    
-    if (!hal_read_vehicle_speed_kph(&speed_kph, &ts_ms)) {
-        return false;
-    }
-    
-    return (speed_kph <= 10U);
+static bool is_speed_suitable_for_parking(const hal_inputs_t* in) {
+    return in->speed_valid && (in->speed_kph <= 10U);
 }
 
-void app_autopark_step(void) {
-    park_gap_t gap_data;
-    uint32_t sensor_ts_ms = 0U;
-    uint32_t current_time_ms = hal_now_ms();
-    bool sensor_valid = false;
+void app_autopark_step_ctx(autopark_state_t* ctx, hal_io_t* io) {
+    const hal_inputs_t* in = &io->in;
+    const park_gap_t* gap_data = &in->gap;
     uint8_t prompt_code = 0U;
     
-    if (!is_speed_suitable_for_parking()) {
-        app_autopark_init();
-        hal_actuate_parking_prompt(0U);
+    if (!is_speed_suitable_for_parking(in)) {
+        app_autopark_init_ctx(ctx);
+        io->out.park_step = 0U;
         return;
     }
     
-    sensor_valid = hal_parking_gap_read(&gap_data, &sensor_ts_ms);
-    
-    if (!sensor_valid || ((current_time_ms - sensor_ts_ms) > SENSOR_STALE_MS)) {
-        if (state.state != PARK_STATE_SCANNING) {
-            app_autopark_init();
+    if (!in->gap_valid || ((in->now_ms - in->gap_ts_ms) > SENSOR_STALE_MS)) {
+        if (ctx->state != PARK_STATE_SCANNING) {
+            app_autopark_init_ctx(ctx);
         }
-        hal_actuate_parking_prompt(0U);
+        io->out.park_step = 0U;
         return;
     }
     
-    switch (state.state) {
+    switch (ctx->state) {
         case PARK_STATE_SCANNING:
-            if (gap_data.found && (gap_data.width_mm >= PARK_MIN_GAP_MM)) {
-                state.gap_detections++;
-                if (state.gap_detections >= 3U) {
-                    state.gap_suitable = true;
-                    state.state = PARK_STATE_REVERSING_RIGHT;
-                    state.step_counter = 0U;
+            if (gap_data->found && (gap_data->width_mm >= PARK_MIN_GAP_MM)) {
+                ctx->gap_detections++;
+                if (ctx->gap_detections >= PARK_GAP_CONFIRM_STEPS) {
+                    ctx->gap_suitable = true;
+                    ctx->state = PARK_STATE_REVERSING_RIGHT;
+                    ctx->step_counter = 0U;
                 }
             } else {
-                state.gap_detections = 0U;
-                state.gap_suitable = false;
+                ctx->gap_detections = 0U;
+                ctx->gap_suitable = false;
             }
             prompt_code = 1U;
             break;
-            
+        
         case PARK_STATE_REVERSING_RIGHT:
-            state.step_counter++;
-            if (state.step_counter >= 50U) {
-                state.state = PARK_STATE_STRAIGHTENING;
-                state.step_counter = 0U;
+            ctx->step_counter++;
+            if (ctx->step_counter >= PARK_REVERSE_STEPS) {
+                ctx->state = PARK_STATE_STRAIGHTENING;
+                ctx->step_counter = 0U;
             }
             prompt_code = 2U;
             break;
-            
+        
         case PARK_STATE_STRAIGHTENING:
-            state.step_counter++;
-            if (state.step_counter >= 20U) {
-                state.state = PARK_STATE_REVERSING_LEFT;
-                state.step_counter = 0U;
+            ctx->step_counter++;
+            if (ctx->step_counter >= PARK_STRAIGHTEN_STEPS) {
+                ctx->state = PARK_STATE_REVERSING_LEFT;
+                ctx->step_counter = 0U;
             }
             prompt_code = 3U;
             break;
-            
+        
         case PARK_STATE_REVERSING_LEFT:
-            state.step_counter++;
-            if (state.step_counter >= 50U) {
-                state.state = PARK_STATE_DONE;
-                state.step_counter = 0U;
+            ctx->step_counter++;
+            if (ctx->step_counter >= PARK_REVERSE_STEPS) {
+                ctx->state = PARK_STATE_DONE;
+                ctx->step_counter = 0U;
             }
             prompt_code = 4U;
             break;
-            
+        
         case PARK_STATE_DONE:
             prompt_code = 5U;
             break;
-            
+        
         default:
-            app_autopark_init();
+            app_autopark_init_ctx(ctx);
             prompt_code = 0U;
             break;
     }
     
-    hal_actuate_parking_prompt(prompt_code);
-}
\ No newline at end of file
+    io->out.park_step = prompt_code;
+}
+
+void app_autopark_step(void) {
+    hal_inputs_t* in = &default_io.in;
+    
+    in->now_ms = hal_now_ms();
+    in->speed_valid = hal_read_vehicle_speed_kph(&in->speed_kph, &in->speed_ts_ms);
+    in->gap_valid = hal_parking_gap_read(&in->gap, &in->gap_ts_ms);
+    
+    app_autopark_step_ctx(&state, &default_io);
+    
+    hal_actuate_parking_prompt(default_io.out.park_step);
+}
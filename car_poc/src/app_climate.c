@@ -10,25 +10,31 @@
 #define PI_OUTPUT_MAX (300)
 #define PI_OUTPUT_MIN (-300)
 #define HIGH_HUMIDITY_THRESHOLD (70U)
-
-typedef struct {
-    int16_t setpoint_x10;
-    int32_t integral_accumulator;
-    uint32_t last_update_ms;
-    uint8_t current_fan_stage;
-    bool current_ac_on;
-    uint8_t current_blend_pct;
-} climate_state_t;
+/* The scheduler runs climate once per CLIMATE_DT_MS, but the clock read in
+ * the slot jitters by up to a tick, so a slot that ends up 999 ms after the
+ * last one must still update. */
+#define CLIMATE_DT_MIN_MS (CLIMATE_DT_MS - (TICK_MS / 2U))
 
 static climate_state_t state = {220, 0, 0U, 0U, false, 50U};
+static hal_io_t default_io;
+
+void app_climate_init_ctx(climate_state_t* ctx) {
+    ctx->setpoint_x10 = 220;
+    ctx->integral_accumulator = 0;
+    ctx->last_update_ms = 0U;
+    ctx->current_fan_stage = 0U;
+    ctx->current_ac_on = false;
+    ctx->current_blend_pct = 50U;
+}
 
 void app_climate_init(void) {
-    state.setpoint_x10 = 220;
-    state.integral_accumulator = 0;
-    state.last_update_ms = 0U;
-    state.current_fan_stage = 0U;
-    state.current_ac_on = false;
-    state.current_blend_pct = 50U;
+    app_climate_init_ctx(&state);
+}
+
+static void apply_climate_outputs(const climate_state_t* ctx, hal_outputs_t* out) {
+    out->fan_stage = ctx->current_fan_stage;
+    out->ac_on = ctx->current_ac_on;
+    out->blend_pct = ctx->current_blend_pct;
 }
 
 static uint8_t map_pi_output_to_fan_stage(int32_t pi_output) {
@@ -62,85 +68,88 @@ static uint8_t calculate_blend_percentage(int32_t pi_output) {
     return blend_pct;
 }
 
-void app_climate_step(void) {
-    int16_t cabin_temp_x10 = 0;
-    int16_t ambient_temp_x10 = 0;
-    uint8_t humidity_pct = 0U;
-    uint32_t sensor_ts_ms = 0U;
-    uint32_t current_time_ms = hal_now_ms();
-    bool cabin_valid = false;
-    bool ambient_valid = false;
-    bool humidity_valid = false;
+void app_climate_step_ctx(climate_state_t* ctx, hal_io_t* io) {
+    const hal_inputs_t* in = &io->in;
+    uint32_t current_time_ms = in->now_ms;
     int32_t error_x10 = 0;
     int32_t pi_output = 0;
     uint32_t dt_ms = 0U;
     bool ac_required = false;
     
-    cabin_valid = hal_read_cabin_temp_c(&cabin_temp_x10, &sensor_ts_ms);
-    if (!cabin_valid || ((current_time_ms - sensor_ts_ms) > SENSOR_STALE_MS)) {
-        state.current_fan_stage = 0U;
-        state.current_ac_on = false;
-        state.current_blend_pct = 50U;
-        hal_set_climate(state.current_fan_stage, state.current_ac_on, state.current_blend_pct);
+    if (!in->cabin_valid || ((current_time_ms - in->cabin_ts_ms) > SENSOR_STALE_MS)) {
+        ctx->current_fan_stage = 0U;
+        ctx->current_ac_on = false;
+        ctx->current_blend_pct = 50U;
+        apply_climate_outputs(ctx, &io->out);
         return;
     }
     
-    ambient_valid = hal_read_ambient_temp_c(&ambient_temp_x10, &sensor_ts_ms);
-    humidity_valid = hal_read_humidity_pct(&humidity_pct, &sensor_ts_ms);
-    
-    if (state.last_update_ms == 0U) {
-        state.last_update_ms = current_time_ms;
-        hal_set_climate(state.current_fan_stage, state.current_ac_on, state.current_blend_pct);
+    if (ctx->last_update_ms == 0U) {
+        ctx->last_update_ms = current_time_ms;
+        apply_climate_outputs(ctx, &io->out);
         return;
     }
     
-    dt_ms = current_time_ms - state.last_update_ms;
-    if (dt_ms < CLIMATE_DT_MS) {
-        hal_set_climate(state.current_fan_stage, state.current_ac_on, state.current_blend_pct);
+    dt_ms = current_time_ms - ctx->last_update_ms;
+    if (dt_ms < CLIMATE_DT_MIN_MS) {
+        apply_climate_outputs(ctx, &io->out);
         return;
     }
     
-    state.last_update_ms = current_time_ms;
+    ctx->last_update_ms = current_time_ms;
     
-    error_x10 = state.setpoint_x10 - cabin_temp_x10;
+    error_x10 = ctx->setpoint_x10 - in->cabin_tc_x10;
     
-    state.integral_accumulator += ((int32_t)error_x10 * CLIMATE_KI);
+    ctx->integral_accumulator += ((int32_t)error_x10 * CLIMATE_KI);
     
-    if (state.integral_accumulator > INTEGRAL_CLAMP_MAX) {
-        state.integral_accumulator = INTEGRAL_CLAMP_MAX;
-    } else if (state.integral_accumulator < INTEGRAL_CLAMP_MIN) {
-        state.integral_accumulator = INTEGRAL_CLAMP_MIN;
+    if (ctx->integral_accumulator > INTEGRAL_CLAMP_MAX) {
+        ctx->integral_accumulator = INTEGRAL_CLAMP_MAX;
+    } else if (ctx->integral_accumulator < INTEGRAL_CLAMP_MIN) {
+        ctx->integral_accumulator = INTEGRAL_CLAMP_MIN;
     } else {
     }
     
-    pi_output = ((int32_t)error_x10 * CLIMATE_KP) + state.integral_accumulator;
+    pi_output = ((int32_t)error_x10 * CLIMATE_KP) + ctx->integral_accumulator;
     
     if (pi_output > PI_OUTPUT_MAX) {
         pi_output = PI_OUTPUT_MAX;
-        state.integral_accumulator -= ((int32_t)error_x10 * CLIMATE_KI);
+        ctx->integral_accumulator -= ((int32_t)error_x10 * CLIMATE_KI);
     } else if (pi_output < PI_OUTPUT_MIN) {
         pi_output = PI_OUTPUT_MIN;
-        state.integral_accumulator -= ((int32_t)error_x10 * CLIMATE_KI);
+        ctx->integral_accumulator -= ((int32_t)error_x10 * CLIMATE_KI);
     } else {
     }
     
-    state.current_fan_stage = map_pi_output_to_fan_stage(pi_output);
-    state.current_blend_pct = calculate_blend_percentage(pi_output);
+    ctx->current_fan_stage = map_pi_output_to_fan_stage(pi_output);
+    ctx->current_blend_pct = calculate_blend_percentage(pi_output);
     
     ac_required = false;
     if (error_x10 < -20) {
         ac_required = true;
     }
     
-    if (humidity_valid && (humidity_pct > HIGH_HUMIDITY_THRESHOLD)) {
+    if (in->humid_valid && (in->humid_pct > HIGH_HUMIDITY_THRESHOLD)) {
         ac_required = true;
     }
     
-    if (ambient_valid && (ambient_temp_x10 > (state.setpoint_x10 + 50))) {
+    if (in->ambient_valid && (in->ambient_tc_x10 > (ctx->setpoint_x10 + 50))) {
         ac_required = true;
     }
     
-    state.current_ac_on = ac_required;
+    ctx->current_ac_on = ac_required;
     
-    hal_set_climate(state.current_fan_stage, state.current_ac_on, state.current_blend_pct);
-}
\ No newline at end of file
+    apply_climate_outputs(ctx, &io->out);
+}
+
+void app_climate_step(void) {
+    hal_inputs_t* in = &default_io.in;
+    
+    in->now_ms = hal_now_ms();
+    in->cabin_valid = hal_read_cabin_temp_c(&in->cabin_tc_x10, &in->cabin_ts_ms);
+    in->ambient_valid = hal_read_ambient_temp_c(&in->ambient_tc_x10, &in->ambient_ts_ms);
+    in->humid_valid = hal_read_humidity_pct(&in->humid_pct, &in->humid_ts_ms);
+    
+    app_climate_step_ctx(&state, &default_io);
+    
+    hal_set_climate(default_io.out.fan_stage, default_io.out.ac_on, default_io.out.blend_pct);
+}
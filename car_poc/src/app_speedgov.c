@@ -1,79 +1,78 @@
 #include "app_speedgov.h"
 #include "hal.h"
 #include "calib.h"
+#include "fsm_cfg.h"
 #include "platform.h"
 
-typedef struct {
-    uint16_t current_limit_kph;
-    uint8_t overspeed_count;
-    bool alarm_active;
-} speedgov_state_t;
+typedef char speedgov_fsm_rows[(HYST_FSM_STATES(SPEEDGOV_FSM) ==
+                                (SPEEDGOV_FSM_ALARM + 1U)) ? 1 : -1];
+
+static const uint8_t speedgov_next[HYST_FSM_STATES(SPEEDGOV_FSM)][HYST_FSM_INPUTS_4] = {
+    SPEEDGOV_FSM(HYST_FSM_ROW_4)
+};
 
 static speedgov_state_t state = {50U, 0U, false};
+static hal_io_t default_io;
+
+void app_speedgov_init_ctx(speedgov_state_t* ctx) {
+    ctx->current_limit_kph = 50U;
+    ctx->overspeed_count = 0U;
+    ctx->alarm_active = false;
+}
 
 void app_speedgov_init(void) {
-    state.current_limit_kph = 50U;
-    state.overspeed_count = 0U;
-    state.alarm_active = false;
+    app_speedgov_init_ctx(&state);
 }
 
-void app_speedgov_step(void) {
-    uint16_t vehicle_speed_kph = 0U;
-    uint32_t sensor_ts_ms = 0U;
-    uint32_t current_time_ms = hal_now_ms();
-    bool sensor_valid = false;
-    uint16_t new_limit = 0U;
-    bool speed_limit_updated = false;
+void app_speedgov_step_ctx(speedgov_state_t* ctx, hal_io_t* io) {
+    const hal_inputs_t* in = &io->in;
     uint16_t overspeed_threshold = 0U;
     uint16_t clear_threshold = 0U;
-    bool should_alarm = false;
+    uint32_t input = 0U;
     
-    speed_limit_updated = hal_poll_speed_limit_kph(&new_limit);
-    if (speed_limit_updated) {
-        state.current_limit_kph = new_limit;
-        state.overspeed_count = 0U;
-        state.alarm_active = false;
+    if (in->limit_event) {
+        ctx->current_limit_kph = in->limit_kph;
+        ctx->overspeed_count = 0U;
+        ctx->alarm_active = false;
+        io->in.limit_event = false;
     }
     
-    sensor_valid = hal_read_vehicle_speed_kph(&vehicle_speed_kph, &sensor_ts_ms);
+    io->out.limit_request = ctx->current_limit_kph;
     
-    if (!sensor_valid) {
-        state.overspeed_count = 0U;
-        state.alarm_active = false;
-        hal_set_alarm(false);
+    if (!in->speed_valid) {
+        ctx->overspeed_count = 0U;
+        ctx->alarm_active = false;
+        io->out.alarm = false;
         return;
     }
     
-    if ((current_time_ms - sensor_ts_ms) > SENSOR_STALE_MS) {
-        state.overspeed_count = 0U;
-        state.alarm_active = false;
-        hal_set_alarm(false);
+    if ((in->now_ms - in->speed_ts_ms) > SENSOR_STALE_MS) {
+        ctx->overspeed_count = 0U;
+        ctx->alarm_active = false;
+        io->out.alarm = false;
         return;
     }
     
-    overspeed_threshold = state.current_limit_kph + SPEED_ALARM_TOL_KPH;
-    clear_threshold = state.current_limit_kph - SPEED_HYSTERESIS_KPH;
+    overspeed_threshold = (uint16_t)(ctx->current_limit_kph + SPEED_ALARM_TOL_KPH);
+    clear_threshold = (uint16_t)(ctx->current_limit_kph - SPEED_HYSTERESIS_KPH);
     
-    if (state.alarm_active) {
-        if (vehicle_speed_kph < clear_threshold) {
-            state.alarm_active = false;
-            state.overspeed_count = 0U;
-        }
-    } else {
-        if (vehicle_speed_kph > overspeed_threshold) {
-            if (state.overspeed_count < SPEED_ALARM_DEBOUNCE) {
-                state.overspeed_count++;
-            }
-            
-            if (state.overspeed_count >= SPEED_ALARM_DEBOUNCE) {
-                state.alarm_active = true;
-            }
-        } else {
-            state.overspeed_count = 0U;
-        }
-    }
+    input = ((in->speed_kph > overspeed_threshold) ? SPEEDGOV_FSM_ABOVE : 0U) |
+            ((in->speed_kph < clear_threshold) ? SPEEDGOV_FSM_CLEARING : 0U);
+    ctx->overspeed_count = speedgov_next[ctx->overspeed_count][input];
+    ctx->alarm_active = (ctx->overspeed_count == SPEEDGOV_FSM_ALARM);
+    
+    io->out.alarm = ctx->alarm_active;
+}
+
+void app_speedgov_step(void) {
+    hal_inputs_t* in = &default_io.in;
     
-    should_alarm = state.alarm_active;
-    hal_set_alarm(should_alarm);
-    hal_set_speed_limit_request(state.current_limit_kph);
-}
\ No newline at end of file
+    in->now_ms = hal_now_ms();
+    in->limit_event = hal_poll_speed_limit_kph(&in->limit_kph);
+    in->speed_valid = hal_read_vehicle_speed_kph(&in->speed_kph, &in->speed_ts_ms);
+    
+    app_speedgov_step_ctx(&state, &default_io);
+    
+    hal_set_alarm(default_io.out.alarm);
+    hal_set_speed_limit_request(default_io.out.limit_request);
+}
@@ -2,9 +2,7 @@
 #include "hal.h"
 #include "platform.h"
 #include <string.h>
-#include <stdio.h>
 
-#define VOICE_BUFFER_SIZE (64U)
 #define WAKE_PHRASE "hey car"
 #define MAX_INTENTS (5U)
 
@@ -21,16 +19,18 @@ static const voice_intent_t intent_table[MAX_INTENTS] = {
     {"navigate home", "Navigating to home"}
 };
 
-typedef struct {
-    char last_command[VOICE_BUFFER_SIZE];
-    char last_response[VOICE_BUFFER_SIZE];
-} voice_state_t;
+static voice_state_t state = {{0}, {0}, NULL};
+static hal_io_t default_io;
 
-static voice_state_t state = {{0}, {0}};
+void app_voice_init_ctx(voice_state_t* ctx) {
+    ctx->last_command[0] = '\0';
+    ctx->last_response[0] = '\0';
+    ctx->trace = NULL;
+}
 
 void app_voice_init(void) {
-    state.last_command[0] = '\0';
-    state.last_response[0] = '\0';
+    app_voice_init_ctx(&state);
+    state.trace = trace_log_default();
 }
 
 static bool starts_with_wake_phrase(const char* input) {
@@ -61,7 +61,7 @@ static bool find_intent_match(const char* command, char* response, uint16_t resp
     return false;
 }
 
-static void process_voice_command(const char* command) {
+static void process_voice_command(voice_state_t* ctx, const char* command) {
     char response[VOICE_BUFFER_SIZE];
     bool intent_found = false;
     
@@ -69,30 +69,39 @@ static void process_voice_command(const char* command) {
         return;
     }
     
-    strncpy(state.last_command, command, VOICE_BUFFER_SIZE - 1U);
-    state.last_command[VOICE_BUFFER_SIZE - 1U] = '\0';
+    strncpy(ctx->last_command, command, VOICE_BUFFER_SIZE - 1U);
+    ctx->last_command[VOICE_BUFFER_SIZE - 1U] = '\0';
     
     if (!starts_with_wake_phrase(command)) {
-        strncpy(state.last_response, "Wake phrase not detected", VOICE_BUFFER_SIZE - 1U);
-        state.last_response[VOICE_BUFFER_SIZE - 1U] = '\0';
+        strncpy(ctx->last_response, "Wake phrase not detected", VOICE_BUFFER_SIZE - 1U);
+        ctx->last_response[VOICE_BUFFER_SIZE - 1U] = '\0';
         return;
     }
     
     intent_found = find_intent_match(command + strlen(WAKE_PHRASE), response, VOICE_BUFFER_SIZE);
+    (void)intent_found;
     
-    strncpy(state.last_response, response, VOICE_BUFFER_SIZE - 1U);
-    state.last_response[VOICE_BUFFER_SIZE - 1U] = '\0';
+    strncpy(ctx->last_response, response, VOICE_BUFFER_SIZE - 1U);
+    ctx->last_response[VOICE_BUFFER_SIZE - 1U] = '\0';
     
-    printf("Voice: %s -> %s\n", command, response);
+    if (trace_log_begin(ctx->trace, TRACE_ID_VOICE_COMMAND)) {
+        trace_log_str(ctx->trace, command);
+        trace_log_str(ctx->trace, response);
+        trace_log_commit(ctx->trace);
+    }
+}
+
+void app_voice_step_ctx(voice_state_t* ctx, hal_io_t* io) {
+    if (io->in.voice_valid) {
+        process_voice_command(ctx, io->in.voice_line);
+        io->in.voice_valid = false;
+    }
 }
 
 void app_voice_step(void) {
-    char voice_buffer[VOICE_BUFFER_SIZE];
-    bool voice_available = false;
+    hal_inputs_t* in = &default_io.in;
     
-    voice_available = hal_read_voice_line(voice_buffer, VOICE_BUFFER_SIZE);
+    in->voice_valid = hal_read_voice_line(in->voice_line, HAL_VOICE_LINE_LEN);
     
-    if (voice_available) {
-        process_voice_command(voice_buffer);
-    }
-}
\ No newline at end of file
+    app_voice_step_ctx(&state, &default_io);
+}
@@ -1,8 +1,24 @@
 #include "app_wipers.h"
 #include "hal.h"
 #include "calib.h"
+#include "fsm_cfg.h"
 #include "platform.h"
 
+#ifndef WIPERS_RAIN_SSE2
+#if defined(__SSE2__)
+#define WIPERS_RAIN_SSE2 1
+#else
+#define WIPERS_RAIN_SSE2 0
+#endif
+#endif
+
+#if WIPERS_RAIN_SSE2
+#include <immintrin.h>
+#endif
+
+typedef char wipers_burst_blocks[((HAL_RAIN_BURST_MAX % 16U) == 0U) &&
+                                 (HAL_RAIN_BURST_MAX < 128U) ? 1 : -1];
+
 typedef enum {
     WIPER_MODE_OFF = 0U,
     WIPER_MODE_INT = 1U,
@@ -10,70 +26,143 @@ typedef enum {
     WIPER_MODE_HIGH = 3U
 } wiper_mode_e;
 
-typedef struct {
-    uint8_t current_mode;
-} wipers_state_t;
+static const uint8_t wiper_next[HYST_FSM_STATES(WIPER_FSM)][HYST_FSM_INPUTS_256] = {
+    WIPER_FSM(HYST_FSM_ROW_256)
+};
+
+static wipers_state_t state = {WIPER_MODE_OFF, false, 0U, 0U, 0U};
+static hal_io_t default_io;
 
-static wipers_state_t state = {WIPER_MODE_OFF};
+void app_wipers_init_ctx(wipers_state_t* ctx) {
+    ctx->current_mode = WIPER_MODE_OFF;
+    ctx->raw_seen = false;
+    ctx->raw_ts_ms = 0U;
+    ctx->rain_level_q8 = 0U;
+    ctx->rain_peak_q8 = 0U;
+}
 
 void app_wipers_init(void) {
-    state.current_mode = WIPER_MODE_OFF;
+    app_wipers_init_ctx(&state);
+}
+
+#if WIPERS_RAIN_SSE2
+
+/* 16 samples per block: lanes at or past n are masked to zero, which
+ * changes neither the sum (psadbw against zero) nor the maximum. */
+static void burst_stats(const uint8_t burst[HAL_RAIN_BURST_MAX], uint32_t n, uint32_t* sum,
+                        uint32_t* max) {
+    const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i acc_sum = _mm_setzero_si128();
+    __m128i acc_max = _mm_setzero_si128();
+    uint32_t b = 0U;
+    
+    for (b = 0U; b < HAL_RAIN_BURST_MAX; b += 16U) {
+        __m128i used = _mm_cmplt_epi8(_mm_add_epi8(lane, _mm_set1_epi8((char)b)),
+                                      _mm_set1_epi8((char)n));
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)&burst[b]), used);
+        
+        acc_sum = _mm_add_epi64(acc_sum, _mm_sad_epu8(v, _mm_setzero_si128()));
+        acc_max = _mm_max_epu8(acc_max, v);
+    }
+    
+    acc_sum = _mm_add_epi64(acc_sum, _mm_srli_si128(acc_sum, 8));
+    acc_max = _mm_max_epu8(acc_max, _mm_srli_si128(acc_max, 8));
+    acc_max = _mm_max_epu8(acc_max, _mm_srli_si128(acc_max, 4));
+    acc_max = _mm_max_epu8(acc_max, _mm_srli_si128(acc_max, 2));
+    acc_max = _mm_max_epu8(acc_max, _mm_srli_si128(acc_max, 1));
+    *sum = (uint32_t)_mm_cvtsi128_si32(acc_sum);
+    *max = (uint32_t)_mm_cvtsi128_si32(acc_max) & 0xFFU;
 }
 
-static uint8_t determine_wiper_mode(uint8_t rain_pct, uint8_t current_mode) {
-    uint8_t new_mode = current_mode;
+#else
+
+static void burst_stats(const uint8_t burst[HAL_RAIN_BURST_MAX], uint32_t n, uint32_t* sum,
+                        uint32_t* max) {
+    uint32_t i = 0U;
     
-    if (current_mode == WIPER_MODE_OFF) {
-        if (rain_pct >= WIPER_T_RAIN_INT) {
-            new_mode = WIPER_MODE_INT;
-        }
-    } else if (current_mode == WIPER_MODE_INT) {
-        if (rain_pct < (WIPER_T_RAIN_INT - 5U)) {
-            new_mode = WIPER_MODE_OFF;
-        } else if (rain_pct >= WIPER_T_RAIN_LOW) {
-            new_mode = WIPER_MODE_LOW;
-        } else {
-        }
-    } else if (current_mode == WIPER_MODE_LOW) {
-        if (rain_pct < (WIPER_T_RAIN_INT - 5U)) {
-            new_mode = WIPER_MODE_INT;
-        } else if (rain_pct >= WIPER_T_RAIN_HIGH) {
-            new_mode = WIPER_MODE_HIGH;
-        } else {
-        }
-    } else if (current_mode == WIPER_MODE_HIGH) {
-        if (rain_pct < (WIPER_T_RAIN_LOW - 5U)) {
-            new_mode = WIPER_MODE_LOW;
-        }
+    *sum = 0U;
+    *max = 0U;
+    for (i = 0U; i < n; i++) {
+        *sum += burst[i];
+        *max = (burst[i] > *max) ? burst[i] : *max;
+    }
+}
+
+#endif
+
+/* Leaving out the largest sample of a burst drops a single droplet spike;
+ * the first burst after a gap starts the filter at its own mean. */
+static void filter_rain_burst(wipers_state_t* ctx, const uint8_t burst[HAL_RAIN_BURST_MAX],
+                              uint32_t n) {
+    uint32_t sum = 0U;
+    uint32_t max = 0U;
+    int32_t mean_q8 = 0;
+    int32_t level_q8 = ctx->rain_level_q8;
+    int32_t peak_q8 = ctx->rain_peak_q8;
+    
+    burst_stats(burst, n, &sum, &max);
+    if (n > 1U) {
+        mean_q8 = (int32_t)(((sum - max) << 8) / (n - 1U));
+    } else {
+        mean_q8 = (int32_t)(sum << 8);
+    }
+    
+    if (ctx->raw_seen) {
+        level_q8 += (mean_q8 - level_q8) / (int32_t)(1U << RAIN_IIR_SHIFT);
+        peak_q8 -= (int32_t)RAIN_PEAK_DECAY_Q8;
+        peak_q8 = (level_q8 > peak_q8) ? level_q8 : peak_q8;
     } else {
+        level_q8 = mean_q8;
+        peak_q8 = mean_q8;
     }
     
-    return new_mode;
+    ctx->rain_level_q8 = (uint16_t)level_q8;
+    ctx->rain_peak_q8 = (uint16_t)peak_q8;
 }
 
-void app_wipers_step(void) {
-    uint8_t rain_pct = 0U;
-    uint32_t sensor_ts_ms = 0U;
-    uint32_t current_time_ms = hal_now_ms();
-    bool sensor_valid = false;
-    uint8_t new_mode = WIPER_MODE_OFF;
+/* A raw rain stream, once it has delivered a burst, replaces rain_pct
+ * until it goes stale; then rain_pct is used again and the filter starts
+ * over with the next burst. */
+void app_wipers_step_ctx(wipers_state_t* ctx, hal_io_t* io) {
+    const hal_inputs_t* in = &io->in;
+    uint8_t rain_pct = in->rain_pct;
+    bool fresh = in->rain_valid && ((in->now_ms - in->rain_ts_ms) <= SENSOR_STALE_MS);
     
-    sensor_valid = hal_read_rain_level_pct(&rain_pct, &sensor_ts_ms);
+    if (in->rain_burst_len > 0U) {
+        filter_rain_burst(ctx, in->rain_burst, in->rain_burst_len);
+        ctx->raw_seen = true;
+        ctx->raw_ts_ms = in->rain_burst_ts_ms;
+        io->in.rain_burst_len = 0U;
+    }
     
-    if (!sensor_valid) {
-        state.current_mode = WIPER_MODE_OFF;
-        hal_set_wiper_mode(state.current_mode);
-        return;
+    if (ctx->raw_seen && ((in->now_ms - ctx->raw_ts_ms) > SENSOR_STALE_MS)) {
+        ctx->raw_seen = false;
+    }
+    if (ctx->raw_seen) {
+        fresh = true;
+        rain_pct = (uint8_t)(ctx->rain_peak_q8 >> 8);
     }
     
-    if ((current_time_ms - sensor_ts_ms) > SENSOR_STALE_MS) {
-        state.current_mode = WIPER_MODE_OFF;
-        hal_set_wiper_mode(state.current_mode);
+    if (!fresh) {
+        ctx->current_mode = WIPER_MODE_OFF;
+        io->out.wiper_mode = ctx->current_mode;
         return;
     }
     
-    new_mode = determine_wiper_mode(rain_pct, state.current_mode);
-    state.current_mode = new_mode;
+    ctx->current_mode = wiper_next[ctx->current_mode][rain_pct];
     
-    hal_set_wiper_mode(state.current_mode);
-}
\ No newline at end of file
+    io->out.wiper_mode = ctx->current_mode;
+}
+
+void app_wipers_step(void) {
+    hal_inputs_t* in = &default_io.in;
+    
+    in->now_ms = hal_now_ms();
+    in->rain_valid = hal_read_rain_level_pct(&in->rain_pct, &in->rain_ts_ms);
+    in->rain_burst_len = hal_read_rain_burst(in->rain_burst, HAL_RAIN_BURST_MAX,
+                                             &in->rain_burst_ts_ms);
+    
+    app_wipers_step_ctx(&state, &default_io);
+    
+    hal_set_wiper_mode(default_io.out.wiper_mode);
+}
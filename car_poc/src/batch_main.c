@@ -0,0 +1,331 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "platform.h"
+#include "vehicle.h"
+#include "hal_mock.h"
+#include "scenario.h"
+#include <dirent.h>
+#include <glob.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_MAX_SCENARIOS (4096U)
+#define BATCH_MAX_WORKERS   (256U)
+#define BATCH_PATH_LEN      (512U)
+
+typedef struct {
+    char path[BATCH_PATH_LEN];
+    char out_path[2U * BATCH_PATH_LEN];
+    bool ran;
+    bool ok;
+    uint32_t ticks;
+    uint32_t brake_ticks;
+    uint32_t alarm_ticks;
+    uint8_t max_wiper_mode;
+    double wall_ms;
+} batch_job_t;
+
+/* Everything one worker needs to replay a scenario; nothing is shared
+ * between workers except the job counter. */
+typedef struct {
+    vehicle_t vehicle;
+    trace_log_t trace;
+    hal_mock_t mock;
+    scenario_reader_t reader;
+    pthread_t thread;
+} batch_worker_t;
+
+static batch_job_t jobs[BATCH_MAX_SCENARIOS];
+static uint32_t job_count = 0U;
+static uint32_t next_job = 0U;
+static batch_worker_t workers[BATCH_MAX_WORKERS];
+static const char* out_dir = "batch_out";
+static bool interpolate_rows = false;
+static const char* out_suffix = ".out.csv";
+
+static double monotonic_ms(void) {
+    struct timespec ts;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1000.0) + ((double)ts.tv_nsec / 1e6);
+}
+
+static bool has_suffix(const char* name, const char* suffix) {
+    size_t name_len = strlen(name);
+    size_t suffix_len = strlen(suffix);
+    
+    return (name_len >= suffix_len) && (strcmp(name + (name_len - suffix_len), suffix) == 0);
+}
+
+static bool add_job(const char* path) {
+    if (job_count >= BATCH_MAX_SCENARIOS) {
+        fprintf(stderr, "Too many scenarios, limit is %u\n", BATCH_MAX_SCENARIOS);
+        return false;
+    }
+    
+    if (strlen(path) >= BATCH_PATH_LEN) {
+        fprintf(stderr, "Scenario path too long: %s\n", path);
+        return false;
+    }
+    
+    strcpy(jobs[job_count].path, path);
+    job_count++;
+    return true;
+}
+
+static int compare_jobs(const void* a, const void* b) {
+    return strcmp(((const batch_job_t*)a)->path, ((const batch_job_t*)b)->path);
+}
+
+static bool collect_directory(const char* dir_path) {
+    DIR* dir = opendir(dir_path);
+    struct dirent* entry = NULL;
+    char path[BATCH_PATH_LEN];
+    bool ok = true;
+    
+    if (dir == NULL) {
+        fprintf(stderr, "Cannot open directory: %s\n", dir_path);
+        return false;
+    }
+    
+    for (entry = readdir(dir); ok && (entry != NULL); entry = readdir(dir)) {
+        if (has_suffix(entry->d_name, ".csv")) {
+            (void)snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+            ok = add_job(path);
+        }
+    }
+    
+    (void)closedir(dir);
+    return ok;
+}
+
+static bool collect_glob(const char* pattern) {
+    glob_t matches;
+    size_t i = 0U;
+    bool ok = true;
+    
+    if (glob(pattern, 0, NULL, &matches) != 0) {
+        fprintf(stderr, "No scenarios match: %s\n", pattern);
+        return false;
+    }
+    
+    for (i = 0U; ok && (i < matches.gl_pathc); i++) {
+        ok = add_job(matches.gl_pathv[i]);
+    }
+    
+    globfree(&matches);
+    return ok;
+}
+
+static bool collect_scenarios(const char* arg) {
+    struct stat st;
+    
+    if ((stat(arg, &st) == 0) && S_ISDIR(st.st_mode)) {
+        return collect_directory(arg);
+    }
+    
+    if (strpbrk(arg, "*?[") != NULL) {
+        return collect_glob(arg);
+    }
+    
+    return add_job(arg);
+}
+
+static void make_output_path(batch_job_t* job, uint32_t index) {
+    const char* base = strrchr(job->path, '/');
+    char stem[BATCH_PATH_LEN];
+    
+    base = (base == NULL) ? job->path : (base + 1);
+    (void)snprintf(stem, sizeof(stem), "%s", base);
+    if (has_suffix(stem, ".csv")) {
+        stem[strlen(stem) - 4U] = '\0';
+    }
+    
+    (void)snprintf(job->out_path, sizeof(job->out_path), "%s/%04u_%s%s", out_dir, index, stem,
+                   out_suffix);
+}
+
+static void run_job(batch_worker_t* worker, batch_job_t* job) {
+    vehicle_t* vehicle = &worker->vehicle;
+    uint32_t now_ms = 0U;
+    double start_ms = monotonic_ms();
+    bool running = true;
+    
+    job->ran = true;
+    job->ok = false;
+    if (!scenario_reader_open(&worker->reader, job->path)) {
+        fprintf(stderr, "Failed to open scenario file: %s\n", job->path);
+        return;
+    }
+    
+    hal_mock_init_ctx(&worker->mock, &worker->reader);
+    worker->mock.interpolate_gaps = interpolate_rows;
+    if (!hal_mock_open_outputs(&worker->mock, job->out_path)) {
+        fprintf(stderr, "Failed to create output log: %s\n", job->out_path);
+        scenario_reader_close(&worker->reader);
+        return;
+    }
+    
+    vehicle_init(vehicle);
+    trace_log_init(&worker->trace);
+    vehicle->voice.trace = &worker->trace;
+    
+    while (running) {
+        hal_mock_begin_tick_ctx(&worker->mock, now_ms);
+        hal_mock_fill_inputs(&worker->mock, now_ms, &vehicle->io.in);
+        vehicle_step(vehicle);
+        hal_mock_write_outputs(&worker->mock, now_ms, &vehicle->io.out);
+        
+        job->ticks++;
+        job->brake_ticks += vehicle->io.out.brake_request ? 1U : 0U;
+        job->alarm_ticks += vehicle->io.out.alarm ? 1U : 0U;
+        if (vehicle->io.out.wiper_mode > job->max_wiper_mode) {
+            job->max_wiper_mode = vehicle->io.out.wiper_mode;
+        }
+        
+        running = !hal_mock_scenario_finished_ctx(&worker->mock) &&
+                  (now_ms <= (UINT32_MAX - TICK_MS));
+        now_ms += TICK_MS;
+    }
+    
+    /* The trace is printed after the run, so one scenario's lines stay
+     * together even with many workers. */
+    flockfile(stdout);
+    (void)trace_log_drain(&worker->trace, stdout);
+    funlockfile(stdout);
+    if (worker->trace.dropped > 0U) {
+        fprintf(stderr, "%s: trace log full, %u entries dropped\n", job->path,
+                worker->trace.dropped);
+    }
+    
+    job->ok = hal_mock_close(&worker->mock);
+    scenario_reader_close(&worker->reader);
+    job->wall_ms = monotonic_ms() - start_ms;
+    if (!job->ok) {
+        fprintf(stderr, "Failed writing output log: %s\n", job->out_path);
+    }
+}
+
+static void* worker_main(void* arg) {
+    batch_worker_t* worker = (batch_worker_t*)arg;
+    uint32_t index = __atomic_fetch_add(&next_job, 1U, __ATOMIC_RELAXED);
+    
+    while (index < job_count) {
+        run_job(worker, &jobs[index]);
+        index = __atomic_fetch_add(&next_job, 1U, __ATOMIC_RELAXED);
+    }
+    
+    return NULL;
+}
+
+/* Prints one line per job and returns the number of failed jobs. A job no
+ * worker picked up counts as failed. */
+static uint32_t print_summary(FILE* file, double total_wall_ms, uint32_t worker_count) {
+    uint32_t i = 0U;
+    uint32_t failed = 0U;
+    double sim_s_total = 0.0;
+    
+    fprintf(file, "scenario,status,ticks,sim_s,brake_ticks,alarm_ticks,max_wiper_mode,wall_ms,output\n");
+    for (i = 0U; i < job_count; i++) {
+        const batch_job_t* job = &jobs[i];
+        double sim_s = ((double)job->ticks * (double)TICK_MS) / 1000.0;
+        
+        failed += job->ok ? 0U : 1U;
+        sim_s_total += sim_s;
+        fprintf(file, "%s,%s,%u,%.2f,%u,%u,%u,%.3f,%s\n",
+                job->path, job->ok ? "ok" : (job->ran ? "FAIL" : "NOT_RUN"), job->ticks, sim_s,
+                job->brake_ticks, job->alarm_ticks, job->max_wiper_mode,
+                job->wall_ms, job->out_path);
+    }
+    
+    fprintf(file, "# %u scenarios (%u failed) on %u workers: %.2f s simulated in %.3f ms wall\n",
+            job_count, failed, worker_count, sim_s_total, total_wall_ms);
+    return failed;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options] <dir|glob|file>...\n", prog);
+    printf("Options:\n");
+    printf("  --jobs <n>     Worker threads (default: online CPUs)\n");
+    printf("  --out <dir>    Output directory (default: batch_out)\n");
+    printf("  --interp       Linearly interpolate sensors between sparse rows\n");
+    printf("  --binary       Write binary output logs (" OUTPUT_LOG_SUFFIX ", see output_convert)\n");
+    printf("  --delta        Write change-only output logs (" OUTPUT_DELTA_SUFFIX ")\n");
+    printf("  --help         Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t worker_count = (online_cpus > 0) ? (uint32_t)online_cpus : 1U;
+    char summary_path[BATCH_PATH_LEN];
+    FILE* summary_file = NULL;
+    double start_ms = 0.0;
+    uint32_t failed = 0U;
+    uint32_t i = 0U;
+    int arg = 0;
+    
+    for (arg = 1; arg < argc; arg++) {
+        if ((strcmp(argv[arg], "--jobs") == 0) && ((arg + 1) < argc)) {
+            worker_count = (uint32_t)strtoul(argv[arg + 1], NULL, 10);
+            arg++;
+        } else if ((strcmp(argv[arg], "--out") == 0) && ((arg + 1) < argc)) {
+            out_dir = argv[arg + 1];
+            arg++;
+        } else if (strcmp(argv[arg], "--interp") == 0) {
+            interpolate_rows = true;
+        } else if (strcmp(argv[arg], "--binary") == 0) {
+            out_suffix = OUTPUT_LOG_SUFFIX;
+        } else if (strcmp(argv[arg], "--delta") == 0) {
+            out_suffix = OUTPUT_DELTA_SUFFIX;
+        } else if (strcmp(argv[arg], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!collect_scenarios(argv[arg])) {
+            return 1;
+        } else {
+        }
+    }
+    
+    if (job_count == 0U) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    qsort(jobs, job_count, sizeof(batch_job_t), compare_jobs);
+    (void)mkdir(out_dir, 0755);
+    for (i = 0U; i < job_count; i++) {
+        make_output_path(&jobs[i], i);
+    }
+    
+    worker_count = (worker_count == 0U) ? 1U : worker_count;
+    worker_count = (worker_count > BATCH_MAX_WORKERS) ? BATCH_MAX_WORKERS : worker_count;
+    worker_count = (worker_count > job_count) ? job_count : worker_count;
+    
+    start_ms = monotonic_ms();
+    for (i = 0U; i < worker_count; i++) {
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to start worker %u\n", i);
+            worker_count = i;
+        }
+    }
+    for (i = 0U; i < worker_count; i++) {
+        (void)pthread_join(workers[i].thread, NULL);
+    }
+    
+    failed = print_summary(stdout, monotonic_ms() - start_ms, worker_count);
+    
+    (void)snprintf(summary_path, sizeof(summary_path), "%s/summary.csv", out_dir);
+    summary_file = fopen(summary_path, "w");
+    if (summary_file != NULL) {
+        (void)print_summary(summary_file, monotonic_ms() - start_ms, worker_count);
+        fclose(summary_file);
+    }
+    
+    /* A non-zero status lets a nightly job notice a broken scenario. */
+    return (failed > 0U) ? 1 : 0;
+}
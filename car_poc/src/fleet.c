@@ -0,0 +1,528 @@
+#include "fleet.h"
+#include "calib.h"
+#include "fsm_cfg.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#define FLEET_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define FLEET_HAVE_X86 0
+#endif
+
+#define FLEET_SPEED_LIMIT_DEFAULT (50U)
+
+#define WIPER_OFF  (0U)
+#define WIPER_INT  (1U)
+#define WIPER_LOW  (2U)
+#define WIPER_HIGH (3U)
+
+/* The scalar kernels step WIPER_FSM and SPEEDGOV_FSM by table lookup.
+ * The vector kernels have no per-lane byte gather, so they take WIPER_FSM
+ * as two per-mode thresholds instead: a mode steps up one level when
+ * rain >= up and down one level when rain < down. Index 4 holds any
+ * out-of-range mode unchanged, and the scalar kernel skips the table for
+ * it. Every kernel reads rain over 255 as 255, steps an overspeed count
+ * past SPEEDGOV_FSM_ALARM as the alarm state and takes the alarm from the
+ * count alone. */
+#define FLEET_WIPER_UP(state, up_if, up_arg, up_to, down_if, down_arg, down_to) \
+    HYST_FSM_UP_AT_##up_if(up_arg),
+#define FLEET_WIPER_DOWN(state, up_if, up_arg, up_to, down_if, down_arg, down_to) \
+    HYST_FSM_DOWN_BELOW_##down_if(down_arg),
+#define FLEET_WIPER_BIG_STEP(state, up_if, up_arg, up_to, down_if, down_arg, down_to) \
+    + (uint32_t)(((up_to) - (state)) > 1U) + (uint32_t)(((state) - (down_to)) > 1U)
+#define WIPER_NEVER_UP (256U)
+
+typedef char fleet_wiper_single_steps[((0U WIPER_FSM(FLEET_WIPER_BIG_STEP)) == 0U) ? 1 : -1];
+
+static const uint16_t wiper_up_thr[5] = {
+    WIPER_FSM(FLEET_WIPER_UP) WIPER_NEVER_UP
+};
+static const uint16_t wiper_down_thr[5] = {
+    WIPER_FSM(FLEET_WIPER_DOWN) 0U
+};
+
+static const uint8_t wiper_next[HYST_FSM_STATES(WIPER_FSM)][HYST_FSM_INPUTS_256] = {
+    WIPER_FSM(HYST_FSM_ROW_256)
+};
+static const uint8_t speedgov_next[HYST_FSM_STATES(SPEEDGOV_FSM)][HYST_FSM_INPUTS_4] = {
+    SPEEDGOV_FSM(HYST_FSM_ROW_4)
+};
+
+bool fleet_isa_supported(fleet_isa_e isa) {
+    bool supported = false;
+    
+    switch (isa) {
+        case FLEET_ISA_SCALAR:
+            supported = true;
+            break;
+#if FLEET_HAVE_X86
+        case FLEET_ISA_SSE2:
+            supported = (__builtin_cpu_supports("sse2") != 0);
+            break;
+        case FLEET_ISA_AVX2:
+            supported = (__builtin_cpu_supports("avx2") != 0);
+            break;
+#endif
+        default:
+            supported = false;
+            break;
+    }
+    
+    return supported;
+}
+
+const char* fleet_isa_name(fleet_isa_e isa) {
+    const char* name = "unknown";
+    
+    if (isa == FLEET_ISA_SCALAR) {
+        name = "scalar";
+    } else if (isa == FLEET_ISA_SSE2) {
+        name = "sse2";
+    } else if (isa == FLEET_ISA_AVX2) {
+        name = "avx2";
+    } else {
+    }
+    
+    return name;
+}
+
+bool fleet_set_isa(fleet_t* fleet, fleet_isa_e isa) {
+    if (!fleet_isa_supported(isa)) {
+        return false;
+    }
+    
+    fleet->isa = isa;
+    return true;
+}
+
+bool fleet_init(fleet_t* fleet, uint32_t count) {
+    uint32_t i = 0U;
+    
+    if ((fleet == NULL) || (count > FLEET_MAX_VEHICLES)) {
+        return false;
+    }
+    
+    memset(fleet, 0, sizeof(fleet_t));
+    fleet->count = count;
+    fleet->ttc_enabled = true;
+    
+    for (i = 0U; i < FLEET_MAX_VEHICLES; i++) {
+        fleet->in_vehicle_ready[i] = 1U;
+        fleet->sg_limit_kph[i] = FLEET_SPEED_LIMIT_DEFAULT;
+    }
+    
+    fleet->isa = FLEET_ISA_SCALAR;
+    if (fleet_isa_supported(FLEET_ISA_AVX2)) {
+        fleet->isa = FLEET_ISA_AVX2;
+    } else if (fleet_isa_supported(FLEET_ISA_SSE2)) {
+        fleet->isa = FLEET_ISA_SSE2;
+    } else {
+    }
+    
+    return true;
+}
+
+/* ---- Scalar kernels: same arithmetic as the SIMD ones, one lane at a time */
+
+static uint32_t is_stale(uint32_t now_ms, uint32_t ts_ms) {
+    return (uint32_t)((now_ms - ts_ms) > SENSOR_STALE_MS);
+}
+
+static void autobrake_scalar(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i++) {
+        uint32_t reset = (uint32_t)(f->in_vehicle_ready[i] == 0U) |
+                         (uint32_t)(f->in_driver_brake[i] != 0U) |
+                         (uint32_t)(f->in_distance_valid[i] == 0U) |
+                         is_stale(f->now_ms, f->in_distance_ts_ms[i]);
+        uint32_t near = (uint32_t)(f->in_distance_mm[i] <= AB_THRESHOLD_MM);
+        uint32_t keep = (reset ^ 1U) & near;
+        uint32_t hit = f->ab_hit_count[i];
+        uint32_t hit_new = keep * (hit + (uint32_t)(hit < AB_DEBOUNCE_HITS));
+        uint32_t armed = (uint32_t)(hit_new >= AB_DEBOUNCE_HITS);
+        
+        f->ab_hit_count[i] = (uint16_t)hit_new;
+        f->ab_brake_active[i] = (uint16_t)(keep & ((uint32_t)f->ab_brake_active[i] | armed));
+        f->out_brake_request[i] = (uint16_t)(keep & armed);
+    }
+}
+
+/* The time-to-collision path fits a line through each vehicle's own,
+ * irregularly timed samples, which does not map onto 16-bit lanes. Every
+ * ISA runs it one vehicle at a time after the threshold kernel and ORs
+ * it into the brake request; brake_active stays the threshold latch.
+ * Vehicles whose ring would not change are decided from the columns
+ * alone: a reset of an empty ring, or a tick with no new sample, out of
+ * reach and a zero score. Only the rest load their ring. */
+static void autobrake_ttc_pass(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    if (!f->ttc_enabled) {
+        return;
+    }
+    
+    for (i = 0U; i < n; i++) {
+        uint32_t reset = (uint32_t)(f->in_vehicle_ready[i] == 0U) |
+                         (uint32_t)(f->in_driver_brake[i] != 0U) |
+                         (uint32_t)(f->in_distance_valid[i] == 0U) |
+                         is_stale(f->now_ms, f->in_distance_ts_ms[i]);
+        bool speed_ok = (f->in_speed_valid[i] != 0U) &&
+                        (is_stale(f->now_ms, f->in_speed_ts_ms[i]) == 0U);
+        bool idle = (f->ab_ttc_filled[i] != 0U) && (f->ab_ttc_scoring[i] == 0U) &&
+                    (f->ab_ttc_last_ts_ms[i] == f->in_distance_ts_ms[i]) &&
+                    !autobrake_ttc_in_reach(f->in_distance_mm[i], speed_ok, f->in_speed_kph[i]);
+        
+        if (reset != 0U) {
+            if ((f->ab_ttc_filled[i] | f->ab_ttc_scoring[i]) != 0U) {
+                autobrake_ttc_reset(&f->ab_ttc[i]);
+                f->ab_ttc_filled[i] = 0U;
+                f->ab_ttc_scoring[i] = 0U;
+            }
+        } else if (idle) {
+            /* Same ring, and a score that stays zero. */
+        } else {
+            if (autobrake_ttc_step(&f->ab_ttc[i], f->in_distance_mm[i], f->in_distance_ts_ms[i],
+                                   speed_ok, f->in_speed_kph[i])) {
+                f->out_brake_request[i] = 1U;
+            }
+            f->ab_ttc_filled[i] = 1U;
+            f->ab_ttc_scoring[i] = (uint16_t)(f->ab_ttc[i].score != 0U);
+            f->ab_ttc_last_ts_ms[i] = f->in_distance_ts_ms[i];
+        }
+    }
+}
+
+static void wipers_scalar(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i++) {
+        uint32_t ok = (uint32_t)(f->in_rain_valid[i] != 0U) &
+                      (is_stale(f->now_ms, f->in_rain_ts_ms[i]) ^ 1U);
+        uint32_t rain = (f->in_rain_pct[i] < 255U) ? f->in_rain_pct[i] : 255U;
+        uint32_t mode = f->wp_mode[i];
+        uint32_t next = (mode <= WIPER_HIGH) ? wiper_next[mode][rain] : mode;
+        
+        f->wp_mode[i] = (uint16_t)(ok * next);
+    }
+}
+
+static void speedgov_scalar(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i++) {
+        uint32_t ev = (uint32_t)(f->in_limit_event[i] != 0U);
+        uint32_t limit = ev ? f->in_limit_kph[i] : f->sg_limit_kph[i];
+        uint32_t held = (ev ^ 1U) * f->sg_overspeed_count[i];
+        uint32_t count = (held < SPEEDGOV_FSM_ALARM) ? held : SPEEDGOV_FSM_ALARM;
+        uint32_t ok = (uint32_t)(f->in_speed_valid[i] != 0U) &
+                      (is_stale(f->now_ms, f->in_speed_ts_ms[i]) ^ 1U);
+        uint32_t speed = f->in_speed_kph[i];
+        uint32_t over = (uint16_t)(limit + SPEED_ALARM_TOL_KPH);
+        uint32_t clear = (uint16_t)(limit - SPEED_HYSTERESIS_KPH);
+        uint32_t input = (uint32_t)(speed > over) * SPEEDGOV_FSM_ABOVE +
+                         (uint32_t)(speed < clear) * SPEEDGOV_FSM_CLEARING;
+        uint32_t count_new = speedgov_next[count][input];
+        
+        f->sg_limit_kph[i] = (uint16_t)limit;
+        f->sg_overspeed_count[i] = (uint16_t)(ok * count_new);
+        f->sg_alarm_active[i] = (uint16_t)(ok & (uint32_t)(count_new == SPEEDGOV_FSM_ALARM));
+        f->out_alarm[i] = f->sg_alarm_active[i];
+        f->out_limit_request[i] = (uint16_t)limit;
+    }
+}
+
+#if FLEET_HAVE_X86
+
+/* ---- SSE2 kernels: 8 vehicles per iteration, 16-bit lanes. SSE2 has no
+ * unsigned 16-bit compares, so a <= b is computed as subs_epu16(a, b) == 0. */
+
+#define SSE_SEL(m, a, b) _mm_or_si128(_mm_and_si128((m), (a)), _mm_andnot_si128((m), (b)))
+
+static __m128i sse_le_u16(__m128i a, __m128i b) {
+    return _mm_cmpeq_epi16(_mm_subs_epu16(a, b), _mm_setzero_si128());
+}
+
+static __m128i sse_not(__m128i a) {
+    return _mm_xor_si128(a, _mm_set1_epi32(-1));
+}
+
+static __m128i sse_is_zero(__m128i a) {
+    return _mm_cmpeq_epi16(a, _mm_setzero_si128());
+}
+
+static __m128i sse_set_u16(uint32_t v) {
+    return _mm_set1_epi16((short)(uint16_t)v);
+}
+
+static __m128i sse_stale(uint32_t now_ms, const uint32_t* ts_ms) {
+    const __m128i bias = _mm_set1_epi32((int)0x80000000U);
+    const __m128i now = _mm_set1_epi32((int)now_ms);
+    const __m128i lim = _mm_xor_si128(_mm_set1_epi32((int)SENSOR_STALE_MS), bias);
+    __m128i d0 = _mm_sub_epi32(now, _mm_loadu_si128((const __m128i*)&ts_ms[0]));
+    __m128i d1 = _mm_sub_epi32(now, _mm_loadu_si128((const __m128i*)&ts_ms[4]));
+    __m128i m0 = _mm_cmpgt_epi32(_mm_xor_si128(d0, bias), lim);
+    __m128i m1 = _mm_cmpgt_epi32(_mm_xor_si128(d1, bias), lim);
+    
+    return _mm_packs_epi32(m0, m1);
+}
+
+static __m128i sse_load(const uint16_t* p) {
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+static void sse_store(uint16_t* p, __m128i v) {
+    _mm_storeu_si128((__m128i*)p, v);
+}
+
+static void autobrake_sse2(fleet_t* f, uint32_t n) {
+    const __m128i one = sse_set_u16(1U);
+    const __m128i thr = sse_set_u16(AB_THRESHOLD_MM);
+    const __m128i deb = sse_set_u16(AB_DEBOUNCE_HITS);
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 8U) {
+        __m128i reset = _mm_or_si128(
+            _mm_or_si128(sse_is_zero(sse_load(&f->in_vehicle_ready[i])),
+                         sse_not(sse_is_zero(sse_load(&f->in_driver_brake[i])))),
+            _mm_or_si128(sse_is_zero(sse_load(&f->in_distance_valid[i])),
+                         sse_stale(f->now_ms, &f->in_distance_ts_ms[i])));
+        __m128i near = sse_le_u16(sse_load(&f->in_distance_mm[i]), thr);
+        __m128i keep = _mm_andnot_si128(reset, near);
+        __m128i hit = sse_load(&f->ab_hit_count[i]);
+        __m128i below = sse_not(sse_le_u16(deb, hit));
+        __m128i hit_new = _mm_and_si128(keep, _mm_sub_epi16(hit, below));
+        __m128i armed = sse_le_u16(deb, hit_new);
+        __m128i active = sse_not(sse_is_zero(sse_load(&f->ab_brake_active[i])));
+        
+        sse_store(&f->ab_hit_count[i], hit_new);
+        sse_store(&f->ab_brake_active[i],
+                  _mm_and_si128(_mm_and_si128(keep, _mm_or_si128(active, armed)), one));
+        sse_store(&f->out_brake_request[i], _mm_and_si128(_mm_and_si128(keep, armed), one));
+    }
+}
+
+static void wipers_sse2(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 8U) {
+        __m128i ok = _mm_andnot_si128(sse_stale(f->now_ms, &f->in_rain_ts_ms[i]),
+                                      sse_not(sse_is_zero(sse_load(&f->in_rain_valid[i]))));
+        __m128i mode = sse_load(&f->wp_mode[i]);
+        __m128i rain_in = sse_load(&f->in_rain_pct[i]);
+        __m128i rain = _mm_sub_epi16(rain_in, _mm_subs_epu16(rain_in, sse_set_u16(255U)));
+        __m128i m_off = _mm_cmpeq_epi16(mode, sse_set_u16(WIPER_OFF));
+        __m128i m_int = _mm_cmpeq_epi16(mode, sse_set_u16(WIPER_INT));
+        __m128i m_low = _mm_cmpeq_epi16(mode, sse_set_u16(WIPER_LOW));
+        __m128i m_high = _mm_cmpeq_epi16(mode, sse_set_u16(WIPER_HIGH));
+        __m128i up = SSE_SEL(m_off, sse_set_u16(wiper_up_thr[WIPER_OFF]),
+                     SSE_SEL(m_int, sse_set_u16(wiper_up_thr[WIPER_INT]),
+                     SSE_SEL(m_low, sse_set_u16(wiper_up_thr[WIPER_LOW]),
+                             sse_set_u16(WIPER_NEVER_UP))));
+        __m128i down = SSE_SEL(m_int, sse_set_u16(wiper_down_thr[WIPER_INT]),
+                       SSE_SEL(m_low, sse_set_u16(wiper_down_thr[WIPER_LOW]),
+                       SSE_SEL(m_high, sse_set_u16(wiper_down_thr[WIPER_HIGH]),
+                               _mm_setzero_si128())));
+        __m128i step_up = sse_le_u16(up, rain);
+        __m128i step_down = sse_not(sse_le_u16(down, rain));
+        __m128i next = _mm_add_epi16(_mm_sub_epi16(mode, step_up), step_down);
+        
+        sse_store(&f->wp_mode[i], _mm_and_si128(ok, next));
+    }
+}
+
+static void speedgov_sse2(fleet_t* f, uint32_t n) {
+    const __m128i tol = sse_set_u16(SPEED_ALARM_TOL_KPH);
+    const __m128i hyst = sse_set_u16(SPEED_HYSTERESIS_KPH);
+    const __m128i deb = sse_set_u16(SPEED_ALARM_DEBOUNCE);
+    const __m128i one = sse_set_u16(1U);
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 8U) {
+        __m128i ev = sse_not(sse_is_zero(sse_load(&f->in_limit_event[i])));
+        __m128i limit = SSE_SEL(ev, sse_load(&f->in_limit_kph[i]), sse_load(&f->sg_limit_kph[i]));
+        __m128i held = _mm_andnot_si128(ev, sse_load(&f->sg_overspeed_count[i]));
+        __m128i count = _mm_sub_epi16(held, _mm_subs_epu16(held, deb));
+        __m128i alarm = _mm_cmpeq_epi16(count, deb);
+        __m128i ok = _mm_andnot_si128(sse_stale(f->now_ms, &f->in_speed_ts_ms[i]),
+                                      sse_not(sse_is_zero(sse_load(&f->in_speed_valid[i]))));
+        __m128i speed = sse_load(&f->in_speed_kph[i]);
+        __m128i over = _mm_add_epi16(limit, tol);
+        __m128i clear = _mm_sub_epi16(limit, hyst);
+        __m128i holding = sse_le_u16(clear, speed);
+        __m128i above = sse_not(sse_le_u16(speed, over));
+        __m128i below_deb = sse_not(sse_le_u16(deb, count));
+        __m128i count_inc = _mm_and_si128(above, _mm_sub_epi16(count, below_deb));
+        __m128i alarm_new = SSE_SEL(alarm, holding, sse_le_u16(deb, count_inc));
+        __m128i count_new = SSE_SEL(alarm, _mm_and_si128(holding, count), count_inc);
+        __m128i alarm_out = _mm_and_si128(_mm_and_si128(ok, alarm_new), one);
+        
+        sse_store(&f->sg_limit_kph[i], limit);
+        sse_store(&f->sg_overspeed_count[i], _mm_and_si128(ok, count_new));
+        sse_store(&f->sg_alarm_active[i], alarm_out);
+        sse_store(&f->out_alarm[i], alarm_out);
+        sse_store(&f->out_limit_request[i], limit);
+    }
+}
+
+/* ---- AVX2 kernels: 16 vehicles per iteration, compiled for AVX2 only and
+ * selected at run time. */
+
+#define AVX_TARGET __attribute__((target("avx2")))
+#define AVX_SEL(m, a, b) _mm256_blendv_epi8((b), (a), (m))
+
+static AVX_TARGET __m256i avx_le_u16(__m256i a, __m256i b) {
+    return _mm256_cmpeq_epi16(_mm256_subs_epu16(a, b), _mm256_setzero_si256());
+}
+
+static AVX_TARGET __m256i avx_not(__m256i a) {
+    return _mm256_xor_si256(a, _mm256_set1_epi32(-1));
+}
+
+static AVX_TARGET __m256i avx_is_zero(__m256i a) {
+    return _mm256_cmpeq_epi16(a, _mm256_setzero_si256());
+}
+
+static AVX_TARGET __m256i avx_set_u16(uint32_t v) {
+    return _mm256_set1_epi16((short)(uint16_t)v);
+}
+
+static AVX_TARGET __m256i avx_stale(uint32_t now_ms, const uint32_t* ts_ms) {
+    const __m256i bias = _mm256_set1_epi32((int)0x80000000U);
+    const __m256i now = _mm256_set1_epi32((int)now_ms);
+    const __m256i lim = _mm256_xor_si256(_mm256_set1_epi32((int)SENSOR_STALE_MS), bias);
+    __m256i d0 = _mm256_sub_epi32(now, _mm256_loadu_si256((const __m256i*)&ts_ms[0]));
+    __m256i d1 = _mm256_sub_epi32(now, _mm256_loadu_si256((const __m256i*)&ts_ms[8]));
+    __m256i m0 = _mm256_cmpgt_epi32(_mm256_xor_si256(d0, bias), lim);
+    __m256i m1 = _mm256_cmpgt_epi32(_mm256_xor_si256(d1, bias), lim);
+    
+    /* packs works per 128-bit half; restore vehicle order afterwards */
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(m0, m1), 0xD8);
+}
+
+static AVX_TARGET __m256i avx_load(const uint16_t* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+static AVX_TARGET void avx_store(uint16_t* p, __m256i v) {
+    _mm256_storeu_si256((__m256i*)p, v);
+}
+
+static AVX_TARGET void autobrake_avx2(fleet_t* f, uint32_t n) {
+    const __m256i one = avx_set_u16(1U);
+    const __m256i thr = avx_set_u16(AB_THRESHOLD_MM);
+    const __m256i deb = avx_set_u16(AB_DEBOUNCE_HITS);
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 16U) {
+        __m256i reset = _mm256_or_si256(
+            _mm256_or_si256(avx_is_zero(avx_load(&f->in_vehicle_ready[i])),
+                            avx_not(avx_is_zero(avx_load(&f->in_driver_brake[i])))),
+            _mm256_or_si256(avx_is_zero(avx_load(&f->in_distance_valid[i])),
+                            avx_stale(f->now_ms, &f->in_distance_ts_ms[i])));
+        __m256i near = avx_le_u16(avx_load(&f->in_distance_mm[i]), thr);
+        __m256i keep = _mm256_andnot_si256(reset, near);
+        __m256i hit = avx_load(&f->ab_hit_count[i]);
+        __m256i below = avx_not(avx_le_u16(deb, hit));
+        __m256i hit_new = _mm256_and_si256(keep, _mm256_sub_epi16(hit, below));
+        __m256i armed = avx_le_u16(deb, hit_new);
+        __m256i active = avx_not(avx_is_zero(avx_load(&f->ab_brake_active[i])));
+        
+        avx_store(&f->ab_hit_count[i], hit_new);
+        avx_store(&f->ab_brake_active[i],
+                  _mm256_and_si256(_mm256_and_si256(keep, _mm256_or_si256(active, armed)), one));
+        avx_store(&f->out_brake_request[i], _mm256_and_si256(_mm256_and_si256(keep, armed), one));
+    }
+}
+
+static AVX_TARGET void wipers_avx2(fleet_t* f, uint32_t n) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 16U) {
+        __m256i ok = _mm256_andnot_si256(avx_stale(f->now_ms, &f->in_rain_ts_ms[i]),
+                                         avx_not(avx_is_zero(avx_load(&f->in_rain_valid[i]))));
+        __m256i mode = avx_load(&f->wp_mode[i]);
+        __m256i rain = _mm256_min_epu16(avx_load(&f->in_rain_pct[i]), avx_set_u16(255U));
+        __m256i m_off = _mm256_cmpeq_epi16(mode, avx_set_u16(WIPER_OFF));
+        __m256i m_int = _mm256_cmpeq_epi16(mode, avx_set_u16(WIPER_INT));
+        __m256i m_low = _mm256_cmpeq_epi16(mode, avx_set_u16(WIPER_LOW));
+        __m256i m_high = _mm256_cmpeq_epi16(mode, avx_set_u16(WIPER_HIGH));
+        __m256i up = AVX_SEL(m_off, avx_set_u16(wiper_up_thr[WIPER_OFF]),
+                     AVX_SEL(m_int, avx_set_u16(wiper_up_thr[WIPER_INT]),
+                     AVX_SEL(m_low, avx_set_u16(wiper_up_thr[WIPER_LOW]),
+                             avx_set_u16(WIPER_NEVER_UP))));
+        __m256i down = AVX_SEL(m_int, avx_set_u16(wiper_down_thr[WIPER_INT]),
+                       AVX_SEL(m_low, avx_set_u16(wiper_down_thr[WIPER_LOW]),
+                       AVX_SEL(m_high, avx_set_u16(wiper_down_thr[WIPER_HIGH]),
+                               _mm256_setzero_si256())));
+        __m256i step_up = avx_le_u16(up, rain);
+        __m256i step_down = avx_not(avx_le_u16(down, rain));
+        __m256i next = _mm256_add_epi16(_mm256_sub_epi16(mode, step_up), step_down);
+        
+        avx_store(&f->wp_mode[i], _mm256_and_si256(ok, next));
+    }
+}
+
+static AVX_TARGET void speedgov_avx2(fleet_t* f, uint32_t n) {
+    const __m256i tol = avx_set_u16(SPEED_ALARM_TOL_KPH);
+    const __m256i hyst = avx_set_u16(SPEED_HYSTERESIS_KPH);
+    const __m256i deb = avx_set_u16(SPEED_ALARM_DEBOUNCE);
+    const __m256i one = avx_set_u16(1U);
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < n; i += 16U) {
+        __m256i ev = avx_not(avx_is_zero(avx_load(&f->in_limit_event[i])));
+        __m256i limit = AVX_SEL(ev, avx_load(&f->in_limit_kph[i]), avx_load(&f->sg_limit_kph[i]));
+        __m256i count = _mm256_min_epu16(_mm256_andnot_si256(ev,
+                                         avx_load(&f->sg_overspeed_count[i])), deb);
+        __m256i alarm = _mm256_cmpeq_epi16(count, deb);
+        __m256i ok = _mm256_andnot_si256(avx_stale(f->now_ms, &f->in_speed_ts_ms[i]),
+                                         avx_not(avx_is_zero(avx_load(&f->in_speed_valid[i]))));
+        __m256i speed = avx_load(&f->in_speed_kph[i]);
+        __m256i over = _mm256_add_epi16(limit, tol);
+        __m256i clear = _mm256_sub_epi16(limit, hyst);
+        __m256i holding = avx_le_u16(clear, speed);
+        __m256i above = avx_not(avx_le_u16(speed, over));
+        __m256i below_deb = avx_not(avx_le_u16(deb, count));
+        __m256i count_inc = _mm256_and_si256(above, _mm256_sub_epi16(count, below_deb));
+        __m256i alarm_new = AVX_SEL(alarm, holding, avx_le_u16(deb, count_inc));
+        __m256i count_new = AVX_SEL(alarm, _mm256_and_si256(holding, count), count_inc);
+        __m256i alarm_out = _mm256_and_si256(_mm256_and_si256(ok, alarm_new), one);
+        
+        avx_store(&f->sg_limit_kph[i], limit);
+        avx_store(&f->sg_overspeed_count[i], _mm256_and_si256(ok, count_new));
+        avx_store(&f->sg_alarm_active[i], alarm_out);
+        avx_store(&f->out_alarm[i], alarm_out);
+        avx_store(&f->out_limit_request[i], limit);
+    }
+}
+
+#endif /* FLEET_HAVE_X86 */
+
+void fleet_step(fleet_t* fleet) {
+    uint32_t n = ((fleet->count + FLEET_LANES - 1U) / FLEET_LANES) * FLEET_LANES;
+    
+    switch (fleet->isa) {
+#if FLEET_HAVE_X86
+        case FLEET_ISA_AVX2:
+            autobrake_avx2(fleet, n);
+            autobrake_ttc_pass(fleet, fleet->count);
+            wipers_avx2(fleet, n);
+            speedgov_avx2(fleet, n);
+            break;
+        case FLEET_ISA_SSE2:
+            autobrake_sse2(fleet, n);
+            autobrake_ttc_pass(fleet, fleet->count);
+            wipers_sse2(fleet, n);
+            speedgov_sse2(fleet, n);
+            break;
+#endif
+        default:
+            autobrake_scalar(fleet, fleet->count);
+            autobrake_ttc_pass(fleet, fleet->count);
+            wipers_scalar(fleet, fleet->count);
+            speedgov_scalar(fleet, fleet->count);
+            break;
+    }
+}
@@ -1,85 +1,310 @@
 #include "hal.h"
+#include "hal_mock.h"
 #include "platform.h"
 #include "scenario.h"
 #include <stdio.h>
 #include <string.h>
 
-extern uint32_t platform_get_time_ms(void);
+static hal_mock_t default_mock = { .vehicle_ready = true, .outputs = { .blend_pct = 50U } };
+static const char* default_outputs_path = "outputs.csv";
 
-static scenario_row_t current_row;
-static bool row_valid = false;
-static bool driver_brake = false;
-static bool vehicle_ready = true;
-static bool speed_limit_event_pending = false;
-static uint16_t pending_speed_limit = 0U;
-
-static bool outputs_file_open = false;
-static FILE* outputs_file = NULL;
+void hal_mock_init_ctx(hal_mock_t* mock, scenario_reader_t* reader) {
+    memset(mock, 0, sizeof(hal_mock_t));
+    mock->reader = reader;
+    mock->vehicle_ready = true;
+}
 
-bool hal_get_vehicle_ready(void) {
-    return vehicle_ready;
+static bool fetch_row(hal_mock_t* mock, scenario_row_t* row) {
+    if (mock->reader == NULL) {
+        return scenario_get_next_row(row);
+    }
+    
+    return scenario_reader_next(mock->reader, row);
 }
 
-bool hal_driver_brake_pressed(void) {
-    return driver_brake;
+#define HAL_MOCK_HOLD_SAMPLE(name, type) \
+    if ((row->sampled & SCENARIO_SAMPLED(name)) != 0U) { \
+        mock->held_row.name = row->name; \
+        mock->held_ms[SCENARIO_COL_##name] = row->ms; \
+    }
+
+static void hold_samples(hal_mock_t* mock, const scenario_row_t* row) {
+    SCENARIO_COLUMNS(HAL_MOCK_HOLD_SAMPLE)
+    mock->held_sampled |= row->sampled;
 }
 
-uint32_t hal_now_ms(void) {
-    return platform_get_time_ms();
+/* Appends n samples to a burst of *len, keeping the newest
+ * HAL_RAIN_BURST_MAX. */
+static void burst_append(uint8_t* burst, uint8_t* len, const uint8_t* samples, uint32_t n) {
+    uint32_t skip = (n > HAL_RAIN_BURST_MAX) ? (n - HAL_RAIN_BURST_MAX) : 0U;
+    uint32_t add = n - skip;
+    uint32_t keep = *len;
+    uint32_t drop = ((keep + add) > HAL_RAIN_BURST_MAX) ? ((keep + add) - HAL_RAIN_BURST_MAX) : 0U;
+    
+    memmove(burst, &burst[drop], keep - drop);
+    memcpy(&burst[keep - drop], &samples[skip], add);
+    *len = (uint8_t)((keep - drop) + add);
 }
 
-static bool update_current_row(void) {
-    if (scenario_get_next_row(&current_row)) {
-        row_valid = true;
-        if (current_row.sign_event > 0U) {
-            speed_limit_event_pending = true;
-            pending_speed_limit = current_row.sign_event;
+static void advance_rows(hal_mock_t* mock, uint32_t now_ms) {
+    const scenario_row_t* row = &mock->next_row;
+    
+    if (!mock->scenario_primed) {
+        mock->channels = (mock->reader == NULL) ? scenario_channels() :
+                         scenario_reader_channels(mock->reader);
+        mock->next_row_valid = fetch_row(mock, &mock->next_row);
+        mock->scenario_primed = true;
+    }
+    
+    while (mock->next_row_valid && (row->ms <= now_ms)) {
+        hold_samples(mock, row);
+        if ((row->sampled & mock->channels & SCENARIO_SAMPLED(rain_raw)) != 0U) {
+            burst_append(mock->rain_burst, &mock->rain_burst_len, &row->rain_raw, 1U);
+            mock->rain_burst_ts_ms = row->ms;
         }
-        return true;
+        if (row->sign_event > 0U) {
+            mock->speed_limit_event_pending = true;
+            mock->pending_speed_limit = row->sign_event;
+        }
+        if (row->voice_cmd[0] != '\0') {
+            strncpy(mock->pending_voice, row->voice_cmd, HAL_VOICE_LINE_LEN - 1U);
+            mock->pending_voice[HAL_VOICE_LINE_LEN - 1U] = '\0';
+            mock->voice_event_pending = true;
+        }
+        mock->next_row_valid = fetch_row(mock, &mock->next_row);
     }
-    return false;
+    
+    mock->scenario_exhausted = !mock->next_row_valid;
 }
 
-bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms) {
-    if ((out_mm == NULL) || (out_ts_ms == NULL)) {
-        return false;
-    }
+static int32_t lerp_i32(int32_t a, int32_t b, uint32_t num, uint32_t den) {
+    int64_t delta = ((int64_t)b - (int64_t)a) * (int64_t)num;
     
-    if (!row_valid && !update_current_row()) {
-        return false;
+    return a + (int32_t)(delta / (int64_t)den);
+}
+
+/* Publishes a channel's held sample. With interpolation on, a channel whose
+ * next sample is more than a tick away is moved towards it and reported as
+ * sampled now. */
+static int32_t frame_channel(hal_mock_t* mock, scenario_col_e col, int32_t held, int32_t next,
+                             uint32_t now_ms) {
+    uint32_t held_ms = mock->held_ms[col];
+    uint32_t bit = (uint32_t)1U << (uint32_t)col;
+    
+    mock->frame.ts_ms[col] = held_ms;
+    if (mock->interpolate_gaps && ((mock->held_sampled & bit) != 0U) &&
+        mock->next_row_valid && ((mock->next_row.sampled & bit) != 0U) &&
+        ((mock->next_row.ms - held_ms) > TICK_MS) && (now_ms > held_ms)) {
+        mock->frame.ts_ms[col] = now_ms;
+        return lerp_i32(held, next, now_ms - held_ms, mock->next_row.ms - held_ms);
     }
     
-    *out_mm = current_row.distance_mm;
-    *out_ts_ms = current_row.ms;
-    return true;
+    return held;
 }
 
-bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
-    if ((out_pct == NULL) || (out_ts_ms == NULL)) {
-        return false;
+/* A sector going into or out of "nothing in range" steps, it does not
+ * ramp through made-up distances. */
+static int32_t sector_target(uint16_t held_mm, uint16_t next_mm) {
+    return ((held_mm == UINT16_MAX) || (next_mm == UINT16_MAX)) ? (int32_t)held_mm :
+           (int32_t)next_mm;
+}
+
+#define HAL_MOCK_FRAME_SECTOR(n) \
+    frame->sector_mm[n] = (uint16_t)frame_channel(mock, SCENARIO_COL_sector##n##_mm, \
+                                                  (int32_t)held->sector##n##_mm, \
+                                                  sector_target(held->sector##n##_mm, \
+                                                                nxt->sector##n##_mm), now_ms);
+
+static void fill_frame_from_row(hal_mock_t* mock, uint32_t now_ms) {
+    const scenario_row_t* held = &mock->held_row;
+    const scenario_row_t* nxt = &mock->next_row;
+    hal_mock_frame_t* frame = &mock->frame;
+    
+    frame->distance_mm = (uint16_t)frame_channel(mock, SCENARIO_COL_distance_mm,
+                                                 (int32_t)held->distance_mm,
+                                                 (int32_t)nxt->distance_mm, now_ms);
+    frame->rain_pct = (uint8_t)frame_channel(mock, SCENARIO_COL_rain_pct,
+                                             (int32_t)held->rain_pct,
+                                             (int32_t)nxt->rain_pct, now_ms);
+    frame->speed_kph = (uint16_t)frame_channel(mock, SCENARIO_COL_speed_kph,
+                                               (int32_t)held->speed_kph,
+                                               (int32_t)nxt->speed_kph, now_ms);
+    /* A gap reading is not interpolated, only re-stamped like the others. */
+    (void)frame_channel(mock, SCENARIO_COL_gap_found, 0, 0, now_ms);
+    frame->gap.found = held->gap_found;
+    frame->gap.width_mm = held->gap_width_mm;
+    frame->cabin_tc_x10 = (int16_t)frame_channel(mock, SCENARIO_COL_cabin_tc_x10,
+                                                 held->cabin_tc_x10, nxt->cabin_tc_x10, now_ms);
+    frame->ambient_tc_x10 = (int16_t)frame_channel(mock, SCENARIO_COL_ambient_tc_x10,
+                                                   held->ambient_tc_x10, nxt->ambient_tc_x10,
+                                                   now_ms);
+    frame->humid_pct = (uint8_t)frame_channel(mock, SCENARIO_COL_humid_pct,
+                                              (int32_t)held->humid_pct,
+                                              (int32_t)nxt->humid_pct, now_ms);
+    if ((mock->channels & SCENARIO_SECTOR_CHANNELS) != 0U) {
+        HAL_MOCK_FRAME_SECTOR(0)
+        HAL_MOCK_FRAME_SECTOR(1)
+        HAL_MOCK_FRAME_SECTOR(2)
+        HAL_MOCK_FRAME_SECTOR(3)
+        HAL_MOCK_FRAME_SECTOR(4)
+        HAL_MOCK_FRAME_SECTOR(5)
+        HAL_MOCK_FRAME_SECTOR(6)
+        HAL_MOCK_FRAME_SECTOR(7)
     }
+    frame->valid = mock->held_sampled & mock->channels;
+}
+
+void hal_mock_begin_tick_ctx(hal_mock_t* mock, uint32_t now_ms) {
+    advance_rows(mock, now_ms);
+    fill_frame_from_row(mock, now_ms);
+}
+
+static bool frame_valid(const hal_mock_frame_t* frame, scenario_col_e col) {
+    return ((frame->valid >> (uint32_t)col) & 1U) != 0U;
+}
+
+/* Sectors the recording does not have are invalid like any other missing
+ * channel, except that distance_mm stands in for the forward sector. */
+static uint16_t frame_sectors(const hal_mock_t* mock, distance_array_t* out) {
+    const hal_mock_frame_t* frame = &mock->frame;
+    uint32_t s = 0U;
     
-    if (!row_valid && !update_current_row()) {
-        return false;
+    if ((mock->channels & SCENARIO_SECTOR_CHANNELS) == 0U) {
+        out->mm[HAL_DISTANCE_FORWARD_SECTOR] = frame->distance_mm;
+        out->ts_ms[HAL_DISTANCE_FORWARD_SECTOR] = frame->ts_ms[SCENARIO_COL_distance_mm];
+        return frame_valid(frame, SCENARIO_COL_distance_mm) ?
+               (uint16_t)(1U << HAL_DISTANCE_FORWARD_SECTOR) : 0U;
     }
     
-    *out_pct = current_row.rain_pct;
-    *out_ts_ms = current_row.ms;
-    return true;
+    for (s = 0U; s < HAL_DISTANCE_SECTORS; s++) {
+        out->mm[s] = frame->sector_mm[s];
+        out->ts_ms[s] = frame->ts_ms[SCENARIO_COL_sector0_mm + s];
+    }
+    return (uint16_t)((frame->valid & mock->channels) >> SCENARIO_COL_sector0_mm);
 }
 
-bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms) {
-    if ((out_kph == NULL) || (out_ts_ms == NULL)) {
-        return false;
+void hal_mock_fill_inputs(hal_mock_t* mock, uint32_t now_ms, hal_inputs_t* in) {
+    const hal_mock_frame_t* frame = &mock->frame;
+    
+    in->now_ms = now_ms;
+    in->vehicle_ready = mock->vehicle_ready;
+    in->driver_brake = mock->driver_brake;
+    in->distance_valid = frame_sectors(mock, &in->distance);
+    in->rain_valid = frame_valid(frame, SCENARIO_COL_rain_pct);
+    in->rain_pct = frame->rain_pct;
+    in->rain_ts_ms = frame->ts_ms[SCENARIO_COL_rain_pct];
+    in->speed_valid = frame_valid(frame, SCENARIO_COL_speed_kph);
+    in->speed_kph = frame->speed_kph;
+    in->speed_ts_ms = frame->ts_ms[SCENARIO_COL_speed_kph];
+    in->gap_valid = frame_valid(frame, SCENARIO_COL_gap_found);
+    in->gap = frame->gap;
+    in->gap_ts_ms = frame->ts_ms[SCENARIO_COL_gap_found];
+    in->cabin_valid = frame_valid(frame, SCENARIO_COL_cabin_tc_x10);
+    in->cabin_tc_x10 = frame->cabin_tc_x10;
+    in->cabin_ts_ms = frame->ts_ms[SCENARIO_COL_cabin_tc_x10];
+    in->ambient_valid = frame_valid(frame, SCENARIO_COL_ambient_tc_x10);
+    in->ambient_tc_x10 = frame->ambient_tc_x10;
+    in->ambient_ts_ms = frame->ts_ms[SCENARIO_COL_ambient_tc_x10];
+    in->humid_valid = frame_valid(frame, SCENARIO_COL_humid_pct);
+    in->humid_pct = frame->humid_pct;
+    in->humid_ts_ms = frame->ts_ms[SCENARIO_COL_humid_pct];
+    
+    /* Events and raw rain samples stay latched in the inputs until the
+     * owning module consumes them, which may be several ticks later for
+     * slower schedule slots. */
+    if (mock->rain_burst_len > 0U) {
+        burst_append(in->rain_burst, &in->rain_burst_len, mock->rain_burst,
+                     mock->rain_burst_len);
+        in->rain_burst_ts_ms = mock->rain_burst_ts_ms;
+        mock->rain_burst_len = 0U;
     }
     
-    if (!row_valid && !update_current_row()) {
-        return false;
+    if (mock->speed_limit_event_pending) {
+        in->limit_event = true;
+        in->limit_kph = mock->pending_speed_limit;
+        mock->speed_limit_event_pending = false;
     }
     
-    *out_kph = current_row.speed_kph;
-    *out_ts_ms = current_row.ms;
-    return true;
+    if (mock->voice_event_pending) {
+        memcpy(in->voice_line, mock->pending_voice, HAL_VOICE_LINE_LEN);
+        in->voice_valid = true;
+        mock->voice_event_pending = false;
+    }
+}
+
+bool hal_mock_open_outputs(hal_mock_t* mock, const char* filename) {
+    return output_log_open(&mock->outputs_log, filename, output_log_format_for(filename));
+}
+
+void hal_mock_write_outputs(hal_mock_t* mock, uint32_t now_ms, const hal_outputs_t* out) {
+    output_log_append(&mock->outputs_log, now_ms, out);
+}
+
+bool hal_mock_scenario_finished_ctx(const hal_mock_t* mock) {
+    return mock->scenario_exhausted;
+}
+
+bool hal_mock_close(hal_mock_t* mock) {
+    return output_log_close(&mock->outputs_log);
+}
+
+bool hal_get_vehicle_ready(void) {
+    return default_mock.vehicle_ready;
+}
+
+bool hal_driver_brake_pressed(void) {
+    return default_mock.driver_brake;
+}
+
+uint32_t hal_now_ms(void) {
+    return (uint32_t)(platform_get_time_us() / 1000U);
+}
+
+void hal_mock_set_interpolation(bool enable) {
+    default_mock.interpolate_gaps = enable;
+}
+
+void hal_mock_set_outputs_path(const char* filename) {
+    default_outputs_path = filename;
+}
+
+void hal_mock_begin_tick(uint32_t now_ms) {
+    hal_mock_begin_tick_ctx(&default_mock, now_ms);
+}
+
+bool hal_mock_scenario_finished(void) {
+    return hal_mock_scenario_finished_ctx(&default_mock);
+}
+
+bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms) {
+    *out_mm = default_mock.frame.distance_mm;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_distance_mm];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_distance_mm);
+}
+
+uint16_t hal_read_distance_array(distance_array_t* out) {
+    return frame_sectors(&default_mock, out);
+}
+
+bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
+    *out_pct = default_mock.frame.rain_pct;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_rain_pct];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_rain_pct);
+}
+
+uint8_t hal_read_rain_burst(uint8_t* out_pct, uint8_t max, uint32_t* out_ts_ms) {
+    uint8_t n = (default_mock.rain_burst_len < max) ? default_mock.rain_burst_len : max;
+    
+    memcpy(out_pct, &default_mock.rain_burst[default_mock.rain_burst_len - n], n);
+    *out_ts_ms = default_mock.rain_burst_ts_ms;
+    default_mock.rain_burst_len = 0U;
+    return n;
+}
+
+bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms) {
+    *out_kph = default_mock.frame.speed_kph;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_speed_kph];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_speed_kph);
 }
 
 bool hal_poll_speed_limit_kph(uint16_t* out_limit_kph) {
@@ -87,9 +312,9 @@ bool hal_poll_speed_limit_kph(uint16_t* out_limit_kph) {
         return false;
     }
     
-    if (speed_limit_event_pending) {
-        *out_limit_kph = pending_speed_limit;
-        speed_limit_event_pending = false;
+    if (default_mock.speed_limit_event_pending) {
+        *out_limit_kph = default_mock.pending_speed_limit;
+        default_mock.speed_limit_event_pending = false;
         return true;
     }
     
@@ -97,138 +322,76 @@ bool hal_poll_speed_limit_kph(uint16_t* out_limit_kph) {
 }
 
 bool hal_parking_gap_read(park_gap_t* out, uint32_t* out_ts_ms) {
-    if ((out == NULL) || (out_ts_ms == NULL)) {
-        return false;
-    }
-    
-    if (!row_valid && !update_current_row()) {
-        return false;
-    }
-    
-    out->found = current_row.gap_found;
-    out->width_mm = current_row.gap_width_mm;
-    *out_ts_ms = current_row.ms;
-    return true;
+    *out = default_mock.frame.gap;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_gap_found];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_gap_found);
 }
 
 bool hal_read_cabin_temp_c(int16_t* out_tc_x10, uint32_t* out_ts_ms) {
-    if ((out_tc_x10 == NULL) || (out_ts_ms == NULL)) {
-        return false;
-    }
-    
-    if (!row_valid && !update_current_row()) {
-        return false;
-    }
-    
-    *out_tc_x10 = current_row.cabin_tc_x10;
-    *out_ts_ms = current_row.ms;
-    return true;
+    *out_tc_x10 = default_mock.frame.cabin_tc_x10;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_cabin_tc_x10];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_cabin_tc_x10);
 }
 
 bool hal_read_ambient_temp_c(int16_t* out_tc_x10, uint32_t* out_ts_ms) {
-    if ((out_tc_x10 == NULL) || (out_ts_ms == NULL)) {
-        return false;
-    }
-    
-    if (!row_valid && !update_current_row()) {
-        return false;
-    }
-    
-    *out_tc_x10 = current_row.ambient_tc_x10;
-    *out_ts_ms = current_row.ms;
-    return true;
+    *out_tc_x10 = default_mock.frame.ambient_tc_x10;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_ambient_tc_x10];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_ambient_tc_x10);
 }
 
 bool hal_read_humidity_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
-    if ((out_pct == NULL) || (out_ts_ms == NULL)) {
-        return false;
-    }
-    
-    if (!row_valid && !update_current_row()) {
-        return false;
-    }
-    
-    *out_pct = current_row.humid_pct;
-    *out_ts_ms = current_row.ms;
-    return true;
+    *out_pct = default_mock.frame.humid_pct;
+    *out_ts_ms = default_mock.frame.ts_ms[SCENARIO_COL_humid_pct];
+    return frame_valid(&default_mock.frame, SCENARIO_COL_humid_pct);
 }
 
 bool hal_read_voice_line(char* buf, uint16_t len) {
-    if ((buf == NULL) || (len == 0U)) {
+    if ((buf == NULL) || (len == 0U) || !default_mock.voice_event_pending) {
         return false;
     }
     
-    if (!row_valid && !update_current_row()) {
-        return false;
-    }
-    
-    if (strlen(current_row.voice_cmd) > 0U) {
-        strncpy(buf, current_row.voice_cmd, len - 1U);
-        buf[len - 1U] = '\0';
-        current_row.voice_cmd[0] = '\0';
-        return true;
-    }
-    
-    return false;
-}
-
-static void ensure_outputs_file_open(void) {
-    if (!outputs_file_open) {
-        outputs_file = fopen("outputs.csv", "w");
-        if (outputs_file != NULL) {
-            fprintf(outputs_file, "ms,brake,wiper_mode,alarm,limit_req,fan_stage,ac_on,blend,park_step\n");
-            outputs_file_open = true;
-        }
-    }
+    strncpy(buf, default_mock.pending_voice, len - 1U);
+    buf[len - 1U] = '\0';
+    default_mock.voice_event_pending = false;
+    return true;
 }
 
 void hal_set_brake_request(bool on) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%u,%d,", hal_now_ms(), on ? 1 : 0);
-    }
+    default_mock.outputs.brake_request = on;
 }
 
 void hal_set_wiper_mode(uint8_t mode) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%u,", mode);
-    }
+    default_mock.outputs.wiper_mode = mode;
 }
 
 void hal_set_alarm(bool on) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%d,", on ? 1 : 0);
-    }
+    default_mock.outputs.alarm = on;
 }
 
 void hal_set_speed_limit_request(uint16_t kph) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%u,", kph);
-    }
+    default_mock.outputs.limit_request = kph;
 }
 
 void hal_set_climate(uint8_t fan_stage, bool ac_on, uint8_t blend_pct) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%u,%d,%u,", fan_stage, ac_on ? 1 : 0, blend_pct);
-    }
+    default_mock.outputs.fan_stage = fan_stage;
+    default_mock.outputs.ac_on = ac_on;
+    default_mock.outputs.blend_pct = blend_pct;
 }
 
 void hal_actuate_parking_prompt(uint8_t step_code) {
-    ensure_outputs_file_open();
-    if (outputs_file != NULL) {
-        fprintf(outputs_file, "%u\n", step_code);
-        fflush(outputs_file);
+    default_mock.outputs.park_step = step_code;
+}
+
+void hal_mock_end_tick(uint32_t now_ms) {
+    if (!output_log_is_open(&default_mock.outputs_log)) {
+        (void)hal_mock_open_outputs(&default_mock, default_outputs_path);
     }
+    
+    hal_mock_write_outputs(&default_mock, now_ms, &default_mock.outputs);
 }
 
 void hal_mock_cleanup(void) {
-    if (outputs_file != NULL) {
-        fclose(outputs_file);
-        outputs_file = NULL;
-        outputs_file_open = false;
+    if (!hal_mock_close(&default_mock)) {
+        fprintf(stderr, "Failed writing output log %s\n", default_outputs_path);
     }
-}
\ No newline at end of file
+}
@@ -6,7 +6,6 @@
 #include <stdio.h>
 #include <string.h>
 
-extern uint32_t platform_get_time_ms(void);
 extern bool platform_sdl_pump_events(void);
 
 static SDL_Window* window = NULL;
@@ -158,7 +157,7 @@ bool hal_driver_brake_pressed(void) {
 }
 
 uint32_t hal_now_ms(void) {
-    return platform_get_time_ms();
+    return (uint32_t)(platform_get_time_us() / 1000U);
 }
 
 bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms) {
@@ -171,6 +170,24 @@ bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms) {
     return true;
 }
 
+/* The keyboard-driven obstacle sits straight ahead; the other sectors
+ * see nothing in range. */
+uint16_t hal_read_distance_array(distance_array_t* out) {
+    uint32_t now_ms = hal_now_ms();
+    uint32_t s = 0U;
+    
+    if (out == NULL) {
+        return 0U;
+    }
+    
+    for (s = 0U; s < HAL_DISTANCE_SECTORS; s++) {
+        out->mm[s] = UINT16_MAX;
+        out->ts_ms[s] = now_ms;
+    }
+    out->mm[HAL_DISTANCE_FORWARD_SECTOR] = sim_distance_mm;
+    return (uint16_t)((1UL << HAL_DISTANCE_SECTORS) - 1UL);
+}
+
 bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
     if ((out_pct == NULL) || (out_ts_ms == NULL)) {
         return false;
@@ -181,6 +198,14 @@ bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
     return true;
 }
 
+/* The keyboard rain level has no raw stream behind it. */
+uint8_t hal_read_rain_burst(uint8_t* out_pct, uint8_t max, uint32_t* out_ts_ms) {
+    (void)out_pct;
+    (void)max;
+    (void)out_ts_ms;
+    return 0U;
+}
+
 bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms) {
     if ((out_kph == NULL) || (out_ts_ms == NULL)) {
         return false;
@@ -7,18 +7,22 @@
 #include "app_climate.h"
 #include "app_voice.h"
 #include "scenario.h"
+#include "sched_table.h"
+#include "profiler.h"
+#if HEADLESS_BUILD
+#include "hal_mock.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #if HEADLESS_BUILD
 extern void platform_init(void);
-extern void platform_sleep_ms(uint32_t ms);
-extern void hal_mock_cleanup(void);
+extern void platform_use_sim_clock(bool enable);
+extern void platform_set_sim_time_ms(uint32_t now_ms);
 #else
 extern bool platform_sdl_init(void);
 extern void platform_sdl_quit(void);
-extern void platform_sdl_sleep(uint32_t ms);
 extern bool hal_sdl_init(void);
 extern void hal_sdl_cleanup(void);
 extern void hal_sdl_step(void);
@@ -26,8 +30,25 @@ extern void hal_sdl_step(void);
 
 static bool running = true;
 static const char* scenario_file = "cfg/scenario_default.csv";
+static bool fast_replay = false;
+static bool interpolate_rows = false;
+static bool stream_scenario = false;
+static bool direct_io = false;
+static const char* generator_desc = NULL;
+static const char* outputs_path = "outputs.csv";
+static uint32_t sched_frame = 0U;
+
+#define LEGACY_STEP_ENTRY(a, name, period_ms, phase_ms, priority, budget_us) \
+    [SCHED_ID_##name] = app_##name##_step,
+
+static void (* const legacy_steps[SCHED_NUM_SLOTS])(void) = {
+    SCHED_TABLE(LEGACY_STEP_ENTRY, 0)
+};
 
 static void init_all_modules(void) {
+    trace_log_init(trace_log_default());
+    (void)platform_trace_start(trace_log_default(), stdout);
+    PROF_INIT();
     app_autobrake_init();
     app_wipers_init();
     app_speedgov_init();
@@ -36,13 +57,23 @@ static void init_all_modules(void) {
     app_voice_init();
 }
 
+/* Prints the last trace entries before anything else reaches stdout. */
+static void stop_trace(void) {
+    platform_trace_stop();
+    if (trace_log_default()->dropped > 0U) {
+        fprintf(stderr, "Trace log full: %u entries dropped\n", trace_log_default()->dropped);
+    }
+}
+
+static void dispatch_slot(sched_id_e id, void* arg) {
+    (void)arg;
+    PROF_STEP(id, legacy_steps[id]());
+}
+
 static void tick_10ms(void) {
-    app_autobrake_step();
-    app_wipers_step();
-    app_speedgov_step();
-    app_autopark_step();
-    app_climate_step();
-    app_voice_step();
+    PROF_POLL();
+    sched_run_frame(sched_frame, dispatch_slot, NULL);
+    sched_frame = sched_next_frame(sched_frame);
 }
 
 static void parse_arguments(int argc, char* argv[]) {
@@ -52,10 +83,36 @@ static void parse_arguments(int argc, char* argv[]) {
         if ((strcmp(argv[i], "--scenario") == 0) && ((i + 1) < argc)) {
             scenario_file = argv[i + 1];
             i++;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            fast_replay = true;
+        } else if (strcmp(argv[i], "--interp") == 0) {
+            interpolate_rows = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream_scenario = true;
+        } else if (strcmp(argv[i], "--direct-io") == 0) {
+            stream_scenario = true;
+            direct_io = true;
+        } else if ((strcmp(argv[i], "--generate") == 0) && ((i + 1) < argc)) {
+            generator_desc = argv[i + 1];
+            i++;
+        } else if ((strcmp(argv[i], "--outputs") == 0) && ((i + 1) < argc)) {
+            outputs_path = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--schedule") == 0) {
+            sched_print_table(stdout);
+            exit(0);
         } else if (strcmp(argv[i], "--help") == 0) {
             printf("Usage: %s [options]\n", argv[0]);
             printf("Options:\n");
             printf("  --scenario <file>  Specify scenario CSV file\n");
+            printf("  --fast             Replay on a simulated clock as fast as possible\n");
+            printf("  --interp           Linearly interpolate sensors between sparse rows\n");
+            printf("  --stream           Read and parse the scenario on a background thread\n");
+            printf("  --direct-io        Like --stream, bypassing the page cache (O_DIRECT)\n");
+            printf("  --generate <desc>  Generate rows procedurally, e.g. seed=7,rows=100000\n");
+            printf("  --outputs <file>   Output log (default: outputs.csv); .outb is binary,\n");
+            printf("                     .outd change-only with keyframes\n");
+            printf("  --schedule         Print the module schedule table and exit\n");
             printf("  --help             Show this help\n");
             exit(0);
         } else {
@@ -64,41 +121,91 @@ static void parse_arguments(int argc, char* argv[]) {
 }
 
 #if HEADLESS_BUILD
-int main(int argc, char* argv[]) {
-    uint32_t last_tick_time = 0U;
+static void run_realtime(void) {
+    platform_timer_t tick_timer;
     uint32_t current_time = 0U;
-    uint32_t elapsed_time = 0U;
+    
+    platform_timer_start(&tick_timer, TICK_MS);
+    
+    while (running) {
+        platform_timer_wait(&tick_timer);
+        current_time = hal_now_ms();
+        
+        hal_mock_begin_tick(current_time);
+        tick_10ms();
+        hal_mock_end_tick(current_time);
+        if (hal_mock_scenario_finished()) {
+            running = false;
+        }
+    }
+    
+    stop_trace();
+    platform_timer_print_stats(&tick_timer, stdout);
+}
+
+static uint32_t run_fast(void) {
+    uint32_t sim_time_ms = 0U;
+    uint32_t tick_count = 0U;
+    
+    platform_use_sim_clock(true);
+    
+    while (running) {
+        platform_set_sim_time_ms(sim_time_ms);
+        hal_mock_begin_tick(sim_time_ms);
+        tick_10ms();
+        hal_mock_end_tick(sim_time_ms);
+        tick_count++;
+        
+        if (hal_mock_scenario_finished()) {
+            running = false;
+        }
+        sim_time_ms += TICK_MS;
+    }
+    
+    return tick_count;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t tick_count = 0U;
     
     parse_arguments(argc, argv);
     
     printf("Starting Car PoC (Headless mode)\n");
-    printf("Scenario file: %s\n", scenario_file);
+    if (generator_desc != NULL) {
+        printf("Scenario generator: %s\n", generator_desc);
+    } else {
+        printf("Scenario file: %s\n", scenario_file);
+    }
     
     platform_init();
     
-    if (!scenario_init(scenario_file)) {
+    if (generator_desc != NULL) {
+        if (!scenario_init_generated(generator_desc)) {
+            fprintf(stderr, "Invalid generator description: %s\n", generator_desc);
+            return 1;
+        }
+    } else if (stream_scenario ? !scenario_init_streaming(scenario_file, direct_io)
+                               : !scenario_init(scenario_file)) {
         fprintf(stderr, "Failed to open scenario file: %s\n", scenario_file);
         return 1;
+    } else {
     }
     
     init_all_modules();
-    
-    last_tick_time = hal_now_ms();
-    
-    while (running) {
-        current_time = hal_now_ms();
-        elapsed_time = current_time - last_tick_time;
-        
-        if (elapsed_time >= TICK_MS) {
-            tick_10ms();
-            last_tick_time = current_time;
-        }
-        
-        platform_sleep_ms(1U);
+    hal_mock_set_interpolation(interpolate_rows);
+    hal_mock_set_outputs_path(outputs_path);
+    
+    if (fast_replay) {
+        tick_count = run_fast();
+        stop_trace();
+        printf("Simulated clock: %u ticks replayed\n", tick_count);
+    } else {
+        run_realtime();
     }
     
     scenario_close();
     hal_mock_cleanup();
+    PROF_REPORT(stdout);
     
     printf("Car PoC simulation completed\n");
     return 0;
@@ -107,9 +214,7 @@ int main(int argc, char* argv[]) {
 #else
 
 int main(int argc, char* argv[]) {
-    uint32_t last_tick_time = 0U;
-    uint32_t current_time = 0U;
-    uint32_t elapsed_time = 0U;
+    platform_timer_t tick_timer;
     
     parse_arguments(argc, argv);
     
@@ -128,22 +233,17 @@ int main(int argc, char* argv[]) {
     
     init_all_modules();
     
-    last_tick_time = hal_now_ms();
+    platform_timer_start(&tick_timer, TICK_MS);
     
     while (running) {
+        platform_timer_wait(&tick_timer);
         hal_sdl_step();
-        
-        current_time = hal_now_ms();
-        elapsed_time = current_time - last_tick_time;
-        
-        if (elapsed_time >= TICK_MS) {
-            tick_10ms();
-            last_tick_time = current_time;
-        }
-        
-        platform_sdl_sleep(5U);
+        tick_10ms();
     }
     
+    stop_trace();
+    platform_timer_print_stats(&tick_timer, stdout);
+    PROF_REPORT(stdout);
     hal_sdl_cleanup();
     platform_sdl_quit();
     
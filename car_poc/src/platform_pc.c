@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include "platform.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,11 +8,13 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
-#include <sys/time.h>
+#include <errno.h>
 #include <unistd.h>
 #endif
 
-static uint32_t start_time_ms = 0U;
+static uint64_t start_time_us = 0U;
+static bool sim_clock_enabled = false;
+static uint64_t sim_time_us = 0U;
 
 void platform_assert(bool cond) {
     if (!cond) {
@@ -19,24 +23,96 @@ void platform_assert(bool cond) {
     }
 }
 
-uint32_t platform_get_time_ms(void) {
+/* CLOCK_MONOTONIC never steps when NTP or the user adjusts the wall clock,
+ * and it is the clock clock_nanosleep() measures deadlines against. */
+static uint64_t read_monotonic_us(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    (void)QueryPerformanceFrequency(&freq);
+    (void)QueryPerformanceCounter(&count);
+    return (((uint64_t)count.QuadPart / (uint64_t)freq.QuadPart) * 1000000U) +
+           ((((uint64_t)count.QuadPart % (uint64_t)freq.QuadPart) * 1000000U) /
+            (uint64_t)freq.QuadPart);
+#else
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+#endif
+}
+
+uint64_t platform_get_time_ns(void) {
 #ifdef _WIN32
-    return (uint32_t)GetTickCount();
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    (void)QueryPerformanceFrequency(&freq);
+    (void)QueryPerformanceCounter(&count);
+    return (((uint64_t)count.QuadPart / (uint64_t)freq.QuadPart) * 1000000000U) +
+           ((((uint64_t)count.QuadPart % (uint64_t)freq.QuadPart) * 1000000000U) /
+            (uint64_t)freq.QuadPart);
 #else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint32_t)((tv.tv_sec * 1000U) + (tv.tv_usec / 1000U));
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
 #endif
 }
 
+uint64_t platform_get_time_us(void) {
+    if (sim_clock_enabled) {
+        return sim_time_us;
+    }
+    
+    return read_monotonic_us() - start_time_us;
+}
+
+uint32_t platform_get_time_ms(void) {
+    return (uint32_t)(platform_get_time_us() / 1000U);
+}
+
 void platform_init(void) {
-    start_time_ms = platform_get_time_ms();
+    start_time_us = read_monotonic_us();
+}
+
+/* Simulated clock: time only moves when the scheduler advances it, so a
+ * replay runs as fast as the CPU allows and is repeatable run to run. */
+void platform_use_sim_clock(bool enable) {
+    sim_clock_enabled = enable;
+    sim_time_us = 0U;
+}
+
+void platform_set_sim_time_ms(uint32_t now_ms) {
+    sim_time_us = (uint64_t)now_ms * 1000U;
 }
 
 void platform_sleep_ms(uint32_t ms) {
 #ifdef _WIN32
     Sleep(ms);
 #else
-    usleep(ms * 1000U);
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ms / 1000U);
+    ts.tv_nsec = (long)((ms % 1000U) * 1000000U);
+    (void)nanosleep(&ts, NULL);
 #endif
-}
\ No newline at end of file
+}
+
+void platform_timer_start(platform_timer_t* timer, uint32_t period_ms) {
+    platform_timer_reset(timer, period_ms, read_monotonic_us());
+}
+
+void platform_timer_wait(platform_timer_t* timer) {
+#ifdef _WIN32
+    uint64_t now_us = read_monotonic_us();
+    
+    if (timer->next_deadline_us > now_us) {
+        Sleep((DWORD)((timer->next_deadline_us - now_us) / 1000U));
+    }
+#else
+    struct timespec deadline;
+    
+    deadline.tv_sec = (time_t)(timer->next_deadline_us / 1000000U);
+    deadline.tv_nsec = (long)((timer->next_deadline_us % 1000000U) * 1000U);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+#endif
+    platform_timer_record(timer, read_monotonic_us());
+}
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 
 static bool sdl_initialized = false;
+static uint64_t start_time_us = 0U;
 
 void platform_assert(bool cond) {
     if (!cond) {
@@ -14,12 +15,20 @@ void platform_assert(bool cond) {
     }
 }
 
+static uint64_t read_counter_us(void) {
+    uint64_t count = SDL_GetPerformanceCounter();
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    
+    return ((count / freq) * 1000000U) + (((count % freq) * 1000000U) / freq);
+}
+
 bool platform_sdl_init(void) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
         fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
         return false;
     }
     sdl_initialized = true;
+    start_time_us = read_counter_us();
     return true;
 }
 
@@ -30,8 +39,41 @@ void platform_sdl_quit(void) {
     }
 }
 
+uint64_t platform_get_time_ns(void) {
+    uint64_t count = SDL_GetPerformanceCounter();
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    
+    return ((count / freq) * 1000000000U) + (((count % freq) * 1000000000U) / freq);
+}
+
+uint64_t platform_get_time_us(void) {
+    return read_counter_us() - start_time_us;
+}
+
 uint32_t platform_get_time_ms(void) {
-    return SDL_GetTicks();
+    return (uint32_t)(platform_get_time_us() / 1000U);
+}
+
+void platform_timer_start(platform_timer_t* timer, uint32_t period_ms) {
+    platform_timer_reset(timer, period_ms, read_counter_us());
+}
+
+/* SDL_Delay only has millisecond granularity, so sleep to just short of
+ * the deadline and spin the remainder on the performance counter. */
+void platform_timer_wait(platform_timer_t* timer) {
+    uint64_t now_us = read_counter_us();
+    
+    if ((timer->next_deadline_us > now_us) &&
+        ((timer->next_deadline_us - now_us) > 1000U)) {
+        SDL_Delay((Uint32)(((timer->next_deadline_us - now_us) / 1000U) - 1U));
+    }
+    
+    now_us = read_counter_us();
+    while (now_us < timer->next_deadline_us) {
+        now_us = read_counter_us();
+    }
+    
+    platform_timer_record(timer, now_us);
 }
 
 void platform_sdl_sleep(uint32_t ms) {
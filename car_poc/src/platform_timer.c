@@ -0,0 +1,79 @@
+#include "platform.h"
+#include <string.h>
+
+/* Upper bounds of the lateness buckets in microseconds; the last bucket
+ * collects everything at or above one full period. */
+static const uint32_t late_bucket_us[PLATFORM_TIMER_BUCKETS - 1U] = {
+    10U, 50U, 100U, 250U, 500U, 1000U, 2000U, 5000U, 10000U
+};
+
+static uint32_t late_bucket(uint64_t late_us) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < (PLATFORM_TIMER_BUCKETS - 1U); i++) {
+        if (late_us < late_bucket_us[i]) {
+            return i;
+        }
+    }
+    
+    return PLATFORM_TIMER_BUCKETS - 1U;
+}
+
+/* Called by the platform's platform_timer_wait() once it has woken up for
+ * next_deadline_us. Advances the deadline by exactly one period; when the
+ * host fell more than PLATFORM_TIMER_MAX_CATCHUP periods behind, the
+ * schedule restarts from now instead of bursting through the backlog. */
+void platform_timer_record(platform_timer_t* timer, uint64_t now_us) {
+    uint64_t late_us = 0U;
+    
+    if (now_us > timer->next_deadline_us) {
+        late_us = now_us - timer->next_deadline_us;
+    }
+    
+    timer->ticks++;
+    timer->late_sum_us += late_us;
+    if (late_us > timer->late_max_us) {
+        timer->late_max_us = late_us;
+    }
+    timer->late_hist[late_bucket(late_us)]++;
+    
+    if (late_us >= timer->period_us) {
+        timer->overruns++;
+    }
+    
+    if (late_us >= (timer->period_us * PLATFORM_TIMER_MAX_CATCHUP)) {
+        timer->next_deadline_us = now_us + timer->period_us;
+        timer->resyncs++;
+    } else {
+        timer->next_deadline_us += timer->period_us;
+    }
+}
+
+void platform_timer_print_stats(const platform_timer_t* timer, FILE* file) {
+    uint32_t i = 0U;
+    uint64_t mean_us = 0U;
+    
+    if (timer->ticks > 0U) {
+        mean_us = timer->late_sum_us / timer->ticks;
+    }
+    
+    fprintf(file, "Tick timer: %u ticks, period %lluus, %u overruns, %u resyncs\n",
+            timer->ticks, (unsigned long long)timer->period_us,
+            timer->overruns, timer->resyncs);
+    fprintf(file, "Tick lateness: mean %lluus, max %lluus\n",
+            (unsigned long long)mean_us, (unsigned long long)timer->late_max_us);
+    
+    for (i = 0U; i < PLATFORM_TIMER_BUCKETS; i++) {
+        if (i < (PLATFORM_TIMER_BUCKETS - 1U)) {
+            fprintf(file, "  < %6uus: %u\n", late_bucket_us[i], timer->late_hist[i]);
+        } else {
+            fprintf(file, "  >= %5uus: %u\n", late_bucket_us[i - 1U], timer->late_hist[i]);
+        }
+    }
+}
+
+void platform_timer_reset(platform_timer_t* timer, uint32_t period_ms, uint64_t now_us) {
+    memset(timer, 0, sizeof(platform_timer_t));
+    timer->period_us = (uint64_t)period_ms * 1000U;
+    timer->next_deadline_us = now_us + timer->period_us;
+}
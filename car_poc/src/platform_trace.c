@@ -0,0 +1,47 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "platform.h"
+#include <pthread.h>
+#include <time.h>
+
+#define TRACE_DRAIN_POLL_NS (1000000L)
+
+static trace_log_t* drain_log = NULL;
+static FILE* drain_file = NULL;
+static pthread_t drain_thread;
+static bool drain_started = false;
+static bool drain_stop = false;
+
+static void* drain_main(void* arg) {
+    struct timespec ts = {0, TRACE_DRAIN_POLL_NS};
+    
+    (void)arg;
+    while (!__atomic_load_n(&drain_stop, __ATOMIC_RELAXED)) {
+        (void)trace_log_drain(drain_log, drain_file);
+        (void)nanosleep(&ts, NULL);
+    }
+    
+    return NULL;
+}
+
+bool platform_trace_start(trace_log_t* log, FILE* file) {
+    drain_log = log;
+    drain_file = file;
+    __atomic_store_n(&drain_stop, false, __ATOMIC_RELAXED);
+    drain_started = pthread_create(&drain_thread, NULL, drain_main, NULL) == 0;
+    return drain_started;
+}
+
+void platform_trace_stop(void) {
+    if (drain_log == NULL) {
+        return;
+    }
+    
+    if (drain_started) {
+        __atomic_store_n(&drain_stop, true, __ATOMIC_RELAXED);
+        (void)pthread_join(drain_thread, NULL);
+        drain_started = false;
+    }
+    (void)trace_log_drain(drain_log, drain_file);
+    drain_log = NULL;
+}
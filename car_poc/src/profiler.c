@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "profiler.h"
+#include <signal.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t buckets[PROF_NUM_BUCKETS];
+} prof_slot_t;
+
+static prof_slot_t slots[SCHED_NUM_SLOTS];
+static volatile sig_atomic_t report_requested = 0;
+
+static uint32_t bucket_index(uint64_t ns) {
+    uint32_t msb = 0U;
+    uint64_t v = ns;
+    
+    if (ns < PROF_SUB_BUCKETS) {
+        return (uint32_t)ns;
+    }
+    
+    while (v > 1U) {
+        v >>= 1U;
+        msb++;
+    }
+    
+    return (msb * PROF_SUB_BUCKETS) +
+           (uint32_t)((ns >> (msb - PROF_SUB_BITS)) & (PROF_SUB_BUCKETS - 1U));
+}
+
+/* Largest value that falls into bucket `index`. */
+static uint64_t bucket_upper_ns(uint32_t index) {
+    uint32_t msb = index / PROF_SUB_BUCKETS;
+    uint64_t sub = (uint64_t)(index % PROF_SUB_BUCKETS);
+    
+    if (msb < PROF_SUB_BITS) {
+        return (uint64_t)index;
+    }
+    
+    return ((((uint64_t)PROF_SUB_BUCKETS + sub + 1U) << (msb - PROF_SUB_BITS)) - 1U);
+}
+
+static uint64_t slot_percentile_ns(const prof_slot_t* slot, uint32_t basis_points) {
+    uint64_t target = ((slot->count * basis_points) + 9999U) / 10000U;
+    uint64_t seen = 0U;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < PROF_NUM_BUCKETS; i++) {
+        seen += slot->buckets[i];
+        if ((seen >= target) && (seen > 0U)) {
+            return (bucket_upper_ns(i) < slot->max_ns) ? bucket_upper_ns(i) : slot->max_ns;
+        }
+    }
+    
+    return slot->max_ns;
+}
+
+static void on_report_signal(int sig) {
+    (void)sig;
+    report_requested = 1;
+}
+
+void prof_init(void) {
+    memset(slots, 0, sizeof(slots));
+#ifdef SIGUSR1
+    (void)signal(SIGUSR1, on_report_signal);
+#endif
+}
+
+void prof_record(sched_id_e id, uint64_t elapsed_ns) {
+    prof_slot_t* slot = &slots[id];
+    
+    slot->count++;
+    slot->total_ns += elapsed_ns;
+    if (elapsed_ns > slot->max_ns) {
+        slot->max_ns = elapsed_ns;
+    }
+    slot->buckets[bucket_index(elapsed_ns)]++;
+}
+
+uint64_t prof_percentile_ns(sched_id_e id, uint32_t basis_points) {
+    return slot_percentile_ns(&slots[id], basis_points);
+}
+
+uint64_t prof_max_ns(sched_id_e id) {
+    return slots[id].max_ns;
+}
+
+void prof_report(FILE* file) {
+    uint32_t i = 0U;
+    
+    fprintf(file, "%-10s %9s %9s %9s %9s %9s %9s %8s\n",
+            "step", "calls", "mean_ns", "p50_ns", "p99_ns", "p99.9_ns", "max_ns", "budget");
+    
+    for (i = 0U; i < (uint32_t)SCHED_NUM_SLOTS; i++) {
+        const prof_slot_t* slot = &slots[i];
+        const sched_slot_t* cfg = sched_slot((sched_id_e)i);
+        uint64_t budget_ns = (uint64_t)cfg->budget_us * 1000U;
+        
+        if (slot->count == 0U) {
+            fprintf(file, "%-10s %9u\n", cfg->name, 0U);
+        } else {
+            fprintf(file, "%-10s %9llu %9llu %9llu %9llu %9llu %9llu %8s\n",
+                    cfg->name,
+                    (unsigned long long)slot->count,
+                    (unsigned long long)(slot->total_ns / slot->count),
+                    (unsigned long long)slot_percentile_ns(slot, 5000U),
+                    (unsigned long long)slot_percentile_ns(slot, 9900U),
+                    (unsigned long long)slot_percentile_ns(slot, 9990U),
+                    (unsigned long long)slot->max_ns,
+                    (slot->max_ns > budget_ns) ? "OVER" : "ok");
+        }
+    }
+}
+
+/* Reports requested with SIGUSR1 are printed from the tick loop, never from
+ * the handler itself. */
+void prof_poll_signal(void) {
+    if (report_requested != 0) {
+        report_requested = 0;
+        prof_report(stdout);
+        fflush(stdout);
+    }
+}
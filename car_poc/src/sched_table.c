@@ -0,0 +1,141 @@
+#include "sched_table.h"
+
+/* The release mask of every minor frame is a constant expression over
+ * SCHED_TABLE, so the cyclic executive is fixed at compile time and the
+ * run-time cost per frame is one table load plus the released steps. */
+
+#define SCHED_RELEASED(f, period_ms, phase_ms) \
+    ((((uint32_t)(f) * SCHED_MINOR_FRAME_MS) % (period_ms)) == (phase_ms))
+
+#define SCHED_MASK_TERM(f, name, period_ms, phase_ms, priority, budget_us) \
+    | (SCHED_RELEASED(f, period_ms, phase_ms) ? (1U << (priority)) : 0U)
+#define SCHED_LOAD_TERM(f, name, period_ms, phase_ms, priority, budget_us) \
+    + (SCHED_RELEASED(f, period_ms, phase_ms) ? (budget_us) : 0U)
+#define SCHED_PRIO_TERM(a, name, period_ms, phase_ms, priority, budget_us) \
+    | (1U << (priority))
+#define SCHED_SLOT_ENTRY(a, name, period_ms, phase_ms, priority, budget_us) \
+    {#name, (period_ms), (phase_ms), (priority), (budget_us)},
+#define SCHED_BY_PRIO_ENTRY(a, name, period_ms, phase_ms, priority, budget_us) \
+    [(priority)] = SCHED_ID_##name,
+#define SCHED_SLOT_CHECK(a, name, period_ms, phase_ms, priority, budget_us) \
+    typedef char sched_##name##_slot_invalid[ \
+        ((((period_ms) % SCHED_MINOR_FRAME_MS) == 0U) && \
+         ((SCHED_MAJOR_FRAME_MS % (period_ms)) == 0U) && \
+         (((phase_ms) % SCHED_MINOR_FRAME_MS) == 0U) && \
+         ((phase_ms) < (period_ms)) && \
+         ((priority) < SCHED_NUM_SLOTS)) ? 1 : -1];
+
+#define SCHED_FRAME_MASK(f)  (0U SCHED_TABLE(SCHED_MASK_TERM, f))
+#define SCHED_FRAME_LOAD(f)  (0U SCHED_TABLE(SCHED_LOAD_TERM, f))
+#define SCHED_MASK_ELEM(f)   SCHED_FRAME_MASK(f),
+#define SCHED_BUDGET_CHECK(f) \
+    typedef char sched_frame_##f##_over_budget[ \
+        (SCHED_FRAME_LOAD(f) <= (SCHED_MINOR_FRAME_MS * 1000U)) ? 1 : -1];
+
+#define SCHED_REP10(M, d) M(d##0) M(d##1) M(d##2) M(d##3) M(d##4) \
+                          M(d##5) M(d##6) M(d##7) M(d##8) M(d##9)
+#define SCHED_REP100(M) SCHED_REP10(M, ) SCHED_REP10(M, 1) SCHED_REP10(M, 2) \
+                        SCHED_REP10(M, 3) SCHED_REP10(M, 4) SCHED_REP10(M, 5) \
+                        SCHED_REP10(M, 6) SCHED_REP10(M, 7) SCHED_REP10(M, 8) \
+                        SCHED_REP10(M, 9)
+
+SCHED_TABLE(SCHED_SLOT_CHECK, 0)
+SCHED_REP100(SCHED_BUDGET_CHECK)
+
+typedef char sched_priorities_not_unique[
+    ((0U SCHED_TABLE(SCHED_PRIO_TERM, 0)) == ((1U << SCHED_NUM_SLOTS) - 1U)) ? 1 : -1];
+typedef char sched_major_frame_too_long[
+    ((SCHED_MAJOR_FRAME_MS % SCHED_MINOR_FRAME_MS) == 0U) &&
+    (SCHED_MAJOR_FRAMES <= SCHED_MAX_FRAMES) ? 1 : -1];
+
+static const sched_slot_t slots[SCHED_NUM_SLOTS] = {
+    SCHED_TABLE(SCHED_SLOT_ENTRY, 0)
+};
+
+static const sched_id_e slot_by_priority[SCHED_NUM_SLOTS] = {
+    SCHED_TABLE(SCHED_BY_PRIO_ENTRY, 0)
+};
+
+static const uint8_t frame_masks[SCHED_MAX_FRAMES] = {
+    SCHED_REP100(SCHED_MASK_ELEM)
+};
+
+void sched_run_frame(uint32_t frame, sched_dispatch_fn dispatch, void* arg) {
+    uint32_t mask = sched_frame_mask(frame);
+    uint32_t priority = 0U;
+    
+    while (mask != 0U) {
+        if ((mask & 1U) != 0U) {
+            dispatch(slot_by_priority[priority], arg);
+        }
+        mask >>= 1U;
+        priority++;
+    }
+}
+
+uint32_t sched_next_frame(uint32_t frame) {
+    return ((frame + 1U) < SCHED_MAJOR_FRAMES) ? (frame + 1U) : 0U;
+}
+
+uint32_t sched_frame_mask(uint32_t frame) {
+    return frame_masks[frame % SCHED_MAJOR_FRAMES];
+}
+
+const sched_slot_t* sched_slot(sched_id_e id) {
+    if ((uint32_t)id >= (uint32_t)SCHED_NUM_SLOTS) {
+        return NULL;
+    }
+    
+    return &slots[id];
+}
+
+static uint32_t frame_load_us(uint32_t frame) {
+    uint32_t mask = sched_frame_mask(frame);
+    uint32_t load_us = 0U;
+    uint32_t priority = 0U;
+    
+    for (priority = 0U; priority < (uint32_t)SCHED_NUM_SLOTS; priority++) {
+        if ((mask & (1U << priority)) != 0U) {
+            load_us += slots[slot_by_priority[priority]].budget_us;
+        }
+    }
+    
+    return load_us;
+}
+
+void sched_print_table(FILE* file) {
+    uint32_t i = 0U;
+    uint32_t frame = 0U;
+    uint32_t calls = 0U;
+    uint32_t peak_us = 0U;
+    uint32_t peak_frame = 0U;
+    uint32_t load_us = 0U;
+    
+    fprintf(file, "minor frame %u ms, major frame %u ms (%u frames)\n",
+            SCHED_MINOR_FRAME_MS, SCHED_MAJOR_FRAME_MS, SCHED_MAJOR_FRAMES);
+    fprintf(file, "%-10s %6s %6s %4s %7s %8s\n",
+            "slot", "period", "phase", "prio", "budget", "util");
+    
+    for (i = 0U; i < (uint32_t)SCHED_NUM_SLOTS; i++) {
+        const sched_slot_t* slot = &slots[i];
+        uint32_t util_x100 = (slot->budget_us * 10U) / slot->period_ms;
+        
+        fprintf(file, "%-10s %6u %6u %4u %5uus %4u.%02u%%\n",
+                slot->name, slot->period_ms, slot->phase_ms, slot->priority,
+                slot->budget_us, util_x100 / 100U, util_x100 % 100U);
+        calls += SCHED_MAJOR_FRAME_MS / slot->period_ms;
+    }
+    
+    for (frame = 0U; frame < SCHED_MAJOR_FRAMES; frame++) {
+        load_us = frame_load_us(frame);
+        if (load_us > peak_us) {
+            peak_us = load_us;
+            peak_frame = frame;
+        }
+    }
+    
+    fprintf(file, "step calls per major frame: %u (flat list: %u)\n",
+            calls, (uint32_t)SCHED_NUM_SLOTS * SCHED_MAJOR_FRAMES);
+    fprintf(file, "peak frame load: %uus of %uus in frame %u\n",
+            peak_us, SCHED_MINOR_FRAME_MS * 1000U, peak_frame);
+}
@@ -0,0 +1,170 @@
+#include "trace_log.h"
+#include <string.h>
+
+#define TRACE_FORMAT_ENTRY(name, format) format,
+
+static const char* const trace_formats[TRACE_NUM_IDS] = {
+    TRACE_MESSAGES(TRACE_FORMAT_ENTRY)
+};
+
+static trace_log_t default_log;
+
+void trace_log_init(trace_log_t* log) {
+    spsc_ring_init(&log->ring, TRACE_LOG_SLOTS);
+    log->open_entry = NULL;
+    log->dropped = 0U;
+}
+
+trace_log_t* trace_log_default(void) {
+    return &default_log;
+}
+
+bool trace_log_begin(trace_log_t* log, trace_id_e id) {
+    uint32_t slot = 0U;
+    
+    if (log == NULL) {
+        return false;
+    }
+    if (!spsc_ring_acquire(&log->ring, &slot)) {
+        log->dropped++;
+        return false;
+    }
+    
+    log->open_entry = &log->entries[slot];
+    log->open_entry->id = (uint16_t)id;
+    log->open_entry->len = 0U;
+    return true;
+}
+
+/* Arguments that no longer fit are left out; formatting stops there. */
+static void put_number(trace_log_t* log, const void* value) {
+    trace_entry_t* entry = log->open_entry;
+    
+    if ((entry->len + 4U) <= TRACE_LOG_ARG_BYTES) {
+        memcpy(&entry->args[entry->len], value, 4U);
+        entry->len = (uint16_t)(entry->len + 4U);
+    }
+}
+
+void trace_log_u32(trace_log_t* log, uint32_t value) {
+    put_number(log, &value);
+}
+
+void trace_log_i32(trace_log_t* log, int32_t value) {
+    put_number(log, &value);
+}
+
+/* Stored as a length byte followed by the characters. Copying while
+ * looking for the terminator is cheaper than strlen() plus memcpy() for
+ * strings this short. */
+void trace_log_str(trace_log_t* log, const char* text) {
+    trace_entry_t* entry = log->open_entry;
+    uint32_t room = TRACE_LOG_ARG_BYTES - (uint32_t)entry->len;
+    uint8_t* dst = NULL;
+    uint32_t len = 0U;
+    
+    if (room == 0U) {
+        return;
+    }
+    room = ((room - 1U) > UINT8_MAX) ? UINT8_MAX : (room - 1U);
+    
+    dst = &entry->args[entry->len + 1U];
+    while ((len < room) && (text[len] != '\0')) {
+        dst[len] = (uint8_t)text[len];
+        len++;
+    }
+    entry->args[entry->len] = (uint8_t)len;
+    entry->len = (uint16_t)(entry->len + 1U + len);
+}
+
+void trace_log_commit(trace_log_t* log) {
+    log->open_entry = NULL;
+    spsc_ring_publish(&log->ring);
+}
+
+/* Formats the argument at *pos for conversion `conv` into `text` and
+ * returns the snprintf() length, or -1 when the entry has no more
+ * arguments. */
+static int format_arg(const trace_entry_t* entry, uint32_t* pos, char conv, char* text,
+                      size_t size) {
+    uint32_t u = 0U;
+    int32_t d = 0;
+    uint32_t len = 0U;
+    
+    if (conv == 's') {
+        if (*pos >= entry->len) {
+            return -1;
+        }
+        len = entry->args[*pos];
+        if ((*pos + 1U + len) > entry->len) {
+            return -1;
+        }
+        *pos += 1U + len;
+        return snprintf(text, size, "%.*s", (int)len, (const char*)&entry->args[*pos - len]);
+    }
+    
+    if ((*pos + 4U) > entry->len) {
+        return -1;
+    }
+    if (conv == 'd') {
+        memcpy(&d, &entry->args[*pos], 4U);
+        *pos += 4U;
+        return snprintf(text, size, "%d", d);
+    }
+    memcpy(&u, &entry->args[*pos], 4U);
+    *pos += 4U;
+    return (conv == 'x') ? snprintf(text, size, "%x", u) : snprintf(text, size, "%u", u);
+}
+
+uint32_t trace_log_format(const trace_entry_t* entry, char* text, uint32_t size) {
+    const char* f = "<unknown trace message>\n";
+    uint32_t pos = 0U;
+    uint32_t out = 0U;
+    int written = 0;
+    
+    if (size == 0U) {
+        return 0U;
+    }
+    if (entry->id < (uint16_t)TRACE_NUM_IDS) {
+        f = trace_formats[entry->id];
+    }
+    
+    while ((*f != '\0') && ((out + 1U) < size) && (written >= 0)) {
+        if ((f[0] == '%') && ((f[1] == 's') || (f[1] == 'u') || (f[1] == 'd') ||
+                              (f[1] == 'x'))) {
+            written = format_arg(entry, &pos, f[1], &text[out], size - out);
+            if (written > 0) {
+                out += (uint32_t)written;
+                out = (out >= size) ? (size - 1U) : out;
+            }
+            f += 2;
+        } else if ((f[0] == '%') && (f[1] == '%')) {
+            text[out] = '%';
+            out++;
+            f += 2;
+        } else {
+            text[out] = *f;
+            out++;
+            f++;
+        }
+    }
+    
+    text[out] = '\0';
+    return out;
+}
+
+uint32_t trace_log_drain(trace_log_t* log, FILE* file) {
+    char text[TRACE_LOG_TEXT_MAX];
+    uint32_t slot = 0U;
+    uint32_t count = 0U;
+    uint32_t len = 0U;
+    
+    while (spsc_ring_peek(&log->ring, &slot)) {
+        len = trace_log_format(&log->entries[slot], text, TRACE_LOG_TEXT_MAX);
+        (void)fwrite(text, 1U, len, file);
+        spsc_ring_release(&log->ring);
+        count++;
+    }
+    
+    return count;
+}
@@ -0,0 +1,36 @@
+#include "vehicle.h"
+#include <string.h>
+
+#define VEHICLE_DISPATCH_CASE(a, name, period_ms, phase_ms, priority, budget_us) \
+    case SCHED_ID_##name: \
+        app_##name##_step_ctx(&(a)->name, &(a)->io); \
+        break;
+
+static void dispatch_slot(sched_id_e id, void* arg) {
+    vehicle_t* vehicle = (vehicle_t*)arg;
+    
+    switch (id) {
+        SCHED_TABLE(VEHICLE_DISPATCH_CASE, vehicle)
+        default:
+            break;
+    }
+}
+
+void vehicle_init(vehicle_t* vehicle) {
+    memset(vehicle, 0, sizeof(vehicle_t));
+    
+    app_autobrake_init_ctx(&vehicle->autobrake);
+    app_wipers_init_ctx(&vehicle->wipers);
+    app_speedgov_init_ctx(&vehicle->speedgov);
+    app_autopark_init_ctx(&vehicle->autopark);
+    app_climate_init_ctx(&vehicle->climate);
+    app_voice_init_ctx(&vehicle->voice);
+    
+    vehicle->io.in.vehicle_ready = true;
+    vehicle->io.out.blend_pct = vehicle->climate.current_blend_pct;
+}
+
+void vehicle_step(vehicle_t* vehicle) {
+    sched_run_frame(vehicle->frame, dispatch_slot, vehicle);
+    vehicle->frame = sched_next_frame(vehicle->frame);
+}
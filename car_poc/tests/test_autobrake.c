@@ -1,4 +1,5 @@
 #include "unity.h"
+#include <string.h>
 #include "app_autobrake.h"
 
 static uint16_t mock_distance_mm = 2000U;
@@ -20,10 +21,19 @@ uint32_t hal_now_ms(void) {
     return mock_current_time;
 }
 
-bool hal_read_distance_mm(uint16_t* out_mm, uint32_t* out_ts_ms) {
-    if ((out_mm != NULL) && (out_ts_ms != NULL)) {
-        *out_mm = mock_distance_mm;
-        *out_ts_ms = mock_timestamp_ms;
+uint16_t hal_read_distance_array(distance_array_t* out) {
+    if (out != NULL) {
+        out->mm[HAL_DISTANCE_FORWARD_SECTOR] = mock_distance_mm;
+        out->ts_ms[HAL_DISTANCE_FORWARD_SECTOR] = mock_timestamp_ms;
+        return (uint16_t)(1U << HAL_DISTANCE_FORWARD_SECTOR);
+    }
+    return 0U;
+}
+
+bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms) {
+    if ((out_kph != NULL) && (out_ts_ms != NULL)) {
+        *out_kph = 50U;
+        *out_ts_ms = mock_current_time;
         return true;
     }
     return false;
@@ -46,6 +56,20 @@ void setUp(void) {
 void tearDown(void) {
 }
 
+#define FWD HAL_DISTANCE_FORWARD_SECTOR
+
+static void set_sector(hal_io_t* io, uint32_t sector, uint16_t mm, uint32_t ts_ms) {
+    io->in.distance_valid = (uint16_t)(io->in.distance_valid | (1U << sector));
+    io->in.distance.mm[sector] = mm;
+    io->in.distance.ts_ms[sector] = ts_ms;
+}
+
+static void init_io(hal_io_t* io, uint32_t now_ms) {
+    memset(io, 0, sizeof(hal_io_t));
+    io->in.now_ms = now_ms;
+    io->in.vehicle_ready = true;
+}
+
 void test_autobrake_no_brake_when_distance_safe(void) {
     mock_distance_mm = 2000U;
     mock_timestamp_ms = 50U;
@@ -79,6 +103,7 @@ void test_autobrake_no_brake_when_driver_override(void) {
 }
 
 void test_autobrake_debounce_before_activation(void) {
+    setUp();
     mock_distance_mm = 1000U;
     mock_timestamp_ms = 50U;
     mock_current_time = 100U;
@@ -103,6 +128,199 @@ void test_autobrake_stale_sensor_data(void) {
     TEST_ASSERT_FALSE(mock_brake_request);
 }
 
+void test_autobrake_instances_are_independent(void) {
+    autobrake_state_t car_a;
+    autobrake_state_t car_b;
+    hal_io_t io_a;
+    hal_io_t io_b;
+    uint8_t i = 0U;
+    
+    app_autobrake_init_ctx(&car_a);
+    app_autobrake_init_ctx(&car_b);
+    init_io(&io_a, 100U);
+    init_io(&io_b, 100U);
+    set_sector(&io_a, FWD, 1000U, 50U);
+    set_sector(&io_b, FWD, 2000U, 50U);
+    
+    for (i = 0U; i < 3U; i++) {
+        app_autobrake_step_ctx(&car_a, &io_a);
+        app_autobrake_step_ctx(&car_b, &io_b);
+    }
+    
+    TEST_ASSERT_TRUE(io_a.out.brake_request);
+    TEST_ASSERT_FALSE(io_b.out.brake_request);
+}
+
+/* Drives one instance at 10 ms ticks towards an obstacle starting at
+ * start_mm that closes at closing_mm_s, with own speed speed_kph. Returns
+ * the distance at which the brake request first came on, or 0. */
+static uint16_t approach(uint16_t start_mm, uint32_t closing_mm_s, uint16_t speed_kph) {
+    autobrake_state_t car;
+    hal_io_t io;
+    uint32_t t = 0U;
+    uint32_t travelled = 0U;
+    
+    app_autobrake_init_ctx(&car);
+    init_io(&io, 0U);
+    io.in.speed_valid = true;
+    io.in.speed_kph = speed_kph;
+    
+    for (t = 1000U; t < 11000U; t += 10U) {
+        travelled = ((t - 1000U) * closing_mm_s) / 1000U;
+        if (travelled >= start_mm) {
+            break;
+        }
+        io.in.now_ms = t;
+        io.in.speed_ts_ms = t;
+        set_sector(&io, FWD, (uint16_t)(start_mm - travelled), t);
+        app_autobrake_step_ctx(&car, &io);
+        if (io.out.brake_request) {
+            return io.in.distance.mm[FWD];
+        }
+    }
+    
+    return 0U;
+}
+
+/* 50 km/h straight at a stopped car: about 13.9 m/s, so the one-second
+ * horizon fires well outside the fixed threshold. */
+void test_autobrake_ttc_brakes_before_threshold_on_fast_closure(void) {
+    uint16_t at_mm = approach(30000U, 13889U, 50U);
+    
+    TEST_ASSERT_TRUE(at_mm > AB_THRESHOLD_MM);
+    TEST_ASSERT_TRUE(at_mm <= 13889U);
+}
+
+void test_autobrake_ttc_ignores_steady_obstacle(void) {
+    autobrake_state_t car;
+    hal_io_t io;
+    uint32_t t = 0U;
+    
+    app_autobrake_init_ctx(&car);
+    init_io(&io, 0U);
+    io.in.speed_valid = true;
+    io.in.speed_kph = 50U;
+    
+    for (t = 1000U; t < 3000U; t += 10U) {
+        io.in.now_ms = t;
+        io.in.speed_ts_ms = t;
+        set_sector(&io, FWD, 3000U, t);
+        app_autobrake_step_ctx(&car, &io);
+        TEST_ASSERT_FALSE(io.out.brake_request);
+    }
+}
+
+/* Below AB_TTC_MIN_SPEED_KPH only the threshold path brakes. */
+void test_autobrake_ttc_off_at_low_speed(void) {
+    uint16_t at_mm = approach(5000U, 2000U, 5U);
+    
+    TEST_ASSERT_TRUE(at_mm <= AB_THRESHOLD_MM);
+}
+
+/* A closing rate far above own speed is a measurement glitch, not a
+ * collision course: the threshold path still catches the obstacle. */
+void test_autobrake_ttc_rejects_implausible_rate(void) {
+    uint16_t at_mm = approach(30000U, 13889U, 12U);
+    
+    TEST_ASSERT_TRUE(at_mm <= AB_THRESHOLD_MM);
+}
+
+/* A target that appears much closer in one step restarts the fit instead
+ * of reading the jump as closing speed. */
+void test_autobrake_ttc_restarts_on_new_target(void) {
+    autobrake_ttc_t ttc;
+    uint32_t t = 0U;
+    
+    autobrake_ttc_reset(&ttc);
+    for (t = 1000U; t < 1100U; t += 10U) {
+        TEST_ASSERT_FALSE(autobrake_ttc_step(&ttc, 8000U, t, true, 50U));
+    }
+    TEST_ASSERT_FALSE(autobrake_ttc_step(&ttc, 3000U, t, true, 50U));
+    TEST_ASSERT_EQUAL_UINT8(1U, ttc.count);
+}
+
+/* The nearest sector in the corridor brakes, whichever one it is. */
+void test_autobrake_nearest_corridor_sector_brakes(void) {
+    autobrake_state_t car;
+    hal_io_t io;
+    uint8_t i = 0U;
+    
+    app_autobrake_init_ctx(&car);
+    init_io(&io, 100U);
+    set_sector(&io, 2U, 2500U, 100U);
+    set_sector(&io, FWD, 2000U, 100U);
+    set_sector(&io, 5U, 900U, 100U);
+    
+    for (i = 0U; i < AB_DEBOUNCE_HITS; i++) {
+        app_autobrake_step_ctx(&car, &io);
+    }
+    
+    TEST_ASSERT_TRUE(io.out.brake_request);
+    TEST_ASSERT_EQUAL_UINT16(AB_DEBOUNCE_HITS, car.hit_count[5]);
+    TEST_ASSERT_EQUAL_UINT16(0U, car.hit_count[FWD]);
+}
+
+void test_autobrake_ignores_sectors_outside_corridor(void) {
+    autobrake_state_t car;
+    hal_io_t io;
+    uint32_t s = 0U;
+    uint8_t i = 0U;
+    
+    app_autobrake_init_ctx(&car);
+    init_io(&io, 100U);
+    for (s = 0U; s < HAL_DISTANCE_SECTORS; s++) {
+        if (((AB_SECTOR_MASK >> s) & 1U) == 0U) {
+            set_sector(&io, s, 300U, 100U);
+        } else {
+            set_sector(&io, s, 4000U, 100U);
+        }
+    }
+    
+    for (i = 0U; i < 5U; i++) {
+        app_autobrake_step_ctx(&car, &io);
+    }
+    
+    TEST_ASSERT_FALSE(io.out.brake_request);
+}
+
+/* A stale sector drops out on its own; the others keep their counts. */
+void test_autobrake_stale_sector_is_masked(void) {
+    autobrake_state_t car;
+    hal_io_t io;
+    
+    app_autobrake_init_ctx(&car);
+    init_io(&io, 100U);
+    set_sector(&io, 2U, 1000U, 100U);
+    set_sector(&io, FWD, 1000U, 100U);
+    app_autobrake_step_ctx(&car, &io);
+    app_autobrake_step_ctx(&car, &io);
+    
+    io.in.now_ms = 250U;
+    io.in.distance.ts_ms[FWD] = 250U;
+    app_autobrake_step_ctx(&car, &io);
+    
+    TEST_ASSERT_EQUAL_UINT16(0U, car.hit_count[2]);
+    TEST_ASSERT_EQUAL_UINT16(AB_DEBOUNCE_HITS, car.hit_count[FWD]);
+    TEST_ASSERT_TRUE(io.out.brake_request);
+}
+
+/* Debouncing is per sector: a near reading hopping between sectors never
+ * builds up AB_DEBOUNCE_HITS anywhere. */
+void test_autobrake_debounce_is_per_sector(void) {
+    autobrake_state_t car;
+    hal_io_t io;
+    uint32_t t = 0U;
+    
+    app_autobrake_init_ctx(&car);
+    for (t = 0U; t < 6U; t++) {
+        init_io(&io, 100U + (t * 10U));
+        set_sector(&io, 2U + (t % 2U), 1000U, io.in.now_ms);
+        set_sector(&io, 3U - (t % 2U), 2000U, io.in.now_ms);
+        app_autobrake_step_ctx(&car, &io);
+        TEST_ASSERT_FALSE(io.out.brake_request);
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -111,6 +329,16 @@ int main(void) {
     RUN_TEST(test_autobrake_no_brake_when_driver_override);
     RUN_TEST(test_autobrake_debounce_before_activation);
     RUN_TEST(test_autobrake_stale_sensor_data);
+    RUN_TEST(test_autobrake_instances_are_independent);
+    RUN_TEST(test_autobrake_nearest_corridor_sector_brakes);
+    RUN_TEST(test_autobrake_ignores_sectors_outside_corridor);
+    RUN_TEST(test_autobrake_stale_sector_is_masked);
+    RUN_TEST(test_autobrake_debounce_is_per_sector);
+    RUN_TEST(test_autobrake_ttc_brakes_before_threshold_on_fast_closure);
+    RUN_TEST(test_autobrake_ttc_ignores_steady_obstacle);
+    RUN_TEST(test_autobrake_ttc_off_at_low_speed);
+    RUN_TEST(test_autobrake_ttc_rejects_implausible_rate);
+    RUN_TEST(test_autobrake_ttc_restarts_on_new_target);
     
     return UNITY_END();
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "unity.h"
+#include <string.h>
 #include "app_autopark.h"
+#include "calib.h"
+#include "sched_cfg.h"
+
+#define GAP_CONFIRM_STEPS \
+    ((PARK_GAP_CONFIRM_MS + SCHED_AUTOPARK_PERIOD_MS - 1U) / SCHED_AUTOPARK_PERIOD_MS)
 
 static bool mock_gap_found = false;
 static uint16_t mock_gap_width = 0U;
@@ -48,7 +54,16 @@ void setUp(void) {
 void tearDown(void) {
 }
 
+static void step_times(uint32_t count) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < count; i++) {
+        app_autopark_step();
+    }
+}
+
 void test_autopark_scanning_state(void) {
+    setUp();
     mock_gap_found = false;
     
     app_autopark_step();
@@ -56,18 +71,70 @@ void test_autopark_scanning_state(void) {
     TEST_ASSERT_EQUAL_UINT8(1U, mock_prompt_code);
 }
 
+/* A gap seen for PARK_GAP_CONFIRM_MS of autopark slots is confirmed. The
+ * step that confirms it still prompts scanning; reversing starts on the
+ * next one. */
 void test_autopark_gap_detection(void) {
+    setUp();
     mock_gap_found = true;
     mock_gap_width = 6000U;
     
-    app_autopark_step();
-    app_autopark_step();
-    app_autopark_step();
+    step_times(GAP_CONFIRM_STEPS);
+    TEST_ASSERT_EQUAL_UINT8(1U, mock_prompt_code);
     
+    app_autopark_step();
     TEST_ASSERT_EQUAL_UINT8(2U, mock_prompt_code);
 }
 
+void test_autopark_narrow_gap_keeps_scanning(void) {
+    setUp();
+    mock_gap_found = true;
+    mock_gap_width = PARK_MIN_GAP_MM - 1U;
+    
+    step_times(GAP_CONFIRM_STEPS + 2U);
+    
+    TEST_ASSERT_EQUAL_UINT8(1U, mock_prompt_code);
+}
+
+/* Each manoeuvre phase lasts its calibrated time at the autopark slot
+ * period, whatever that period is. */
+void test_autopark_manoeuvre_follows_ms_timings(void) {
+    autopark_state_t ctx;
+    hal_io_t io;
+    uint32_t steps = 0U;
+    
+    memset(&io, 0, sizeof(io));
+    app_autopark_init_ctx(&ctx);
+    io.in.speed_valid = true;
+    io.in.speed_kph = 5U;
+    io.in.gap_valid = true;
+    io.in.gap.found = true;
+    io.in.gap.width_mm = 6000U;
+    
+    while ((io.out.park_step != 2U) && (steps < 100U)) {
+        app_autopark_step_ctx(&ctx, &io);
+        steps++;
+    }
+    for (steps = 0U; (io.out.park_step == 2U) && (steps < 100U); steps++) {
+        app_autopark_step_ctx(&ctx, &io);
+    }
+    TEST_ASSERT_EQUAL_UINT32(PARK_REVERSE_MS / SCHED_AUTOPARK_PERIOD_MS, steps);
+    TEST_ASSERT_EQUAL_UINT8(3U, io.out.park_step);
+    
+    for (steps = 0U; (io.out.park_step == 3U) && (steps < 100U); steps++) {
+        app_autopark_step_ctx(&ctx, &io);
+    }
+    TEST_ASSERT_EQUAL_UINT32(PARK_STRAIGHTEN_MS / SCHED_AUTOPARK_PERIOD_MS, steps);
+    
+    for (steps = 0U; (io.out.park_step == 4U) && (steps < 100U); steps++) {
+        app_autopark_step_ctx(&ctx, &io);
+    }
+    TEST_ASSERT_EQUAL_UINT32(PARK_REVERSE_MS / SCHED_AUTOPARK_PERIOD_MS, steps);
+    TEST_ASSERT_EQUAL_UINT8(5U, io.out.park_step);
+}
+
 void test_autopark_speed_too_high(void) {
+    setUp();
     mock_speed_kph = 15U;
     mock_gap_found = true;
     mock_gap_width = 6000U;
@@ -83,6 +150,8 @@ int main(void) {
     RUN_TEST(test_autopark_scanning_state);
     RUN_TEST(test_autopark_gap_detection);
     RUN_TEST(test_autopark_speed_too_high);
+    RUN_TEST(test_autopark_narrow_gap_keeps_scanning);
+    RUN_TEST(test_autopark_manoeuvre_follows_ms_timings);
     
     return UNITY_END();
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "unity.h"
+#include <string.h>
 #include "app_climate.h"
+#include "calib.h"
 
 static int16_t mock_cabin_temp = 200;
 static int16_t mock_ambient_temp = 250;
@@ -62,41 +64,127 @@ void setUp(void) {
 void tearDown(void) {
 }
 
+/* Steps at `now_ms` with fresh sensor readings. */
+static void step_at(uint32_t now_ms) {
+    mock_current_time = now_ms;
+    mock_timestamp_ms = now_ms;
+    app_climate_step();
+}
+
+/* The first step only takes the time; the controller updates on the next
+ * one, CLIMATE_DT_MS later. */
+static void step_twice(void) {
+    step_at(1000U);
+    step_at(1000U + CLIMATE_DT_MS);
+}
+
 void test_climate_cold_cabin_heating(void) {
+    setUp();
     mock_cabin_temp = 180;
-    mock_current_time = 2000U;
     
-    app_climate_step();
+    step_twice();
     
     TEST_ASSERT_TRUE(mock_fan_stage > 0U);
     TEST_ASSERT_EQUAL_UINT8(100U, mock_blend_pct);
 }
 
 void test_climate_hot_cabin_cooling(void) {
+    setUp();
     mock_cabin_temp = 260;
-    mock_current_time = 2000U;
     
-    app_climate_step();
+    step_twice();
     
     TEST_ASSERT_TRUE(mock_fan_stage > 0U);
     TEST_ASSERT_TRUE(mock_ac_on);
 }
 
 void test_climate_high_humidity_ac_on(void) {
+    setUp();
     mock_humidity = 80U;
-    mock_current_time = 2000U;
     
-    app_climate_step();
+    step_twice();
     
     TEST_ASSERT_TRUE(mock_ac_on);
 }
 
+void test_climate_stale_cabin_turns_off(void) {
+    setUp();
+    mock_cabin_temp = 180;
+    step_twice();
+    TEST_ASSERT_TRUE(mock_fan_stage > 0U);
+    
+    mock_current_time = 3000U;
+    mock_timestamp_ms = 3000U - SENSOR_STALE_MS - 1U;
+    app_climate_step();
+    
+    TEST_ASSERT_EQUAL_UINT8(0U, mock_fan_stage);
+    TEST_ASSERT_FALSE(mock_ac_on);
+    TEST_ASSERT_EQUAL_UINT8(50U, mock_blend_pct);
+}
+
+/* The integral grows once per update, so steps between updates hold the
+ * outputs. */
+void test_climate_ctx_integrates_once_per_update(void) {
+    climate_state_t ctx;
+    hal_io_t io;
+    int32_t integral = 0;
+    
+    memset(&io, 0, sizeof(io));
+    app_climate_init_ctx(&ctx);
+    io.in.cabin_valid = true;
+    io.in.cabin_tc_x10 = 200;
+    io.in.now_ms = 1000U;
+    io.in.cabin_ts_ms = io.in.now_ms;
+    app_climate_step_ctx(&ctx, &io);
+    
+    io.in.now_ms += CLIMATE_DT_MS;
+    io.in.cabin_ts_ms = io.in.now_ms;
+    app_climate_step_ctx(&ctx, &io);
+    integral = ctx.integral_accumulator;
+    TEST_ASSERT_EQUAL_INT(20 * CLIMATE_KI, integral);
+    
+    io.in.now_ms += 10U;
+    io.in.cabin_ts_ms = io.in.now_ms;
+    app_climate_step_ctx(&ctx, &io);
+    TEST_ASSERT_EQUAL_INT(integral, ctx.integral_accumulator);
+    
+    io.in.now_ms += CLIMATE_DT_MS - 10U;
+    io.in.cabin_ts_ms = io.in.now_ms;
+    app_climate_step_ctx(&ctx, &io);
+    TEST_ASSERT_EQUAL_INT(2 * 20 * CLIMATE_KI, ctx.integral_accumulator);
+}
+
+/* Slot wake-ups jitter around the 1000 ms period; every one of them must
+ * update the controller. */
+void test_climate_updates_every_slot_with_jitter(void) {
+    static const uint32_t now_ms[] = {1000U, 2001U, 2999U, 4000U, 5001U, 5999U};
+    climate_state_t ctx;
+    hal_io_t io;
+    uint32_t i = 0U;
+    
+    memset(&io, 0, sizeof(io));
+    app_climate_init_ctx(&ctx);
+    io.in.cabin_valid = true;
+    io.in.cabin_tc_x10 = 210;
+    
+    for (i = 0U; i < (sizeof(now_ms) / sizeof(now_ms[0])); i++) {
+        io.in.now_ms = now_ms[i];
+        io.in.cabin_ts_ms = now_ms[i];
+        app_climate_step_ctx(&ctx, &io);
+        TEST_ASSERT_EQUAL_UINT32(now_ms[i], ctx.last_update_ms);
+        TEST_ASSERT_EQUAL_INT((int32_t)i * 10 * CLIMATE_KI, ctx.integral_accumulator);
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
     
     RUN_TEST(test_climate_cold_cabin_heating);
     RUN_TEST(test_climate_hot_cabin_cooling);
     RUN_TEST(test_climate_high_humidity_ac_on);
+    RUN_TEST(test_climate_stale_cabin_turns_off);
+    RUN_TEST(test_climate_ctx_integrates_once_per_update);
+    RUN_TEST(test_climate_updates_every_slot_with_jitter);
     
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include "unity.h"
+#include <stddef.h>
+#include <string.h>
+#include "fleet.h"
+#include "app_autobrake.h"
+#include "app_wipers.h"
+#include "app_speedgov.h"
+#include "calib.h"
+
+#define TEST_VEHICLES (1000U)
+#define TEST_TICKS    (400U)
+
+static fleet_t fleet;
+static autobrake_state_t ref_autobrake[TEST_VEHICLES];
+static wipers_state_t ref_wipers[TEST_VEHICLES];
+static speedgov_state_t ref_speedgov[TEST_VEHICLES];
+static bool ref_brake[TEST_VEHICLES];
+static uint32_t ttc_brakes = 0U;
+static uint32_t rng_state = 1U;
+
+/* The legacy wrappers in the linked modules reference the global HAL. */
+uint32_t hal_now_ms(void) { return 0U; }
+bool hal_get_vehicle_ready(void) { return false; }
+bool hal_driver_brake_pressed(void) { return false; }
+uint16_t hal_read_distance_array(distance_array_t* out) { (void)out; return 0U; }
+uint8_t hal_read_rain_burst(uint8_t* out_pct, uint8_t max, uint32_t* out_ts_ms) { (void)out_pct; (void)max; (void)out_ts_ms; return 0U; }
+bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) { (void)out_pct; (void)out_ts_ms; return false; }
+bool hal_read_vehicle_speed_kph(uint16_t* out_kph, uint32_t* out_ts_ms) { (void)out_kph; (void)out_ts_ms; return false; }
+bool hal_poll_speed_limit_kph(uint16_t* out_limit_kph) { (void)out_limit_kph; return false; }
+void hal_set_brake_request(bool on) { (void)on; }
+void hal_set_wiper_mode(uint8_t mode) { (void)mode; }
+void hal_set_alarm(bool on) { (void)on; }
+void hal_set_speed_limit_request(uint16_t kph) { (void)kph; }
+
+static uint32_t next_random(uint32_t range) {
+    rng_state = (rng_state * 1103515245U) + 12345U;
+    return (rng_state >> 8) % range;
+}
+
+static bool chance(uint32_t percent) {
+    return next_random(100U) < percent;
+}
+
+/* Fleet vehicles have the forward distance sensor only. */
+static void randomize_inputs(uint32_t v, hal_io_t* io) {
+    hal_inputs_t* in = &io->in;
+    uint16_t* mm = &in->distance.mm[HAL_DISTANCE_FORWARD_SECTOR];
+    uint32_t* ts_ms = &in->distance.ts_ms[HAL_DISTANCE_FORWARD_SECTOR];
+    
+    in->now_ms = fleet.now_ms;
+    in->vehicle_ready = !chance(5U);
+    in->driver_brake = chance(5U);
+    in->distance_valid = chance(5U) ? 0U : (uint16_t)(1U << HAL_DISTANCE_FORWARD_SECTOR);
+    if (chance(40U)) {
+        /* No new sample since the last tick, as from a slower sensor. */
+        *mm = fleet.in_distance_mm[v];
+        *ts_ms = fleet.in_distance_ts_ms[v];
+    } else if (chance(15U)) {
+        *mm = (uint16_t)(5000U + next_random(30000U));
+        *ts_ms = fleet.now_ms - next_random(130U);
+    } else {
+        *mm = (uint16_t)(AB_THRESHOLD_MM - 200U + next_random(400U));
+        *ts_ms = fleet.now_ms - next_random(130U);
+    }
+    in->rain_valid = !chance(3U);
+    in->rain_pct = (uint8_t)next_random(101U);
+    in->rain_ts_ms = fleet.now_ms - next_random(120U);
+    in->speed_valid = !chance(3U);
+    in->speed_kph = (uint16_t)next_random(120U);
+    in->speed_ts_ms = fleet.now_ms - next_random(120U);
+    in->limit_event = chance(4U);
+    in->limit_kph = (uint16_t)next_random(110U);
+    
+    fleet.in_vehicle_ready[v] = in->vehicle_ready ? 1U : 0U;
+    fleet.in_driver_brake[v] = in->driver_brake ? 1U : 0U;
+    fleet.in_distance_valid[v] = (in->distance_valid != 0U) ? 1U : 0U;
+    fleet.in_distance_mm[v] = *mm;
+    fleet.in_distance_ts_ms[v] = *ts_ms;
+    fleet.in_rain_valid[v] = in->rain_valid ? 1U : 0U;
+    fleet.in_rain_pct[v] = in->rain_pct;
+    fleet.in_rain_ts_ms[v] = in->rain_ts_ms;
+    fleet.in_speed_valid[v] = in->speed_valid ? 1U : 0U;
+    fleet.in_speed_kph[v] = in->speed_kph;
+    fleet.in_speed_ts_ms[v] = in->speed_ts_ms;
+    fleet.in_limit_event[v] = in->limit_event ? 1U : 0U;
+    fleet.in_limit_kph[v] = in->limit_kph;
+}
+
+static uint32_t run_against_reference(fleet_isa_e isa) {
+    hal_io_t io;
+    uint32_t mismatches = 0U;
+    uint32_t tick = 0U;
+    uint32_t v = 0U;
+    
+    memset(&io, 0, sizeof(io));
+    (void)fleet_init(&fleet, TEST_VEHICLES);
+    (void)fleet_set_isa(&fleet, isa);
+    for (v = 0U; v < TEST_VEHICLES; v++) {
+        app_autobrake_init_ctx(&ref_autobrake[v]);
+        app_wipers_init_ctx(&ref_wipers[v]);
+        app_speedgov_init_ctx(&ref_speedgov[v]);
+    }
+    rng_state = 1U;
+    
+    for (tick = 0U; tick < TEST_TICKS; tick++) {
+        fleet.now_ms = 1000U + (tick * 10U);
+        for (v = 0U; v < TEST_VEHICLES; v++) {
+            randomize_inputs(v, &io);
+            app_autobrake_step_ctx(&ref_autobrake[v], &io);
+            app_wipers_step_ctx(&ref_wipers[v], &io);
+            app_speedgov_step_ctx(&ref_speedgov[v], &io);
+            ref_brake[v] = io.out.brake_request;
+            ttc_brakes += (io.out.brake_request && !ref_autobrake[v].brake_active) ? 1U : 0U;
+            
+            fleet.out_brake_request[v] = io.out.brake_request ? 1U : 0U;
+            fleet.out_alarm[v] = io.out.alarm ? 1U : 0U;
+            fleet.out_limit_request[v] = io.out.limit_request;
+        }
+        
+        fleet_step(&fleet);
+        
+        for (v = 0U; v < TEST_VEHICLES; v++) {
+            if ((fleet.ab_hit_count[v] !=
+                 ref_autobrake[v].hit_count[HAL_DISTANCE_FORWARD_SECTOR]) ||
+                (fleet.ab_brake_active[v] != (ref_autobrake[v].brake_active ? 1U : 0U)) ||
+                (fleet.wp_mode[v] != ref_wipers[v].current_mode) ||
+                (fleet.sg_limit_kph[v] != ref_speedgov[v].current_limit_kph) ||
+                (fleet.sg_overspeed_count[v] != ref_speedgov[v].overspeed_count) ||
+                (fleet.sg_alarm_active[v] != (ref_speedgov[v].alarm_active ? 1U : 0U)) ||
+                (fleet.ab_ttc[v].score != ref_autobrake[v].ttc.score) ||
+                (fleet.out_brake_request[v] != (ref_brake[v] ? 1U : 0U)) ||
+                (fleet.out_alarm[v] != (ref_speedgov[v].alarm_active ? 1U : 0U)) ||
+                (fleet.out_limit_request[v] != ref_speedgov[v].current_limit_kph)) {
+                mismatches++;
+            }
+        }
+    }
+    
+    return mismatches;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/* The random inputs also have to reach the time-to-collision path. */
+void test_fleet_scalar_matches_modules(void) {
+    ttc_brakes = 0U;
+    TEST_ASSERT_EQUAL_UINT32(0U, run_against_reference(FLEET_ISA_SCALAR));
+    TEST_ASSERT_TRUE(ttc_brakes > 0U);
+}
+
+void test_fleet_sse2_matches_modules(void) {
+    if (fleet_isa_supported(FLEET_ISA_SSE2)) {
+        TEST_ASSERT_EQUAL_UINT32(0U, run_against_reference(FLEET_ISA_SSE2));
+    }
+}
+
+void test_fleet_avx2_matches_modules(void) {
+    if (fleet_isa_supported(FLEET_ISA_AVX2)) {
+        TEST_ASSERT_EQUAL_UINT32(0U, run_against_reference(FLEET_ISA_AVX2));
+    }
+}
+
+void test_fleet_rejects_oversized_fleet(void) {
+    TEST_ASSERT_FALSE(fleet_init(&fleet, FLEET_MAX_VEHICLES + 1U));
+}
+
+/* A fast closure that stays above AB_THRESHOLD_MM, which only the
+ * time-to-collision path brakes for. Returns the ticks with a request. */
+static uint32_t brakes_on_fast_closure(bool ttc) {
+    uint32_t brakes = 0U;
+    uint32_t tick = 0U;
+    
+    (void)fleet_init(&fleet, FLEET_LANES);
+    fleet.ttc_enabled = ttc;
+    fleet.in_distance_valid[0] = 1U;
+    fleet.in_speed_valid[0] = 1U;
+    fleet.in_speed_kph[0] = 100U;
+    for (tick = 0U; tick < 8U; tick++) {
+        fleet.now_ms = 1000U + (tick * 10U);
+        fleet.in_distance_mm[0] = (uint16_t)(AB_THRESHOLD_MM + 2500U - (tick * 250U));
+        fleet.in_distance_ts_ms[0] = fleet.now_ms;
+        fleet.in_speed_ts_ms[0] = fleet.now_ms;
+        fleet_step(&fleet);
+        brakes += fleet.out_brake_request[0];
+    }
+    
+    return brakes;
+}
+
+void test_fleet_ttc_can_be_turned_off(void) {
+    TEST_ASSERT_TRUE(brakes_on_fast_closure(true) > 0U);
+    TEST_ASSERT_EQUAL_UINT32(0U, brakes_on_fast_closure(false));
+    TEST_ASSERT_EQUAL_UINT16(0U, fleet.ab_ttc_filled[0]);
+}
+
+#define CORRUPT_VEHICLES (256U)
+
+static uint16_t corrupt_mode[CORRUPT_VEHICLES];
+static uint16_t corrupt_count[CORRUPT_VEHICLES];
+static uint16_t corrupt_alarm[CORRUPT_VEHICLES];
+
+/* One step from wiper modes and overspeed counts no module produces, with
+ * alarm flags that disagree with the counts. */
+static void step_corrupt_state(fleet_isa_e isa) {
+    uint32_t v = 0U;
+    
+    (void)fleet_init(&fleet, CORRUPT_VEHICLES);
+    (void)fleet_set_isa(&fleet, isa);
+    fleet.now_ms = 1000U;
+    for (v = 0U; v < CORRUPT_VEHICLES; v++) {
+        fleet.wp_mode[v] = (uint16_t)(v % 12U);
+        fleet.in_rain_valid[v] = 1U;
+        fleet.in_rain_ts_ms[v] = fleet.now_ms;
+        fleet.in_rain_pct[v] = (uint16_t)((v * 37U) % 300U);
+        fleet.sg_overspeed_count[v] = (uint16_t)((v / 12U) % 7U);
+        fleet.sg_alarm_active[v] = (uint16_t)(v & 1U);
+        fleet.sg_limit_kph[v] = (uint16_t)((v * 7U) % 60U);
+        fleet.in_speed_valid[v] = 1U;
+        fleet.in_speed_ts_ms[v] = fleet.now_ms;
+        fleet.in_speed_kph[v] = (uint16_t)((v * 13U) % 120U);
+    }
+    
+    fleet_step(&fleet);
+}
+
+void test_fleet_kernels_agree_on_out_of_range_state(void) {
+    fleet_isa_e isas[2] = {FLEET_ISA_SSE2, FLEET_ISA_AVX2};
+    uint32_t mismatches = 0U;
+    uint32_t k = 0U;
+    uint32_t v = 0U;
+    
+    step_corrupt_state(FLEET_ISA_SCALAR);
+    for (v = 0U; v < CORRUPT_VEHICLES; v++) {
+        corrupt_mode[v] = fleet.wp_mode[v];
+        corrupt_count[v] = fleet.sg_overspeed_count[v];
+        corrupt_alarm[v] = fleet.out_alarm[v];
+    }
+    TEST_ASSERT_EQUAL_UINT16(11U, corrupt_mode[11]);
+    
+    for (k = 0U; k < 2U; k++) {
+        if (fleet_isa_supported(isas[k])) {
+            step_corrupt_state(isas[k]);
+            for (v = 0U; v < CORRUPT_VEHICLES; v++) {
+                if ((fleet.wp_mode[v] != corrupt_mode[v]) ||
+                    (fleet.sg_overspeed_count[v] != corrupt_count[v]) ||
+                    (fleet.sg_alarm_active[v] != corrupt_alarm[v]) ||
+                    (fleet.out_alarm[v] != corrupt_alarm[v])) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, mismatches);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_fleet_scalar_matches_modules);
+    RUN_TEST(test_fleet_sse2_matches_modules);
+    RUN_TEST(test_fleet_avx2_matches_modules);
+    RUN_TEST(test_fleet_rejects_oversized_fleet);
+    RUN_TEST(test_fleet_kernels_agree_on_out_of_range_state);
+    RUN_TEST(test_fleet_ttc_can_be_turned_off);
+    
+    return UNITY_END();
+}
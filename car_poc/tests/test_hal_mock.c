@@ -0,0 +1,89 @@
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+#include "hal_mock.h"
+
+#define TEST_CSV "test_hal_mock_tmp.csv"
+
+static scenario_reader_t reader;
+static hal_mock_t mock;
+static hal_io_t io;
+
+uint64_t platform_get_time_us(void) {
+    return 0U;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void write_file(const char* text) {
+    FILE* file = fopen(TEST_CSV, "wb");
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+/* Replays `text` up to now_ms and fills `io.in`. */
+static void replay(const char* text, uint32_t now_ms) {
+    write_file(text);
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    hal_mock_init_ctx(&mock, &reader);
+    memset(&io, 0, sizeof(io));
+    hal_mock_begin_tick_ctx(&mock, now_ms);
+    hal_mock_fill_inputs(&mock, now_ms, &io.in);
+}
+
+static void finish(void) {
+    scenario_reader_close(&reader);
+    (void)remove(TEST_CSV);
+}
+
+/* A channel missing from the header has no reading, it does not read as a
+ * valid zero. */
+void test_hal_mock_missing_channels_are_invalid(void) {
+    replay("ms,rain_pct\n"
+           "0,30\n"
+           "10,31\n", 10U);
+    
+    TEST_ASSERT_TRUE(io.in.rain_valid);
+    TEST_ASSERT_EQUAL_UINT8(31U, io.in.rain_pct);
+    TEST_ASSERT_EQUAL_UINT16(0U, io.in.distance_valid);
+    TEST_ASSERT_FALSE(io.in.speed_valid);
+    TEST_ASSERT_FALSE(io.in.gap_valid);
+    TEST_ASSERT_FALSE(io.in.cabin_valid);
+    TEST_ASSERT_FALSE(io.in.ambient_valid);
+    TEST_ASSERT_FALSE(io.in.humid_valid);
+    finish();
+}
+
+void test_hal_mock_distance_is_forward_sector_without_sectors(void) {
+    replay("ms,distance_mm,speed_kph\n"
+           "0,2500,40\n", 0U);
+    
+    TEST_ASSERT_EQUAL_UINT16(1U << HAL_DISTANCE_FORWARD_SECTOR, io.in.distance_valid);
+    TEST_ASSERT_EQUAL_UINT16(2500U, io.in.distance.mm[HAL_DISTANCE_FORWARD_SECTOR]);
+    TEST_ASSERT_TRUE(io.in.speed_valid);
+    TEST_ASSERT_FALSE(io.in.rain_valid);
+    finish();
+}
+
+void test_hal_mock_sectors_only_where_named(void) {
+    replay("ms,sector2_mm,sector5_mm\n"
+           "0,1500,65535\n", 0U);
+    
+    TEST_ASSERT_EQUAL_UINT16((1U << 2) | (1U << 5), io.in.distance_valid);
+    TEST_ASSERT_EQUAL_UINT16(1500U, io.in.distance.mm[2]);
+    finish();
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hal_mock_missing_channels_are_invalid);
+    RUN_TEST(test_hal_mock_distance_is_forward_sector_without_sectors);
+    RUN_TEST(test_hal_mock_sectors_only_where_named);
+    return UNITY_END();
+}
@@ -0,0 +1,258 @@
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+#include "output_log.h"
+
+#define TEST_CSV "test_output_log_tmp.csv"
+#define TEST_BIN "test_output_log_tmp" OUTPUT_LOG_SUFFIX
+#define TEST_DELTA "test_output_log_tmp" OUTPUT_DELTA_SUFFIX
+#define TEST_DELTA_TICKS (40000U)
+
+static output_log_t out_log;
+
+static void make_outputs(hal_outputs_t* out, uint32_t i) {
+    out->brake_request = (i % 3U) == 0U;
+    out->wiper_mode = (uint8_t)(i % 4U);
+    out->alarm = (i % 5U) == 0U;
+    out->limit_request = (uint16_t)((i * 7U) % 200U);
+    out->fan_stage = (uint8_t)(i % 6U);
+    out->ac_on = (i % 2U) == 0U;
+    out->blend_pct = (uint8_t)(i % 101U);
+    out->park_step = (uint8_t)(i % 9U);
+}
+
+/* The line the simulator used to print with fprintf. */
+static int legacy_line(char* line, size_t size, uint32_t ms, const hal_outputs_t* out) {
+    return snprintf(line, size, "%u,%d,%u,%d,%u,%u,%d,%u,%u\n",
+                    ms,
+                    out->brake_request ? 1 : 0,
+                    out->wiper_mode,
+                    out->alarm ? 1 : 0,
+                    out->limit_request,
+                    out->fan_stage,
+                    out->ac_on ? 1 : 0,
+                    out->blend_pct,
+                    out->park_step);
+}
+
+static long read_file(const char* path, char* buf, size_t size) {
+    FILE* file = fopen(path, "rb");
+    size_t got = 0U;
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    got = fread(buf, 1U, size, file);
+    fclose(file);
+    return (long)got;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    (void)remove(TEST_CSV);
+    (void)remove(TEST_BIN);
+    (void)remove(TEST_DELTA);
+}
+
+void test_output_log_csv_line_matches_legacy_format(void) {
+    static const uint32_t times[] = {0U, 10U, 99990U, UINT32_MAX};
+    output_record_t record;
+    hal_outputs_t out;
+    char expected[OUTPUT_LOG_CSV_LINE_MAX];
+    char line[OUTPUT_LOG_CSV_LINE_MAX];
+    uint32_t len = 0U;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < 4U; i++) {
+        make_outputs(&out, i * 1234567U);
+        output_log_pack(&record, times[i], &out);
+        len = output_log_format_csv(&record, line);
+        TEST_ASSERT_EQUAL_INT(legacy_line(expected, sizeof(expected), times[i], &out), (int)len);
+        TEST_ASSERT_TRUE(memcmp(expected, line, len) == 0);
+    }
+    
+    memset(&out, 0xFF, sizeof(out));
+    out.brake_request = true;
+    out.alarm = true;
+    out.ac_on = true;
+    output_log_pack(&record, UINT32_MAX, &out);
+    len = output_log_format_csv(&record, line);
+    TEST_ASSERT_EQUAL_INT(legacy_line(expected, sizeof(expected), UINT32_MAX, &out), (int)len);
+    TEST_ASSERT_TRUE(memcmp(expected, line, len) == 0);
+    TEST_ASSERT_TRUE(len <= OUTPUT_LOG_CSV_LINE_MAX);
+}
+
+void test_output_log_format_follows_suffix(void) {
+    TEST_ASSERT_TRUE(output_log_format_for("run" OUTPUT_LOG_SUFFIX) == OUTPUT_LOG_BINARY);
+    TEST_ASSERT_TRUE(output_log_format_for("outputs.csv") == OUTPUT_LOG_CSV);
+    TEST_ASSERT_TRUE(output_log_format_for("outputs") == OUTPUT_LOG_CSV);
+    TEST_ASSERT_TRUE(output_log_format_for("run" OUTPUT_DELTA_SUFFIX) == OUTPUT_LOG_DELTA);
+}
+
+void test_output_log_csv_file(void) {
+    static char expected[4096];
+    static char text[4096];
+    hal_outputs_t out;
+    size_t len = sizeof(OUTPUT_LOG_CSV_HEADER) - 1U;
+    uint32_t i = 0U;
+    
+    memcpy(expected, OUTPUT_LOG_CSV_HEADER, len);
+    TEST_ASSERT_TRUE(output_log_open(&out_log, TEST_CSV, OUTPUT_LOG_CSV));
+    for (i = 0U; i < 50U; i++) {
+        make_outputs(&out, i);
+        output_log_append(&out_log, i * 10U, &out);
+        len += (size_t)legacy_line(&expected[len], sizeof(expected) - len, i * 10U, &out);
+    }
+    TEST_ASSERT_TRUE(output_log_close(&out_log));
+    
+    TEST_ASSERT_EQUAL_INT((int)len, (int)read_file(TEST_CSV, text, sizeof(text)));
+    TEST_ASSERT_TRUE(memcmp(expected, text, len) == 0);
+}
+
+/* More records than the ring holds, so the simulation side has to wait
+ * for the I/O thread and the last block is a partial one. */
+void test_output_log_binary_round_trip(void) {
+    static uint8_t data[sizeof(output_log_header_t) +
+                        (((OUTPUT_LOG_BLOCKS + 2U) * OUTPUT_LOG_BLOCK_RECORDS) *
+                         sizeof(output_record_t))];
+    const uint32_t count = ((OUTPUT_LOG_BLOCKS + 1U) * OUTPUT_LOG_BLOCK_RECORDS) + 17U;
+    output_log_header_t header;
+    output_record_t expected;
+    output_record_t record;
+    hal_outputs_t out;
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_TRUE(output_log_open(&out_log, TEST_BIN, OUTPUT_LOG_BINARY));
+    TEST_ASSERT_TRUE(output_log_is_open(&out_log));
+    for (i = 0U; i < count; i++) {
+        make_outputs(&out, i);
+        output_log_append(&out_log, i * 10U, &out);
+    }
+    TEST_ASSERT_TRUE(output_log_close(&out_log));
+    TEST_ASSERT_FALSE(output_log_is_open(&out_log));
+    
+    TEST_ASSERT_EQUAL_INT((int)(sizeof(header) + (count * sizeof(output_record_t))),
+                          (int)read_file(TEST_BIN, (char*)data, sizeof(data)));
+    memcpy(&header, data, sizeof(header));
+    TEST_ASSERT_TRUE(memcmp(header.magic, OUTPUT_LOG_MAGIC, 4U) == 0);
+    TEST_ASSERT_EQUAL_UINT16(OUTPUT_LOG_VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT16(OUTPUT_LOG_BYTE_ORDER, header.byte_order);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(output_record_t), header.record_size);
+    
+    for (i = 0U; i < count; i++) {
+        make_outputs(&out, i);
+        output_log_pack(&expected, i * 10U, &out);
+        memcpy(&record, &data[sizeof(header) + (i * sizeof(output_record_t))], sizeof(record));
+        TEST_ASSERT_TRUE(memcmp(&expected, &record, sizeof(record)) == 0);
+    }
+}
+
+/* Outputs that mostly hold still, on a clock with irregular steps. */
+static void make_slow_outputs(hal_outputs_t* out, uint32_t i) {
+    memset(out, 0, sizeof(*out));
+    out->brake_request = ((i / 700U) % 2U) == 1U;
+    out->wiper_mode = (uint8_t)((i / 1500U) % 4U);
+    out->alarm = (i % 9000U) < 5U;
+    out->limit_request = (uint16_t)(50U + (((i / 2000U) % 5U) * 10U));
+    out->fan_stage = (uint8_t)((i / 3000U) % 6U);
+    out->ac_on = ((i / 4000U) % 2U) == 0U;
+    out->blend_pct = (uint8_t)((i / 250U) % 101U);
+    out->park_step = (uint8_t)((i / 5000U) % 9U);
+}
+
+static uint32_t slow_ms(uint32_t i) {
+    return (i * 10U) + ((i / 1000U) * 3U) + ((i / 777U) * 5000U);
+}
+
+void test_output_log_delta_round_trip(void) {
+    static uint8_t data[TEST_DELTA_TICKS * sizeof(output_record_t)];
+    output_delta_header_t header;
+    output_delta_chunk_t chunk;
+    output_delta_decoder_t decoder;
+    output_record_t expected;
+    output_record_t record;
+    hal_outputs_t out;
+    uint32_t prev_first_ms = 0U;
+    uint32_t chunks = 0U;
+    size_t pos = sizeof(header);
+    long len = 0;
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_TRUE(output_log_open(&out_log, TEST_DELTA, OUTPUT_LOG_DELTA));
+    for (i = 0U; i < TEST_DELTA_TICKS; i++) {
+        make_slow_outputs(&out, i);
+        output_log_append(&out_log, slow_ms(i), &out);
+    }
+    TEST_ASSERT_TRUE(output_log_close(&out_log));
+    
+    len = read_file(TEST_DELTA, (char*)data, sizeof(data));
+    TEST_ASSERT_TRUE(len < (long)((TEST_DELTA_TICKS * sizeof(output_record_t)) / 20U));
+    memcpy(&header, data, sizeof(header));
+    TEST_ASSERT_TRUE(memcmp(header.magic, OUTPUT_DELTA_MAGIC, 4U) == 0);
+    TEST_ASSERT_EQUAL_UINT32(OUTPUT_DELTA_KEYFRAME_MS, header.keyframe_ms);
+    
+    i = 0U;
+    while (pos < (size_t)len) {
+        memcpy(&chunk, &data[pos], sizeof(chunk));
+        pos += sizeof(chunk);
+        TEST_ASSERT_TRUE(memcmp(chunk.sync, OUTPUT_DELTA_SYNC, 4U) == 0);
+        if (chunks > 0U) {
+            TEST_ASSERT_TRUE((chunk.first_ms - prev_first_ms) >= OUTPUT_DELTA_KEYFRAME_MS);
+        }
+        prev_first_ms = chunk.first_ms;
+        chunks++;
+        
+        TEST_ASSERT_EQUAL_UINT32(slow_ms(i), chunk.first_ms);
+        
+        output_delta_decode_start(&decoder, &chunk, &data[pos]);
+        while (output_delta_decode_next(&decoder, &record)) {
+            make_slow_outputs(&out, i);
+            output_log_pack(&expected, slow_ms(i), &out);
+            TEST_ASSERT_TRUE(memcmp(&expected, &record, sizeof(record)) == 0);
+            i++;
+        }
+        TEST_ASSERT_TRUE(output_delta_decode_complete(&decoder));
+        TEST_ASSERT_EQUAL_UINT32(slow_ms(i - 1U), chunk.last_ms);
+        pos += chunk.payload_len;
+    }
+    TEST_ASSERT_EQUAL_UINT32(TEST_DELTA_TICKS, i);
+    TEST_ASSERT_TRUE(chunks > 10U);
+}
+
+void test_output_log_delta_rejects_truncated_chunk(void) {
+    static const uint8_t payload[] = {OUTPUT_DELTA_RUN, 5U, 10U};
+    output_delta_chunk_t chunk;
+    output_delta_decoder_t decoder;
+    output_record_t record;
+    
+    memset(&chunk, 0, sizeof(chunk));
+    memcpy(chunk.sync, OUTPUT_DELTA_SYNC, 4U);
+    chunk.ticks = 6U;
+    chunk.payload_len = (uint32_t)sizeof(payload);
+    output_delta_decode_start(&decoder, &chunk, payload);
+    TEST_ASSERT_FALSE(output_delta_decode_next(&decoder, &record));
+    TEST_ASSERT_FALSE(output_delta_decode_complete(&decoder));
+}
+
+void test_output_log_unopened_log_is_ignored(void) {
+    hal_outputs_t out;
+    
+    memset(&out_log, 0, sizeof(out_log));
+    memset(&out, 0, sizeof(out));
+    output_log_append(&out_log, 0U, &out);
+    TEST_ASSERT_TRUE(output_log_close(&out_log));
+    TEST_ASSERT_FALSE(output_log_open(&out_log, "no_such_dir/outputs.csv", OUTPUT_LOG_CSV));
+    TEST_ASSERT_FALSE(output_log_is_open(&out_log));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_output_log_csv_line_matches_legacy_format);
+    RUN_TEST(test_output_log_format_follows_suffix);
+    RUN_TEST(test_output_log_csv_file);
+    RUN_TEST(test_output_log_binary_round_trip);
+    RUN_TEST(test_output_log_delta_round_trip);
+    RUN_TEST(test_output_log_delta_rejects_truncated_chunk);
+    RUN_TEST(test_output_log_unopened_log_is_ignored);
+    return UNITY_END();
+}
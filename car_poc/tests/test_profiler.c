@@ -0,0 +1,61 @@
+#include "unity.h"
+#include "profiler.h"
+
+void setUp(void) {
+    prof_init();
+}
+
+void tearDown(void) {
+}
+
+void test_profiler_empty_slot_reports_zero(void) {
+    TEST_ASSERT_EQUAL_UINT32(0U, (uint32_t)prof_percentile_ns(SCHED_ID_wipers, 5000U));
+    TEST_ASSERT_EQUAL_UINT32(0U, (uint32_t)prof_max_ns(SCHED_ID_wipers));
+}
+
+void test_profiler_small_values_are_exact(void) {
+    prof_record(SCHED_ID_autobrake, 3U);
+    
+    TEST_ASSERT_EQUAL_UINT32(3U, (uint32_t)prof_percentile_ns(SCHED_ID_autobrake, 5000U));
+    TEST_ASSERT_EQUAL_UINT32(3U, (uint32_t)prof_max_ns(SCHED_ID_autobrake));
+}
+
+void test_profiler_percentiles_within_bucket_resolution(void) {
+    uint32_t i = 0U;
+    uint64_t p50 = 0U;
+    uint64_t p99 = 0U;
+    
+    for (i = 1U; i <= 1000U; i++) {
+        prof_record(SCHED_ID_speedgov, (uint64_t)i * 100U);
+    }
+    
+    p50 = prof_percentile_ns(SCHED_ID_speedgov, 5000U);
+    p99 = prof_percentile_ns(SCHED_ID_speedgov, 9900U);
+    
+    TEST_ASSERT_TRUE((p50 >= 50000U) && (p50 < 62500U));
+    TEST_ASSERT_TRUE((p99 >= 99000U) && (p99 <= 100000U));
+    TEST_ASSERT_EQUAL_UINT32(100000U, (uint32_t)prof_max_ns(SCHED_ID_speedgov));
+}
+
+void test_profiler_tail_shows_single_outlier(void) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < 999U; i++) {
+        prof_record(SCHED_ID_voice, 200U);
+    }
+    prof_record(SCHED_ID_voice, 5000000U);
+    
+    TEST_ASSERT_TRUE(prof_percentile_ns(SCHED_ID_voice, 9900U) < 256U);
+    TEST_ASSERT_EQUAL_UINT32(5000000U, (uint32_t)prof_percentile_ns(SCHED_ID_voice, 10000U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_profiler_empty_slot_reports_zero);
+    RUN_TEST(test_profiler_small_values_are_exact);
+    RUN_TEST(test_profiler_percentiles_within_bucket_resolution);
+    RUN_TEST(test_profiler_tail_shows_single_outlier);
+    
+    return UNITY_END();
+}
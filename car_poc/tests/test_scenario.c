@@ -0,0 +1,672 @@
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+#include "scenario.h"
+#include "scenario_bin.h"
+#include "scenario_gen.h"
+#include "scenario_load.h"
+#include "scenario_stream.h"
+
+#define TEST_CSV "test_scenario_tmp.csv"
+#define TEST_HEADER "ms,distance_mm,rain_pct,speed_kph,sign_event,gap_found," \
+                    "gap_width_mm,cabin_tc_x10,ambient_tc_x10,humid_pct,setpoint_x10,voice_cmd\n"
+
+static void write_file(const char* text) {
+    FILE* file = fopen(TEST_CSV, "wb");
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void assert_rows_equal(const scenario_row_t* a, const scenario_row_t* b) {
+    TEST_ASSERT_EQUAL_UINT32(a->ms, b->ms);
+    TEST_ASSERT_EQUAL_UINT16(a->distance_mm, b->distance_mm);
+    TEST_ASSERT_EQUAL_UINT8(a->rain_pct, b->rain_pct);
+    TEST_ASSERT_EQUAL_UINT16(a->speed_kph, b->speed_kph);
+    TEST_ASSERT_EQUAL_UINT16(a->sign_event, b->sign_event);
+    TEST_ASSERT_EQUAL_INT(a->gap_found, b->gap_found);
+    TEST_ASSERT_EQUAL_UINT16(a->gap_width_mm, b->gap_width_mm);
+    TEST_ASSERT_EQUAL_INT(a->cabin_tc_x10, b->cabin_tc_x10);
+    TEST_ASSERT_EQUAL_INT(a->ambient_tc_x10, b->ambient_tc_x10);
+    TEST_ASSERT_EQUAL_UINT8(a->humid_pct, b->humid_pct);
+    TEST_ASSERT_EQUAL_INT(a->setpoint_x10, b->setpoint_x10);
+    TEST_ASSERT_TRUE(strcmp(a->voice_cmd, b->voice_cmd) == 0);
+    TEST_ASSERT_EQUAL_UINT32(a->sampled, b->sampled);
+}
+
+static scenario_stream_t stream;
+
+typedef bool (*open_fn)(scenario_reader_t* reader, const char* filename);
+
+static bool open_stream(scenario_reader_t* reader, const char* filename) {
+    return scenario_reader_open_stream(reader, &stream, filename, false);
+}
+
+/* Reads the file through `open_reader` and the stdio path and checks they
+ * agree row by row. */
+static uint32_t compare_with(open_fn open_reader) {
+    scenario_reader_t mapped;
+    scenario_reader_t buffered;
+    scenario_row_t mapped_row;
+    scenario_row_t buffered_row;
+    bool have_mapped = false;
+    bool have_buffered = false;
+    uint32_t rows = 0U;
+    
+    TEST_ASSERT_TRUE(open_reader(&mapped, TEST_CSV));
+    TEST_ASSERT_TRUE(scenario_reader_open_buffered(&buffered, TEST_CSV));
+    
+    do {
+        have_mapped = scenario_reader_next(&mapped, &mapped_row);
+        have_buffered = scenario_reader_next(&buffered, &buffered_row);
+        TEST_ASSERT_EQUAL_INT(have_buffered, have_mapped);
+        if (have_mapped) {
+            assert_rows_equal(&buffered_row, &mapped_row);
+            rows++;
+        }
+    } while (have_mapped && have_buffered);
+    
+    scenario_reader_close(&mapped);
+    scenario_reader_close(&buffered);
+    return rows;
+}
+
+static uint32_t compare_readers(void) {
+    return compare_with(scenario_reader_open);
+}
+
+#define TEST_BIN_ROWS (2U)
+
+/* Hand-built compiled file: columns follow the header back to back, each
+ * padded to SCENARIO_BIN_ALIGN, then one voice entry for row 1. */
+static void write_compiled(uint16_t version) {
+    static uint8_t image[1024];
+    scenario_bin_header_t hdr;
+    scenario_bin_voice_t voice = {1U, 0U};
+    uint64_t offset = (sizeof(hdr) + 7U) & ~(uint64_t)7U;
+    uint32_t c = 0U;
+    uint32_t r = 0U;
+    size_t size[SCENARIO_BIN_NUM_COLUMNS];
+    FILE* file = NULL;
+    
+    memset(image, 0, sizeof(image));
+    memset(&hdr, 0, sizeof(hdr));
+#define TEST_COLUMN_SIZE(name, type) size[SCENARIO_COL_##name] = sizeof(type);
+    SCENARIO_BIN_COLUMNS(TEST_COLUMN_SIZE)
+    
+    for (c = 0U; c < (uint32_t)SCENARIO_BIN_NUM_COLUMNS; c++) {
+        hdr.column_offset[c] = offset;
+        for (r = 0U; r < TEST_BIN_ROWS; r++) {
+            /* Low byte only: every column reads back as (row + 1) * 10 + c. */
+            image[offset + (r * size[c])] = (uint8_t)(((r + 1U) * 10U) + c);
+        }
+        offset = (offset + (TEST_BIN_ROWS * size[c]) + 7U) & ~(uint64_t)7U;
+    }
+    
+    memcpy(hdr.magic, SCENARIO_BIN_MAGIC, 4U);
+    hdr.version = version;
+    hdr.byte_order = SCENARIO_BIN_BYTE_ORDER;
+    hdr.num_columns = (uint32_t)SCENARIO_BIN_NUM_COLUMNS;
+    hdr.row_count = TEST_BIN_ROWS;
+    hdr.voice_count = 1U;
+    hdr.voice_index_offset = offset;
+    memcpy(&image[offset], &voice, sizeof(voice));
+    offset += sizeof(voice);
+    hdr.voice_strings_offset = offset;
+    hdr.voice_strings_len = 8U;
+    memcpy(&image[offset], "hey car", 8U);
+    hdr.file_size = offset + 8U;
+    memcpy(image, &hdr, sizeof(hdr));
+    
+    file = fopen(TEST_CSV, "wb");
+    TEST_ASSERT_TRUE(file != NULL);
+    fwrite(image, 1U, (size_t)hdr.file_size, file);
+    fclose(file);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    (void)remove(TEST_CSV);
+}
+
+void test_scenario_mapped_matches_buffered(void) {
+    write_file(TEST_HEADER
+               "0,2000,0,50,50,0,0,220,250,45,220,\n"
+               "100,1900,5,52,0,1,5200,-15,-250,45,-5,hey car set temp 23\n"
+               "4294967290,65535,100,250,0,0,0,0,0,0,0,\r\n"
+               "200,1800\n"
+               "300,1700,7,60,0,0,0,221,250,45,220,voice, with comma\r\n");
+    
+    TEST_ASSERT_EQUAL_UINT32(5U, compare_readers());
+}
+
+void test_scenario_mapped_parses_values(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    write_file(TEST_HEADER "100,1900,5,52,0,1,5200,-15,-250,45,-5,hey car\r\n");
+    
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_TRUE(reader.map != NULL);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(100U, row.ms);
+    TEST_ASSERT_TRUE(row.gap_found);
+    TEST_ASSERT_EQUAL_INT(-15, row.cabin_tc_x10);
+    TEST_ASSERT_EQUAL_INT(-250, row.ambient_tc_x10);
+    TEST_ASSERT_TRUE(strcmp("hey car", row.voice_cmd) == 0);
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+    scenario_reader_close(&reader);
+}
+
+void test_scenario_truncates_long_voice_command(void) {
+    write_file(TEST_HEADER "0,1,2,3,4,0,0,0,0,0,0,"
+               "0123456789012345678901234567890123456789012345678901234567890123456789\n");
+    
+    TEST_ASSERT_EQUAL_UINT32(1U, compare_readers());
+}
+
+void test_scenario_without_final_newline_uses_stdio(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    write_file(TEST_HEADER "0,2000,0,50,50,0,0,220,250,45,220,");
+    
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_TRUE(reader.map == NULL);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT16(2000U, row.distance_mm);
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+    scenario_reader_close(&reader);
+}
+
+void test_scenario_header_only_has_no_rows(void) {
+    write_file(TEST_HEADER);
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, compare_readers());
+}
+
+void test_scenario_reads_compiled_columns(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    write_compiled(SCENARIO_BIN_VERSION);
+    
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_TRUE(reader.compiled);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(10U, row.ms);
+    TEST_ASSERT_EQUAL_UINT16(11U, row.distance_mm);
+    TEST_ASSERT_TRUE(row.gap_found);
+    TEST_ASSERT_EQUAL_INT(20, row.setpoint_x10);
+    TEST_ASSERT_TRUE(row.voice_cmd[0] == '\0');
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(20U, row.ms);
+    TEST_ASSERT_EQUAL_UINT8(29U, row.humid_pct);
+    TEST_ASSERT_TRUE(strcmp("hey car", row.voice_cmd) == 0);
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+    scenario_reader_close(&reader);
+}
+
+void test_scenario_rejects_unknown_compiled_version(void) {
+    scenario_reader_t reader;
+    
+    write_compiled(SCENARIO_BIN_VERSION + 1U);
+    
+    TEST_ASSERT_FALSE(scenario_reader_open(&reader, TEST_CSV));
+}
+
+void test_scenario_header_reorders_and_skips_columns(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    write_file("\xEF\xBB\xBFspeed_kph, lidar_q ,voice_cmd,ms,imu_yaw,cabin_tc_x10\r\n"
+               "52,0.97,hey car,100,-3.5,-15\r\n"
+               "60,n/a,,200,1.0,221\r\n");
+    
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_EQUAL_UINT8(6U, reader.schema.field_count);
+    TEST_ASSERT_FALSE(reader.schema.voice_last);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(100U, row.ms);
+    TEST_ASSERT_EQUAL_UINT16(52U, row.speed_kph);
+    TEST_ASSERT_EQUAL_INT(-15, row.cabin_tc_x10);
+    TEST_ASSERT_EQUAL_UINT16(0U, row.distance_mm);
+    TEST_ASSERT_TRUE(strcmp("hey car", row.voice_cmd) == 0);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(200U, row.ms);
+    TEST_ASSERT_EQUAL_INT(221, row.cabin_tc_x10);
+    TEST_ASSERT_TRUE(row.voice_cmd[0] == '\0');
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+    scenario_reader_close(&reader);
+    
+    TEST_ASSERT_EQUAL_UINT32(2U, compare_readers());
+    TEST_ASSERT_EQUAL_UINT32(2U, compare_with(open_stream));
+}
+
+/* Sector and raw rain channels only count when the header names them. */
+void test_scenario_reader_reports_recorded_channels(void) {
+    scenario_reader_t reader;
+    
+    write_file("ms,speed_kph,sector2_mm,sector5_mm,rain_raw,voice_cmd\n"
+               "0,40,1500,65535,30,\n");
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_EQUAL_UINT32(SCENARIO_SAMPLED(ms) | SCENARIO_SAMPLED(speed_kph) |
+                             SCENARIO_SAMPLED(sector2_mm) | SCENARIO_SAMPLED(sector5_mm) |
+                             SCENARIO_SAMPLED(rain_raw),
+                             scenario_reader_channels(&reader));
+    scenario_reader_close(&reader);
+    
+    write_file("ms,distance_mm,rain_pct,speed_kph,sign_event,gap_found,gap_width_mm,"
+               "cabin_tc_x10,ambient_tc_x10,humid_pct,setpoint_x10,voice_cmd\n"
+               "0,3000,0,40,50,0,0,200,180,40,220,\n");
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(SCENARIO_SAMPLED_ALL & ~(SCENARIO_SECTOR_CHANNELS |
+                                                                 SCENARIO_SAMPLED(rain_raw))),
+                             scenario_reader_channels(&reader));
+    scenario_reader_close(&reader);
+}
+
+void test_scenario_header_first_duplicate_wins(void) {
+    scenario_schema_t schema;
+    const char header[] = "ms,rain_pct,rain_pct,voice_cmd\n";
+    
+    TEST_ASSERT_TRUE(scenario_schema_resolve(&schema, header, sizeof(header) - 1U));
+    TEST_ASSERT_EQUAL_UINT8(4U, schema.field_count);
+    TEST_ASSERT_EQUAL_UINT8(SCENARIO_COL_rain_pct, schema.slot[1]);
+    TEST_ASSERT_EQUAL_UINT8(SCENARIO_SLOT_SKIP, schema.slot[2]);
+    TEST_ASSERT_TRUE(schema.voice_last);
+}
+
+void test_scenario_header_without_ms_is_rejected(void) {
+    scenario_reader_t reader;
+    
+    write_file("time,distance_mm\n0,2000\n");
+    
+    TEST_ASSERT_FALSE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_FALSE(scenario_reader_open_buffered(&reader, TEST_CSV));
+    TEST_ASSERT_FALSE(open_stream(&reader, TEST_CSV));
+}
+
+/* Lines that exercise the vector tokenizers' edge cases: digit runs past
+ * eight and ten digits, signs, junk after numbers, fields missing or past
+ * the header, lines longer than one scan window, and CRLF. */
+static const char tokenizer_lines[] =
+    "0,1234,55,60,0,1,4000,215,-35,45,220,\n"
+    "10,12345678,100,123456789,4294967295,0,99999999999,-32768,-1,7,-220,hey car\n"
+    "20,-0,7x,8.5,,1,0012,-00021,abc,99,5,set temp, 21 please\n"
+    "30,1\n"
+    "40,2,3,4,5,6,7,8,9,10,11,voice,extra,fields,that,are,well,past,the,sixty,four,byte,window\n"
+    "50,1800,20,90,80,0,5000,230,150,60,220,\r\n"
+    "60,1,2,3,4,5,6,7,8,9,10,\n"
+    "70,,,,,,,,,,,\r\n"
+    "80,,7,,-,,,,,,,\n";
+
+static void assert_tokenizers_agree(const scenario_schema_t* schema, const char* text,
+                                    size_t len, size_t slack) {
+    static char buffer[sizeof(tokenizer_lines) + SCENARIO_CSV_LOOKAHEAD];
+    scenario_row_t expected;
+    scenario_row_t actual;
+    const char* end = &buffer[len + slack];
+    const char* p = buffer;
+    const char* expected_next = NULL;
+    const char* actual_next = NULL;
+    uint32_t isa = 0U;
+    
+    memset(buffer, '7', sizeof(buffer));
+    memcpy(buffer, text, len);
+    while (p < &buffer[len]) {
+        TEST_ASSERT_TRUE(scenario_set_isa(SCENARIO_ISA_SCALAR));
+        memset(&expected, 0xA5, sizeof(expected));
+        expected_next = scenario_parse_csv_line(schema, p, end, &expected);
+        for (isa = SCENARIO_ISA_SSE42; isa <= SCENARIO_ISA_AVX2; isa++) {
+            if (scenario_set_isa((scenario_isa_e)isa)) {
+                memset(&actual, 0x5A, sizeof(actual));
+                actual_next = scenario_parse_csv_line(schema, p, end, &actual);
+                TEST_ASSERT_TRUE(actual_next == expected_next);
+                assert_rows_equal(&expected, &actual);
+            }
+        }
+        p = expected_next;
+    }
+}
+
+void test_scenario_csv_tokenizers_agree(void) {
+    scenario_schema_t schema;
+    const char header[] = "imu_yaw,ms,voice_cmd,speed_kph,distance_mm,lidar_q,cabin_tc_x10\n";
+    size_t len = sizeof(tokenizer_lines) - 1U;
+    scenario_isa_e saved = scenario_get_isa();
+    
+    scenario_schema_default(&schema);
+    assert_tokenizers_agree(&schema, tokenizer_lines, len, SCENARIO_CSV_LOOKAHEAD);
+    /* No slack: the last lines are finished by the scalar fallback. */
+    assert_tokenizers_agree(&schema, tokenizer_lines, len, 0U);
+    
+    TEST_ASSERT_TRUE(scenario_schema_resolve(&schema, header, sizeof(header) - 1U));
+    assert_tokenizers_agree(&schema, tokenizer_lines, len, SCENARIO_CSV_LOOKAHEAD);
+    
+    TEST_ASSERT_TRUE(scenario_set_isa(saved));
+}
+
+void test_scenario_stream_matches_buffered(void) {
+    write_file(TEST_HEADER
+               "0,2000,0,50,50,0,0,220,250,45,220,\n"
+               "100,1900,5,52,0,1,5200,-15,-250,45,-5,hey car set temp 23\r\n"
+               "200,1800\n"
+               "300,1700,7,60,0,0,0,221,250,45,220,last line");
+    
+    TEST_ASSERT_EQUAL_UINT32(4U, compare_with(open_stream));
+}
+
+void test_scenario_stream_crosses_chunks_and_blocks(void) {
+    FILE* file = fopen(TEST_CSV, "wb");
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    fputs(TEST_HEADER, file);
+    for (i = 0U; i < 40000U; i++) {
+        fprintf(file, "%u,%u,%u,60,0,0,0,-%u,250,45,220,%s\n",
+                i * 10U, 1000U + (i % 977U), i % 101U, i % 300U,
+                ((i % 1000U) == 0U) ? "hey car" : "");
+    }
+    fclose(file);
+    
+    TEST_ASSERT_EQUAL_UINT32(40000U, compare_with(open_stream));
+}
+
+/* An over-long line keeps its head in every reader: one across the first
+ * chunk boundary and one longer than a whole chunk. */
+void test_scenario_stream_keeps_head_of_long_line(void) {
+    FILE* file = fopen(TEST_CSV, "wb");
+    uint32_t i = 0U;
+    uint32_t rows = 0U;
+    uint32_t x = 0U;
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    fputs(TEST_HEADER, file);
+    while (ftell(file) < (long)(SCENARIO_STREAM_CHUNK - 2000U)) {
+        fprintf(file, "%u,%u,20,60,0,0,0,220,250,45,220,\n", rows * 10U, 1000U + rows);
+        rows++;
+    }
+    for (i = 0U; i < 2U; i++) {
+        fprintf(file, "%u,1500,20,60,0,0,0,220,250,45,220,hey car ", rows * 10U);
+        for (x = 0U; x < ((i == 0U) ? 20000U : (SCENARIO_STREAM_CHUNK + 5000U)); x++) {
+            fputc('x', file);
+        }
+        fputc('\n', file);
+        rows++;
+        fprintf(file, "%u,900,20,60,0,0,0,220,250,45,220,\n", rows * 10U);
+        rows++;
+    }
+    fclose(file);
+    
+    TEST_ASSERT_EQUAL_UINT32(rows, compare_readers());
+    TEST_ASSERT_EQUAL_UINT32(rows, compare_with(open_stream));
+}
+
+void test_scenario_stream_close_before_end(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    test_scenario_stream_crosses_chunks_and_blocks();
+    
+    TEST_ASSERT_TRUE(open_stream(&reader, TEST_CSV));
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(0U, row.ms);
+    scenario_reader_close(&reader);
+}
+
+#define TEST_LOAD_ROWS (3000U)
+
+static scenario_row_t loaded[TEST_LOAD_ROWS];
+
+static void write_load_file(uint32_t rows, uint32_t bad_row, bool final_newline) {
+    FILE* file = fopen(TEST_CSV, "wb");
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_TRUE(file != NULL);
+    fputs(TEST_HEADER, file);
+    for (i = 0U; i < rows; i++) {
+        fprintf(file, "%u,%u,%u,60,0,%u,0,-%u,250,45,220,%s%s",
+                i * 10U, 1000U + (i % 977U), i % 101U, i & 1U, i % 300U,
+                ((i % 250U) == 0U) ? "hey car, set temp 21" : "",
+                (i == bad_row) ? "\n\n" : "\n");
+    }
+    if (!final_newline) {
+        fputs("99999,1,2,3,4,0,5,6,7,8,9,tail", file);
+    }
+    fclose(file);
+}
+
+/* Every thread count must give the rows the sequential reader gives. */
+void test_scenario_load_matches_reader(void) {
+    static const uint32_t thread_counts[] = {1U, 2U, 7U, 64U, 0U};
+    scenario_load_result_t result;
+    scenario_reader_t reader;
+    scenario_row_t row;
+    uint32_t t = 0U;
+    uint32_t i = 0U;
+    
+    write_load_file(TEST_LOAD_ROWS - 1U, TEST_LOAD_ROWS, false);
+    
+    TEST_ASSERT_FALSE(scenario_load(TEST_CSV, 4U, NULL, 0U, &result));
+    TEST_ASSERT_EQUAL_INT(SCENARIO_LOAD_TOO_SMALL, result.status);
+    TEST_ASSERT_EQUAL_UINT32(TEST_LOAD_ROWS, (uint32_t)result.row_count);
+    
+    for (t = 0U; t < (sizeof(thread_counts) / sizeof(thread_counts[0])); t++) {
+        memset(loaded, 0, sizeof(loaded));
+        TEST_ASSERT_TRUE(scenario_load(TEST_CSV, thread_counts[t], loaded, TEST_LOAD_ROWS,
+                                       &result));
+        TEST_ASSERT_EQUAL_INT(SCENARIO_LOAD_OK, result.status);
+        TEST_ASSERT_EQUAL_UINT32(TEST_LOAD_ROWS, (uint32_t)result.row_count);
+        
+        TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+        for (i = 0U; i < TEST_LOAD_ROWS; i++) {
+            TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+            assert_rows_equal(&row, &loaded[i]);
+        }
+        TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+        scenario_reader_close(&reader);
+    }
+    TEST_ASSERT_TRUE(strcmp("tail", loaded[TEST_LOAD_ROWS - 1U].voice_cmd) == 0);
+}
+
+void test_scenario_load_reports_first_bad_row(void) {
+    scenario_load_result_t result;
+    FILE* file = NULL;
+    char line[64];
+    long offset = 0;
+    
+    /* Row 1234 is followed by a blank line, which becomes row 1235. */
+    write_load_file(2000U, 1234U, true);
+    file = fopen(TEST_CSV, "rb");
+    TEST_ASSERT_TRUE(file != NULL);
+    while ((fgets(line, (int)sizeof(line), file) != NULL) && (line[0] != '\n')) {
+        offset = ftell(file);
+    }
+    fclose(file);
+    
+    memset(loaded, 0, sizeof(loaded));
+    TEST_ASSERT_FALSE(scenario_load(TEST_CSV, 7U, loaded, TEST_LOAD_ROWS, &result));
+    TEST_ASSERT_EQUAL_INT(SCENARIO_LOAD_BAD_ROW, result.status);
+    TEST_ASSERT_EQUAL_UINT32(2001U, (uint32_t)result.row_count);
+    TEST_ASSERT_EQUAL_UINT32(1235U, (uint32_t)result.error_row);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)offset, (uint32_t)result.error_offset);
+    TEST_ASSERT_EQUAL_UINT32(12340U, loaded[1234].ms);
+}
+
+void test_scenario_csv_line_validation(void) {
+    scenario_schema_t schema;
+    const char header[] = "ms,lidar_q,speed_kph,voice_cmd\n";
+    
+    scenario_schema_default(&schema);
+    TEST_ASSERT_TRUE(scenario_csv_line_valid(&schema, "0,1,2,3,4,5,6,-7,8,9,10,hey, car\n"));
+    TEST_ASSERT_TRUE(scenario_csv_line_valid(&schema, "0,1,2,3,4,5,6,7,8,9,10,\r\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "0,1,2,3,4,5,6,7,8,9,10\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "0,1,2,3,4,5,6,7x,8,9,10,\n"));
+    TEST_ASSERT_TRUE(scenario_csv_line_valid(&schema, "0,1,,3,4,5,6,7,8,9,,\n"));
+    TEST_ASSERT_TRUE(scenario_csv_line_valid(&schema, "0,,,,,,,,,,,\r\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, ",1,2,3,4,5,6,7,8,9,10,\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "0,1,-,3,4,5,6,7,8,9,10,\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "0,12345678901,2,3,4,5,6,7,8,9,10,\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "\n"));
+    
+    TEST_ASSERT_TRUE(scenario_schema_resolve(&schema, header, sizeof(header) - 1U));
+    TEST_ASSERT_TRUE(scenario_csv_line_valid(&schema, "10,n/a,-5,\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "10,n/a,-,\n"));
+    TEST_ASSERT_FALSE(scenario_csv_line_valid(&schema, "10,n/a\n"));
+}
+
+void test_scenario_gen_parses_description(void) {
+    scenario_gen_params_t params;
+    
+    TEST_ASSERT_TRUE(scenario_gen_parse(&params, ""));
+    TEST_ASSERT_EQUAL_INT(100, params.step_ms);
+    TEST_ASSERT_TRUE(scenario_gen_parse(&params, "seed=9, rows=50\nambient_x10=-40,"));
+    TEST_ASSERT_EQUAL_INT(9, params.seed);
+    TEST_ASSERT_EQUAL_INT(50, params.rows);
+    TEST_ASSERT_EQUAL_INT(-40, params.ambient_x10);
+    TEST_ASSERT_EQUAL_INT(120, params.speed_max_kph);
+    
+    TEST_ASSERT_FALSE(scenario_gen_parse(&params, "seeds=9"));
+    TEST_ASSERT_FALSE(scenario_gen_parse(&params, "seed=9x"));
+    TEST_ASSERT_FALSE(scenario_gen_parse(&params, "seed"));
+    TEST_ASSERT_FALSE(scenario_gen_parse(&params, "rows=99999999999"));
+    TEST_ASSERT_FALSE(scenario_gen_parse(&params, "step_ms=0"));
+}
+
+/* Same description, same rows; another seed changes them. */
+void test_scenario_gen_is_deterministic(void) {
+    static scenario_gen_t gen_a;
+    static scenario_gen_t gen_b;
+    scenario_reader_t reader_a;
+    scenario_reader_t reader_b;
+    scenario_row_t row_a;
+    scenario_row_t row_b;
+    uint32_t rows = 0U;
+    uint32_t differing = 0U;
+    
+    TEST_ASSERT_TRUE(scenario_reader_open_generated(&reader_a, &gen_a, "seed=3,rows=20000"));
+    TEST_ASSERT_TRUE(scenario_reader_open_generated(&reader_b, &gen_b, "seed=3,rows=20000"));
+    while (scenario_reader_next(&reader_a, &row_a)) {
+        TEST_ASSERT_TRUE(scenario_reader_next(&reader_b, &row_b));
+        assert_rows_equal(&row_a, &row_b);
+        TEST_ASSERT_EQUAL_UINT32(rows * 100U, row_a.ms);
+        rows++;
+    }
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader_b, &row_b));
+    TEST_ASSERT_EQUAL_UINT32(20000U, rows);
+    scenario_reader_close(&reader_a);
+    scenario_reader_close(&reader_b);
+    
+    TEST_ASSERT_TRUE(scenario_reader_open_generated(&reader_a, &gen_a, "seed=3,rows=2000"));
+    TEST_ASSERT_TRUE(scenario_reader_open_generated(&reader_b, &gen_b, "seed=4,rows=2000"));
+    while (scenario_reader_next(&reader_a, &row_a) && scenario_reader_next(&reader_b, &row_b)) {
+        differing += (row_a.speed_kph != row_b.speed_kph) ? 1U : 0U;
+    }
+    TEST_ASSERT_TRUE(differing > 1000U);
+    scenario_reader_close(&reader_a);
+    scenario_reader_close(&reader_b);
+}
+
+void test_scenario_gen_events(void) {
+    scenario_gen_params_t params;
+    scenario_gen_t gen;
+    scenario_row_t row;
+    uint32_t closest_mm = 0xFFFFU;
+    uint32_t gaps = 0U;
+    uint32_t signs = 0U;
+    uint32_t voices = 0U;
+    uint32_t max_rain = 0U;
+    uint32_t speed_lo = 0xFFFFU;
+    uint32_t speed_hi = 0U;
+    
+    TEST_ASSERT_TRUE(scenario_gen_parse(&params, "rows=6000,obstacle_every_ms=60000,"
+                                                 "gap_every_ms=100000,sign_every_ms=200000,"
+                                                 "voice_every_ms=300000,speed_ramp_ms=600000"));
+    scenario_gen_start(&gen, &params);
+    while (scenario_gen_next(&gen, &row)) {
+        closest_mm = (row.distance_mm < closest_mm) ? row.distance_mm : closest_mm;
+        gaps += row.gap_found ? 1U : 0U;
+        signs += (row.sign_event != 0U) ? 1U : 0U;
+        voices += (row.voice_cmd[0] != '\0') ? 1U : 0U;
+        max_rain = (row.rain_pct > max_rain) ? row.rain_pct : max_rain;
+        speed_lo = (row.speed_kph < speed_lo) ? row.speed_kph : speed_lo;
+        speed_hi = (row.speed_kph > speed_hi) ? row.speed_kph : speed_hi;
+        if (row.gap_found) {
+            TEST_ASSERT_TRUE((row.gap_width_mm >= 4000U) && (row.gap_width_mm < 7000U));
+        }
+    }
+    
+    /* 600 s of driving: nine obstacles, five gaps, two signs, one voice
+     * command, and one full speed ramp. */
+    TEST_ASSERT_TRUE(closest_mm < 1000U);
+    TEST_ASSERT_EQUAL_UINT32(5U, gaps);
+    TEST_ASSERT_EQUAL_UINT32(2U, signs);
+    TEST_ASSERT_EQUAL_UINT32(1U, voices);
+    TEST_ASSERT_TRUE(max_rain <= 90U);
+    TEST_ASSERT_TRUE(speed_lo <= 32U);
+    TEST_ASSERT_TRUE(speed_hi >= 118U);
+}
+
+/* Empty cells and cells a short row lacks are unsampled channels. */
+void test_scenario_multirate_rows_mark_sampled_channels(void) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    write_file("ms,distance_mm,lidar_q,cabin_tc_x10,voice_cmd\n"
+               "0,2000,0.5,215,\n"
+               "20,1990,,,\n"
+               "40,,n/a,216\r\n"
+               "60\n");
+    
+    TEST_ASSERT_TRUE(scenario_reader_open(&reader, TEST_CSV));
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(SCENARIO_SAMPLED_ALL, row.sampled);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(SCENARIO_SAMPLED_ALL & ~SCENARIO_SAMPLED(cabin_tc_x10), row.sampled);
+    TEST_ASSERT_EQUAL_UINT16(1990U, row.distance_mm);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(SCENARIO_SAMPLED_ALL & ~SCENARIO_SAMPLED(distance_mm), row.sampled);
+    TEST_ASSERT_EQUAL_INT(216, row.cabin_tc_x10);
+    TEST_ASSERT_TRUE(scenario_reader_next(&reader, &row));
+    TEST_ASSERT_EQUAL_UINT32(SCENARIO_SAMPLED_ALL & ~SCENARIO_SAMPLED(distance_mm) &
+                             ~SCENARIO_SAMPLED(cabin_tc_x10), row.sampled);
+    TEST_ASSERT_FALSE(scenario_reader_next(&reader, &row));
+    scenario_reader_close(&reader);
+    
+    TEST_ASSERT_EQUAL_UINT32(4U, compare_readers());
+    TEST_ASSERT_EQUAL_UINT32(4U, compare_with(open_stream));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_scenario_mapped_matches_buffered);
+    RUN_TEST(test_scenario_mapped_parses_values);
+    RUN_TEST(test_scenario_truncates_long_voice_command);
+    RUN_TEST(test_scenario_without_final_newline_uses_stdio);
+    RUN_TEST(test_scenario_header_only_has_no_rows);
+    RUN_TEST(test_scenario_reads_compiled_columns);
+    RUN_TEST(test_scenario_rejects_unknown_compiled_version);
+    RUN_TEST(test_scenario_header_reorders_and_skips_columns);
+    RUN_TEST(test_scenario_reader_reports_recorded_channels);
+    RUN_TEST(test_scenario_header_first_duplicate_wins);
+    RUN_TEST(test_scenario_header_without_ms_is_rejected);
+    RUN_TEST(test_scenario_csv_tokenizers_agree);
+    RUN_TEST(test_scenario_stream_matches_buffered);
+    RUN_TEST(test_scenario_stream_crosses_chunks_and_blocks);
+    RUN_TEST(test_scenario_stream_keeps_head_of_long_line);
+    RUN_TEST(test_scenario_stream_close_before_end);
+    RUN_TEST(test_scenario_csv_line_validation);
+    RUN_TEST(test_scenario_load_matches_reader);
+    RUN_TEST(test_scenario_load_reports_first_bad_row);
+    RUN_TEST(test_scenario_gen_parses_description);
+    RUN_TEST(test_scenario_gen_is_deterministic);
+    RUN_TEST(test_scenario_gen_events);
+    RUN_TEST(test_scenario_multirate_rows_mark_sampled_channels);
+    
+    return UNITY_END();
+}
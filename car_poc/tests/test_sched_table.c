@@ -0,0 +1,86 @@
+#include "unity.h"
+#include <stddef.h>
+#include "sched_table.h"
+
+static uint32_t call_count[SCHED_NUM_SLOTS];
+static sched_id_e call_order[SCHED_NUM_SLOTS];
+static uint32_t calls_in_frame = 0U;
+
+static void record_dispatch(sched_id_e id, void* arg) {
+    (void)arg;
+    call_count[id]++;
+    if (calls_in_frame < (uint32_t)SCHED_NUM_SLOTS) {
+        call_order[calls_in_frame] = id;
+    }
+    calls_in_frame++;
+}
+
+void setUp(void) {
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < (uint32_t)SCHED_NUM_SLOTS; i++) {
+        call_count[i] = 0U;
+    }
+    calls_in_frame = 0U;
+}
+
+void tearDown(void) {
+}
+
+void test_sched_major_frame_runs_each_slot_at_its_rate(void) {
+    uint32_t frame = 0U;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < SCHED_MAJOR_FRAMES; i++) {
+        sched_run_frame(frame, record_dispatch, NULL);
+        frame = sched_next_frame(frame);
+    }
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, frame);
+    for (i = 0U; i < (uint32_t)SCHED_NUM_SLOTS; i++) {
+        const sched_slot_t* slot = sched_slot((sched_id_e)i);
+        TEST_ASSERT_EQUAL_UINT32(SCHED_MAJOR_FRAME_MS / slot->period_ms, call_count[i]);
+    }
+}
+
+void test_sched_slots_run_at_their_phase(void) {
+    uint32_t frame = 0U;
+    
+    for (frame = 0U; frame < SCHED_MAJOR_FRAMES; frame++) {
+        calls_in_frame = 0U;
+        call_count[SCHED_ID_autopark] = 0U;
+        sched_run_frame(frame, record_dispatch, NULL);
+        TEST_ASSERT_EQUAL_UINT32(
+            ((frame * SCHED_MINOR_FRAME_MS) % SCHED_AUTOPARK_PERIOD_MS) == 20U ? 1U : 0U,
+            call_count[SCHED_ID_autopark]);
+    }
+}
+
+void test_sched_dispatches_in_priority_order(void) {
+    uint32_t frame = 0U;
+    uint32_t i = 0U;
+    
+    for (frame = 0U; frame < SCHED_MAJOR_FRAMES; frame++) {
+        calls_in_frame = 0U;
+        sched_run_frame(frame, record_dispatch, NULL);
+        for (i = 1U; i < calls_in_frame; i++) {
+            TEST_ASSERT_TRUE(sched_slot(call_order[i - 1U])->priority <
+                             sched_slot(call_order[i])->priority);
+        }
+    }
+}
+
+void test_sched_rejects_unknown_slot(void) {
+    TEST_ASSERT_TRUE(sched_slot(SCHED_NUM_SLOTS) == NULL);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    
+    RUN_TEST(test_sched_major_frame_runs_each_slot_at_its_rate);
+    RUN_TEST(test_sched_slots_run_at_their_phase);
+    RUN_TEST(test_sched_dispatches_in_priority_order);
+    RUN_TEST(test_sched_rejects_unknown_slot);
+    
+    return UNITY_END();
+}
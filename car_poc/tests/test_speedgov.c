@@ -1,5 +1,7 @@
 #include "unity.h"
 #include "app_speedgov.h"
+#include "calib.h"
+#include <string.h>
 
 static uint16_t mock_speed_kph = 50U;
 static uint32_t mock_timestamp_ms = 50U;
@@ -95,6 +97,91 @@ void test_speedgov_limit_update(void) {
     TEST_ASSERT_EQUAL_UINT16(80U, mock_limit_request);
 }
 
+/* The if/else chain SPEEDGOV_FSM replaced, with the same wrapping
+ * thresholds. */
+static void reference_speedgov(speedgov_state_t* ctx, uint16_t speed_kph) {
+    uint16_t overspeed_threshold = (uint16_t)(ctx->current_limit_kph + SPEED_ALARM_TOL_KPH);
+    uint16_t clear_threshold = (uint16_t)(ctx->current_limit_kph - SPEED_HYSTERESIS_KPH);
+    
+    if (ctx->alarm_active) {
+        if (speed_kph < clear_threshold) {
+            ctx->alarm_active = false;
+            ctx->overspeed_count = 0U;
+        }
+    } else {
+        if (speed_kph > overspeed_threshold) {
+            if (ctx->overspeed_count < SPEED_ALARM_DEBOUNCE) {
+                ctx->overspeed_count++;
+            }
+            if (ctx->overspeed_count >= SPEED_ALARM_DEBOUNCE) {
+                ctx->alarm_active = true;
+            }
+        } else {
+            ctx->overspeed_count = 0U;
+        }
+    }
+}
+
+static void step_at(speedgov_state_t* ctx, uint16_t speed_kph) {
+    hal_io_t io;
+    
+    memset(&io, 0, sizeof(io));
+    io.in.now_ms = 100U;
+    io.in.speed_ts_ms = 100U;
+    io.in.speed_valid = true;
+    io.in.speed_kph = speed_kph;
+    app_speedgov_step_ctx(ctx, &io);
+}
+
+/* Every reachable state against every speed, for limits down to zero,
+ * where the clear threshold wraps and both FSM input bits are set. */
+void test_speedgov_fsm_matches_reference_for_every_state_and_input(void) {
+    speedgov_state_t ctx;
+    speedgov_state_t expected;
+    uint32_t mismatches = 0U;
+    uint32_t limit = 0U;
+    uint32_t speed = 0U;
+    uint32_t count = 0U;
+    
+    for (limit = 0U; limit < 300U; limit++) {
+        for (speed = 0U; speed < 400U; speed++) {
+            for (count = 0U; count <= SPEED_ALARM_DEBOUNCE; count++) {
+                ctx.current_limit_kph = (uint16_t)limit;
+                ctx.overspeed_count = (uint8_t)count;
+                ctx.alarm_active = (count == SPEED_ALARM_DEBOUNCE);
+                expected = ctx;
+                
+                step_at(&ctx, (uint16_t)speed);
+                reference_speedgov(&expected, (uint16_t)speed);
+                
+                if ((ctx.overspeed_count != expected.overspeed_count) ||
+                    (ctx.alarm_active != expected.alarm_active)) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, mismatches);
+}
+
+/* Below SPEED_HYSTERESIS_KPH every speed is "clearing", so an overspeed
+ * raises the alarm and the next step clears it again, as it always did. */
+void test_speedgov_limit_below_hysteresis_sets_both_inputs(void) {
+    speedgov_state_t ctx;
+    
+    app_speedgov_init_ctx(&ctx);
+    ctx.current_limit_kph = SPEED_HYSTERESIS_KPH - 2U;
+    
+    step_at(&ctx, 20U);
+    TEST_ASSERT_FALSE(ctx.alarm_active);
+    step_at(&ctx, 20U);
+    TEST_ASSERT_TRUE(ctx.alarm_active);
+    step_at(&ctx, 20U);
+    TEST_ASSERT_FALSE(ctx.alarm_active);
+    TEST_ASSERT_EQUAL_UINT8(0U, ctx.overspeed_count);
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -102,6 +189,8 @@ int main(void) {
     RUN_TEST(test_speedgov_alarm_over_limit_with_debounce);
     RUN_TEST(test_speedgov_alarm_clear_with_hysteresis);
     RUN_TEST(test_speedgov_limit_update);
+    RUN_TEST(test_speedgov_fsm_matches_reference_for_every_state_and_input);
+    RUN_TEST(test_speedgov_limit_below_hysteresis_sets_both_inputs);
     
     return UNITY_END();
 }
\ No newline at end of file
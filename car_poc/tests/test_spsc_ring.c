@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "unity.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include "spsc_ring.h"
+
+#define TEST_THREAD_MESSAGES (200000U)
+#define TEST_THREAD_SLOTS    (7U)
+
+static spsc_ring_t ring;
+static uint32_t storage[TEST_THREAD_SLOTS];
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_spsc_ring_sides_on_separate_cache_lines(void) {
+    TEST_ASSERT_TRUE((offsetof(spsc_ring_t, tail) - offsetof(spsc_ring_t, head)) >=
+                     SPSC_RING_CACHE_LINE);
+    TEST_ASSERT_TRUE((offsetof(spsc_ring_t, capacity) - offsetof(spsc_ring_t, tail)) >=
+                     SPSC_RING_CACHE_LINE);
+}
+
+void test_spsc_ring_starts_empty(void) {
+    uint32_t slot = 99U;
+    
+    spsc_ring_init(&ring, 3U);
+    TEST_ASSERT_FALSE(spsc_ring_peek(&ring, &slot));
+    TEST_ASSERT_TRUE(spsc_ring_acquire(&ring, &slot));
+    TEST_ASSERT_EQUAL_UINT32(0U, slot);
+    TEST_ASSERT_TRUE(spsc_ring_acquire(&ring, &slot));
+    TEST_ASSERT_EQUAL_UINT32(0U, slot);
+}
+
+void test_spsc_ring_full_until_released(void) {
+    uint32_t slot = 0U;
+    uint32_t i = 0U;
+    
+    spsc_ring_init(&ring, 3U);
+    for (i = 0U; i < 3U; i++) {
+        TEST_ASSERT_TRUE(spsc_ring_acquire(&ring, &slot));
+        TEST_ASSERT_EQUAL_UINT32(i, slot);
+        spsc_ring_publish(&ring);
+    }
+    TEST_ASSERT_FALSE(spsc_ring_acquire(&ring, &slot));
+    
+    TEST_ASSERT_TRUE(spsc_ring_peek(&ring, &slot));
+    TEST_ASSERT_EQUAL_UINT32(0U, slot);
+    TEST_ASSERT_FALSE(spsc_ring_acquire(&ring, &slot));
+    spsc_ring_release(&ring);
+    
+    TEST_ASSERT_TRUE(spsc_ring_acquire(&ring, &slot));
+    TEST_ASSERT_EQUAL_UINT32(0U, slot);
+}
+
+/* Slots come back in order across many wraps, with the ring at every fill
+ * level from empty to full. */
+void test_spsc_ring_keeps_order_across_wraps(void) {
+    uint32_t values[5];
+    uint32_t slot = 0U;
+    uint32_t next_in = 0U;
+    uint32_t next_out = 0U;
+    uint32_t round = 0U;
+    
+    spsc_ring_init(&ring, 5U);
+    for (round = 0U; round < 1000U; round++) {
+        while ((next_in < (next_out + ((round % 5U) + 1U))) && spsc_ring_acquire(&ring, &slot)) {
+            values[slot] = next_in;
+            next_in++;
+            spsc_ring_publish(&ring);
+        }
+        while (spsc_ring_peek(&ring, &slot)) {
+            TEST_ASSERT_EQUAL_UINT32(next_out, values[slot]);
+            next_out++;
+            spsc_ring_release(&ring);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(next_in, next_out);
+    TEST_ASSERT_TRUE(next_out > 2000U);
+}
+
+/* Indices run freely, so a ring that has carried 2^32 slots still works. */
+void test_spsc_ring_index_wraps(void) {
+    uint32_t slot = 0U;
+    uint32_t i = 0U;
+    
+    spsc_ring_init(&ring, 4U);
+    ring.head = UINT32_MAX - 1U;
+    ring.tail = UINT32_MAX - 1U;
+    ring.tail_cache = UINT32_MAX - 1U;
+    ring.head_cache = UINT32_MAX - 1U;
+    for (i = 0U; i < 4U; i++) {
+        TEST_ASSERT_TRUE(spsc_ring_acquire(&ring, &slot));
+        spsc_ring_publish(&ring);
+    }
+    TEST_ASSERT_FALSE(spsc_ring_acquire(&ring, &slot));
+    for (i = 0U; i < 4U; i++) {
+        TEST_ASSERT_TRUE(spsc_ring_peek(&ring, &slot));
+        TEST_ASSERT_EQUAL_UINT32(i, slot);
+        spsc_ring_release(&ring);
+    }
+    TEST_ASSERT_FALSE(spsc_ring_peek(&ring, &slot));
+}
+
+static void* producer_main(void* arg) {
+    uint32_t slot = 0U;
+    uint32_t i = 0U;
+    
+    (void)arg;
+    for (i = 0U; i < TEST_THREAD_MESSAGES; i++) {
+        while (!spsc_ring_acquire(&ring, &slot)) {
+            sched_yield();
+        }
+        storage[slot] = i;
+        spsc_ring_publish(&ring);
+    }
+    
+    return NULL;
+}
+
+void test_spsc_ring_hands_over_between_threads(void) {
+    pthread_t producer;
+    uint32_t slot = 0U;
+    uint32_t expected = 0U;
+    uint32_t mismatches = 0U;
+    
+    spsc_ring_init(&ring, TEST_THREAD_SLOTS);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, producer_main, NULL));
+    while (expected < TEST_THREAD_MESSAGES) {
+        if (!spsc_ring_peek(&ring, &slot)) {
+            sched_yield();
+            continue;
+        }
+        mismatches += (storage[slot] != expected) ? 1U : 0U;
+        expected++;
+        spsc_ring_release(&ring);
+    }
+    (void)pthread_join(producer, NULL);
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, mismatches);
+    TEST_ASSERT_FALSE(spsc_ring_peek(&ring, &slot));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_spsc_ring_sides_on_separate_cache_lines);
+    RUN_TEST(test_spsc_ring_starts_empty);
+    RUN_TEST(test_spsc_ring_full_until_released);
+    RUN_TEST(test_spsc_ring_keeps_order_across_wraps);
+    RUN_TEST(test_spsc_ring_index_wraps);
+    RUN_TEST(test_spsc_ring_hands_over_between_threads);
+    return UNITY_END();
+}
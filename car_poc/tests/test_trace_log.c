@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "unity.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include "trace_log.h"
+
+#define TEST_THREAD_ENTRIES (20000U)
+
+static trace_log_t trace;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static uint32_t format_next(char* text, uint32_t size) {
+    uint32_t slot = 0U;
+    uint32_t len = 0U;
+    
+    TEST_ASSERT_TRUE(spsc_ring_peek(&trace.ring, &slot));
+    len = trace_log_format(&trace.entries[slot], text, size);
+    spsc_ring_release(&trace.ring);
+    return len;
+}
+
+void test_trace_log_formats_like_printf(void) {
+    char expected[TRACE_LOG_TEXT_MAX];
+    char text[TRACE_LOG_TEXT_MAX];
+    uint32_t len = 0U;
+    
+    trace_log_init(&trace);
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_VOICE_COMMAND));
+    trace_log_str(&trace, "hey car open sunroof");
+    trace_log_str(&trace, "Opening sunroof");
+    trace_log_commit(&trace);
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_TEST_NUMBERS));
+    trace_log_u32(&trace, UINT32_MAX);
+    trace_log_i32(&trace, -42);
+    trace_log_u32(&trace, 0xBEEFU);
+    trace_log_commit(&trace);
+    
+    len = format_next(text, sizeof(text));
+    (void)snprintf(expected, sizeof(expected), "Voice: %s -> %s\n", "hey car open sunroof",
+                   "Opening sunroof");
+    TEST_ASSERT_EQUAL_INT((int)strlen(expected), (int)len);
+    TEST_ASSERT_TRUE(strcmp(expected, text) == 0);
+    
+    len = format_next(text, sizeof(text));
+    (void)snprintf(expected, sizeof(expected), "u=%u d=%d x=%x 100%%\n", UINT32_MAX, -42, 0xBEEFU);
+    TEST_ASSERT_EQUAL_INT((int)strlen(expected), (int)len);
+    TEST_ASSERT_TRUE(strcmp(expected, text) == 0);
+}
+
+/* Strings are cut to the entry, missing arguments end the text early, and
+ * a short text buffer is never overrun. */
+void test_trace_log_truncates_safely(void) {
+    char long_text[2U * TRACE_LOG_ARG_BYTES];
+    char text[TRACE_LOG_TEXT_MAX];
+    uint32_t len = 0U;
+    
+    memset(long_text, 'a', sizeof(long_text) - 1U);
+    long_text[sizeof(long_text) - 1U] = '\0';
+    trace_log_init(&trace);
+    
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_VOICE_COMMAND));
+    trace_log_str(&trace, long_text);
+    trace_log_str(&trace, "never stored");
+    trace_log_commit(&trace);
+    len = format_next(text, sizeof(text));
+    TEST_ASSERT_EQUAL_INT((int)(strlen("Voice: ") + TRACE_LOG_ARG_BYTES - 1U + strlen(" -> ")),
+                          (int)len);
+    
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_TEST_NUMBERS));
+    trace_log_u32(&trace, 7U);
+    trace_log_commit(&trace);
+    len = format_next(text, sizeof(text));
+    TEST_ASSERT_TRUE(strcmp("u=7 d=", text) == 0);
+    
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_VOICE_COMMAND));
+    trace_log_str(&trace, "hey car navigate home");
+    trace_log_str(&trace, "Navigating to home");
+    trace_log_commit(&trace);
+    len = format_next(text, 12U);
+    TEST_ASSERT_EQUAL_INT(11, (int)len);
+    TEST_ASSERT_TRUE(strcmp("Voice: hey ", text) == 0);
+}
+
+void test_trace_log_drops_when_full(void) {
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_FALSE(trace_log_begin(NULL, TRACE_ID_VOICE_COMMAND));
+    
+    trace_log_init(&trace);
+    for (i = 0U; i < (TRACE_LOG_SLOTS + 5U); i++) {
+        if (trace_log_begin(&trace, TRACE_ID_TEST_NUMBERS)) {
+            trace_log_u32(&trace, i);
+            trace_log_i32(&trace, 0);
+            trace_log_u32(&trace, 0U);
+            trace_log_commit(&trace);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(5U, trace.dropped);
+    
+    trace_log_init(&trace);
+    TEST_ASSERT_TRUE(trace_log_begin(&trace, TRACE_ID_VOICE_COMMAND));
+    TEST_ASSERT_EQUAL_UINT32(0U, trace.dropped);
+}
+
+static void* writer_main(void* arg) {
+    uint32_t i = 0U;
+    
+    (void)arg;
+    for (i = 0U; i < TEST_THREAD_ENTRIES; i++) {
+        while (!trace_log_begin(&trace, TRACE_ID_TEST_NUMBERS)) {
+            sched_yield();
+        }
+        trace_log_u32(&trace, i);
+        trace_log_i32(&trace, -(int32_t)i);
+        trace_log_u32(&trace, i);
+        trace_log_commit(&trace);
+    }
+    
+    return NULL;
+}
+
+/* Entries written on one thread come out complete and in order on the
+ * draining one. */
+void test_trace_log_drains_across_threads(void) {
+    FILE* sink = tmpfile();
+    pthread_t writer;
+    char expected[TRACE_LOG_TEXT_MAX];
+    char line[TRACE_LOG_TEXT_MAX];
+    uint32_t drained = 0U;
+    uint32_t mismatches = 0U;
+    uint32_t i = 0U;
+    
+    TEST_ASSERT_TRUE(sink != NULL);
+    trace_log_init(&trace);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, writer_main, NULL));
+    while (drained < TEST_THREAD_ENTRIES) {
+        drained += trace_log_drain(&trace, sink);
+        sched_yield();
+    }
+    (void)pthread_join(writer, NULL);
+    
+    rewind(sink);
+    for (i = 0U; i < TEST_THREAD_ENTRIES; i++) {
+        (void)snprintf(expected, sizeof(expected), "u=%u d=%d x=%x 100%%\n", i, -(int32_t)i, i);
+        if ((fgets(line, (int)sizeof(line), sink) == NULL) || (strcmp(expected, line) != 0)) {
+            mismatches++;
+        }
+    }
+    fclose(sink);
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, mismatches);
+    TEST_ASSERT_EQUAL_UINT32(TEST_THREAD_ENTRIES, drained);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_trace_log_formats_like_printf);
+    RUN_TEST(test_trace_log_truncates_safely);
+    RUN_TEST(test_trace_log_drops_when_full);
+    RUN_TEST(test_trace_log_drains_across_threads);
+    return UNITY_END();
+}
@@ -1,10 +1,14 @@
 #include "unity.h"
 #include "app_wipers.h"
+#include "calib.h"
+#include <string.h>
 
 static uint8_t mock_rain_pct = 0U;
 static uint32_t mock_timestamp_ms = 0U;
 static uint8_t mock_wiper_mode = 0U;
 static uint32_t mock_current_time = 100U;
+static uint8_t mock_burst[HAL_RAIN_BURST_MAX];
+static uint8_t mock_burst_len = 0U;
 
 uint32_t hal_now_ms(void) {
     return mock_current_time;
@@ -19,6 +23,15 @@ bool hal_read_rain_level_pct(uint8_t* out_pct, uint32_t* out_ts_ms) {
     return false;
 }
 
+uint8_t hal_read_rain_burst(uint8_t* out_pct, uint8_t max, uint32_t* out_ts_ms) {
+    uint8_t n = (mock_burst_len < max) ? mock_burst_len : max;
+    
+    memcpy(out_pct, mock_burst, n);
+    *out_ts_ms = mock_current_time;
+    mock_burst_len = 0U;
+    return n;
+}
+
 void hal_set_wiper_mode(uint8_t mode) {
     mock_wiper_mode = mode;
 }
@@ -28,6 +41,7 @@ void setUp(void) {
     mock_timestamp_ms = 50U;
     mock_wiper_mode = 0U;
     mock_current_time = 100U;
+    mock_burst_len = 0U;
     app_wipers_init();
 }
 
@@ -67,6 +81,7 @@ void test_wipers_high_on_heavy_rain(void) {
 }
 
 void test_wipers_hysteresis_behavior(void) {
+    setUp();
     mock_rain_pct = 25U;
     app_wipers_step();
     TEST_ASSERT_EQUAL_UINT8(1U, mock_wiper_mode);
@@ -80,6 +95,190 @@ void test_wipers_hysteresis_behavior(void) {
     TEST_ASSERT_EQUAL_UINT8(0U, mock_wiper_mode);
 }
 
+/* One tick with a 1 kHz burst of `n` samples at `pct`. */
+static void raw_tick(uint8_t pct, uint8_t n) {
+    memset(mock_burst, pct, n);
+    mock_burst_len = n;
+    mock_current_time += 10U;
+    mock_timestamp_ms = mock_current_time;
+    app_wipers_step();
+}
+
+void test_wipers_raw_burst_drops_droplet_spike(void) {
+    setUp();
+    
+    memset(mock_burst, 15, 10U);
+    mock_burst[4] = 100U;
+    mock_burst_len = 10U;
+    app_wipers_step();
+    
+    TEST_ASSERT_EQUAL_UINT8(0U, mock_wiper_mode);
+}
+
+void test_wipers_raw_stream_replaces_rain_pct(void) {
+    setUp();
+    mock_rain_pct = 80U;
+    
+    raw_tick(30U, 10U);
+    
+    TEST_ASSERT_EQUAL_UINT8(1U, mock_wiper_mode);
+}
+
+/* Rain flickering across the OFF/INT hysteresis band every tick flaps the
+ * wipers on rain_pct, but not through the filter. */
+void test_wipers_raw_noise_does_not_flap(void) {
+    uint32_t changes_pct = 0U;
+    uint32_t changes_raw = 0U;
+    uint8_t last = 0U;
+    uint32_t i = 0U;
+    
+    setUp();
+    for (i = 0U; i < 100U; i++) {
+        mock_rain_pct = ((i % 2U) == 0U) ? 26U : 12U;
+        mock_current_time += 10U;
+        mock_timestamp_ms = mock_current_time;
+        app_wipers_step();
+        changes_pct += (mock_wiper_mode != last) ? 1U : 0U;
+        last = mock_wiper_mode;
+    }
+    
+    setUp();
+    last = 0U;
+    for (i = 0U; i < 100U; i++) {
+        raw_tick(((i % 2U) == 0U) ? 26U : 12U, 10U);
+        changes_raw += (mock_wiper_mode != last) ? 1U : 0U;
+        last = mock_wiper_mode;
+    }
+    
+    TEST_ASSERT_TRUE(changes_pct >= 50U);
+    TEST_ASSERT_TRUE(changes_raw <= 1U);
+    TEST_ASSERT_EQUAL_UINT8(1U, mock_wiper_mode);
+}
+
+void test_wipers_raw_peak_hold_releases_slowly(void) {
+    uint32_t i = 0U;
+    
+    setUp();
+    raw_tick(50U, 10U);
+    raw_tick(50U, 10U);
+    TEST_ASSERT_EQUAL_UINT8(2U, mock_wiper_mode);
+    
+    for (i = 0U; i < 100U; i++) {
+        raw_tick(0U, 10U);
+    }
+    TEST_ASSERT_EQUAL_UINT8(2U, mock_wiper_mode);
+    
+    for (i = 0U; i < 300U; i++) {
+        raw_tick(0U, 10U);
+    }
+    TEST_ASSERT_EQUAL_UINT8(0U, mock_wiper_mode);
+}
+
+void test_wipers_stale_raw_stream_falls_back_to_rain_pct(void) {
+    setUp();
+    raw_tick(50U, 10U);
+    raw_tick(50U, 10U);
+    TEST_ASSERT_EQUAL_UINT8(2U, mock_wiper_mode);
+    
+    mock_rain_pct = 10U;
+    mock_current_time += 200U;
+    mock_timestamp_ms = mock_current_time;
+    app_wipers_step();
+    TEST_ASSERT_EQUAL_UINT8(1U, mock_wiper_mode);
+    app_wipers_step();
+    TEST_ASSERT_EQUAL_UINT8(0U, mock_wiper_mode);
+}
+
+/* Whatever an earlier, longer burst left behind its length is ignored. */
+void test_wipers_burst_ignores_samples_past_its_length(void) {
+    wipers_state_t ctx;
+    hal_io_t io;
+    
+    memset(&io, 0, sizeof(io));
+    app_wipers_init_ctx(&ctx);
+    io.in.now_ms = 100U;
+    io.in.rain_burst_ts_ms = 100U;
+    memset(io.in.rain_burst, 255, HAL_RAIN_BURST_MAX);
+    io.in.rain_burst[0] = 20U;
+    io.in.rain_burst[1] = 40U;
+    io.in.rain_burst[2] = 30U;
+    io.in.rain_burst_len = 3U;
+    
+    app_wipers_step_ctx(&ctx, &io);
+    
+    TEST_ASSERT_EQUAL_UINT16(25U << 8, ctx.rain_level_q8);
+    TEST_ASSERT_EQUAL_UINT8(0U, io.in.rain_burst_len);
+    TEST_ASSERT_EQUAL_UINT8(1U, io.out.wiper_mode);
+    
+    memset(io.in.rain_burst, 200, HAL_RAIN_BURST_MAX);
+    io.in.rain_burst[HAL_RAIN_BURST_MAX - 1U] = 255U;
+    io.in.rain_burst_len = (uint8_t)HAL_RAIN_BURST_MAX;
+    app_wipers_init_ctx(&ctx);
+    app_wipers_step_ctx(&ctx, &io);
+    
+    TEST_ASSERT_EQUAL_UINT16(200U << 8, ctx.rain_level_q8);
+}
+
+/* The if/else chain WIPER_FSM replaced. */
+static uint8_t reference_wiper_mode(uint8_t rain_pct, uint8_t mode) {
+    uint8_t next = mode;
+    
+    if (mode == 0U) {
+        if (rain_pct >= WIPER_T_RAIN_INT) {
+            next = 1U;
+        }
+    } else if (mode == 1U) {
+        if (rain_pct < (WIPER_T_RAIN_INT - 5U)) {
+            next = 0U;
+        } else if (rain_pct >= WIPER_T_RAIN_LOW) {
+            next = 2U;
+        } else {
+        }
+    } else if (mode == 2U) {
+        if (rain_pct < (WIPER_T_RAIN_INT - 5U)) {
+            next = 1U;
+        } else if (rain_pct >= WIPER_T_RAIN_HIGH) {
+            next = 3U;
+        } else {
+        }
+    } else if (mode == 3U) {
+        if (rain_pct < (WIPER_T_RAIN_LOW - 5U)) {
+            next = 2U;
+        }
+    } else {
+    }
+    
+    return next;
+}
+
+void test_wipers_fsm_matches_reference_for_every_state_and_input(void) {
+    wipers_state_t ctx;
+    hal_io_t io;
+    uint32_t mismatches = 0U;
+    uint32_t mode = 0U;
+    uint32_t rain = 0U;
+    
+    for (mode = 0U; mode < 4U; mode++) {
+        for (rain = 0U; rain < 256U; rain++) {
+            memset(&io, 0, sizeof(io));
+            app_wipers_init_ctx(&ctx);
+            ctx.current_mode = (uint8_t)mode;
+            io.in.now_ms = 100U;
+            io.in.rain_ts_ms = 100U;
+            io.in.rain_valid = true;
+            io.in.rain_pct = (uint8_t)rain;
+            
+            app_wipers_step_ctx(&ctx, &io);
+            
+            if (io.out.wiper_mode != reference_wiper_mode((uint8_t)rain, (uint8_t)mode)) {
+                mismatches++;
+            }
+        }
+    }
+    
+    TEST_ASSERT_EQUAL_UINT32(0U, mismatches);
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -88,6 +287,13 @@ int main(void) {
     RUN_TEST(test_wipers_low_on_moderate_rain);
     RUN_TEST(test_wipers_high_on_heavy_rain);
     RUN_TEST(test_wipers_hysteresis_behavior);
+    RUN_TEST(test_wipers_raw_burst_drops_droplet_spike);
+    RUN_TEST(test_wipers_raw_stream_replaces_rain_pct);
+    RUN_TEST(test_wipers_raw_noise_does_not_flap);
+    RUN_TEST(test_wipers_raw_peak_hold_releases_slowly);
+    RUN_TEST(test_wipers_stale_raw_stream_falls_back_to_rain_pct);
+    RUN_TEST(test_wipers_burst_ignores_samples_past_its_length);
+    RUN_TEST(test_wipers_fsm_matches_reference_for_every_state_and_input);
     
     return UNITY_END();
 }
\ No newline at end of file
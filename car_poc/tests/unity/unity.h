@@ -1,6 +1,7 @@
 #ifndef UNITY_H
 #define UNITY_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -0,0 +1,184 @@
+#include "output_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Converts a binary or change-only output log back into the CSV layout
+ * the simulator writes by default, byte for byte. With a start time only
+ * ticks from then on are written; change-only logs skip whole chunks by
+ * their headers to get there. */
+
+#define CONVERT_BLOCK_RECORDS (4096U)
+
+static output_record_t records[CONVERT_BLOCK_RECORDS];
+static uint8_t payload[OUTPUT_DELTA_CHUNK_MAX];
+static char text[CONVERT_BLOCK_RECORDS * OUTPUT_LOG_CSV_LINE_MAX];
+
+static bool check_header(const char* magic, uint16_t version, uint16_t byte_order,
+                         uint32_t record_size) {
+    if ((version != OUTPUT_LOG_VERSION) || (byte_order != OUTPUT_LOG_BYTE_ORDER) ||
+        (record_size != (uint32_t)sizeof(output_record_t))) {
+        fprintf(stderr, "Unsupported %.4s log: version %u, byte order 0x%04x, "
+                "record size %u\n", magic, version, byte_order, record_size);
+        return false;
+    }
+    
+    return true;
+}
+
+/* Formats the first `count` entries of `records` from start_ms on. */
+static bool write_records(FILE* out, uint32_t count, uint32_t start_ms) {
+    size_t len = 0U;
+    uint32_t i = 0U;
+    
+    for (i = 0U; i < count; i++) {
+        if (records[i].ms >= start_ms) {
+            len += output_log_format_csv(&records[i], &text[len]);
+        }
+    }
+    
+    return fwrite(text, 1U, len, out) == len;
+}
+
+static bool convert_binary(FILE* in, FILE* out, uint32_t start_ms, uint64_t* record_count) {
+    output_log_header_t header;
+    size_t got = 0U;
+    
+    if ((fread(&header, sizeof(header), 1U, in) != 1U) ||
+        !check_header(header.magic, header.version, header.byte_order, header.record_size)) {
+        return false;
+    }
+    
+    do {
+        got = fread(records, sizeof(output_record_t), CONVERT_BLOCK_RECORDS, in);
+        if (!write_records(out, (uint32_t)got, start_ms)) {
+            return false;
+        }
+        *record_count += got;
+    } while (got == CONVERT_BLOCK_RECORDS);
+    
+    if (ferror(in) != 0) {
+        return false;
+    }
+    if (fgetc(in) != EOF) {
+        fprintf(stderr, "Trailing partial record\n");
+        return false;
+    }
+    
+    return true;
+}
+
+static bool convert_chunk(FILE* out, const output_delta_chunk_t* chunk, uint32_t start_ms,
+                          uint64_t* record_count) {
+    output_delta_decoder_t decoder;
+    uint32_t count = 0U;
+    
+    output_delta_decode_start(&decoder, chunk, payload);
+    while (output_delta_decode_next(&decoder, &records[count])) {
+        count++;
+        if (count == CONVERT_BLOCK_RECORDS) {
+            if (!write_records(out, count, start_ms)) {
+                return false;
+            }
+            *record_count += count;
+            count = 0U;
+        }
+    }
+    *record_count += count;
+    
+    if (!output_delta_decode_complete(&decoder)) {
+        fprintf(stderr, "Malformed chunk at %u ms\n", chunk->first_ms);
+        return false;
+    }
+    return write_records(out, count, start_ms);
+}
+
+static bool convert_delta(FILE* in, FILE* out, uint32_t start_ms, uint64_t* record_count) {
+    output_delta_header_t header;
+    output_delta_chunk_t chunk;
+    
+    if ((fread(&header, sizeof(header), 1U, in) != 1U) ||
+        !check_header(header.magic, header.version, header.byte_order, header.record_size)) {
+        return false;
+    }
+    
+    while (fread(&chunk, sizeof(chunk), 1U, in) == 1U) {
+        if ((memcmp(chunk.sync, OUTPUT_DELTA_SYNC, 4U) != 0) ||
+            (chunk.payload_len > OUTPUT_DELTA_CHUNK_MAX)) {
+            fprintf(stderr, "Bad chunk header\n");
+            return false;
+        }
+        
+        if (chunk.last_ms < start_ms) {
+            if (fseek(in, (long)chunk.payload_len, SEEK_CUR) != 0) {
+                return false;
+            }
+            continue;
+        }
+        
+        if ((fread(payload, 1U, chunk.payload_len, in) != chunk.payload_len) ||
+            !convert_chunk(out, &chunk, start_ms, record_count)) {
+            return false;
+        }
+    }
+    
+    return (ferror(in) == 0) && (feof(in) != 0);
+}
+
+int main(int argc, char* argv[]) {
+    FILE* in = NULL;
+    FILE* out = NULL;
+    char magic[4];
+    uint32_t start_ms = 0U;
+    uint64_t record_count = 0U;
+    bool ok = false;
+    
+    if ((argc != 3) && (argc != 4)) {
+        printf("Usage: %s <outputs" OUTPUT_LOG_SUFFIX "|outputs" OUTPUT_DELTA_SUFFIX
+               "> <outputs.csv> [start_ms]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 4) {
+        start_ms = (uint32_t)strtoul(argv[3], NULL, 10);
+    }
+    
+    in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    if ((fread(magic, 1U, 4U, in) != 4U) || (fseek(in, 0L, SEEK_SET) != 0) ||
+        ((memcmp(magic, OUTPUT_LOG_MAGIC, 4U) != 0) &&
+         (memcmp(magic, OUTPUT_DELTA_MAGIC, 4U) != 0))) {
+        fprintf(stderr, "Not a binary or change-only output log\n");
+        fclose(in);
+        return 1;
+    }
+    
+    out = fopen(argv[2], "w");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot create %s\n", argv[2]);
+        fclose(in);
+        return 1;
+    }
+    
+    ok = fputs(OUTPUT_LOG_CSV_HEADER, out) != EOF;
+    if (memcmp(magic, OUTPUT_LOG_MAGIC, 4U) == 0) {
+        ok = ok && convert_binary(in, out, start_ms, &record_count);
+    } else {
+        ok = ok && convert_delta(in, out, start_ms, &record_count);
+    }
+    fclose(in);
+    if (fclose(out) != 0) {
+        ok = false;
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "Failed converting %s\n", argv[1]);
+        (void)remove(argv[2]);
+        return 1;
+    }
+    
+    printf("%s: %llu ticks decoded\n", argv[2], (unsigned long long)record_count);
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include "scenario.h"
+#include "scenario_bin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Converts a scenario CSV into the compiled columnar format. Two passes
+ * over the input keep memory bounded: the first sizes every section, the
+ * second streams each column through its own buffer into its region. */
+
+#define COMPILE_BUF_SIZE (65536U)
+
+typedef struct {
+    uint64_t file_offset;
+    uint32_t fill;
+    uint8_t buf[COMPILE_BUF_SIZE];
+} section_writer_t;
+
+static section_writer_t columns[SCENARIO_BIN_NUM_COLUMNS];
+static section_writer_t voice_index;
+static section_writer_t voice_strings;
+
+#define COLUMN_SIZE_ENTRY(name, type) sizeof(type),
+
+static const size_t column_size[SCENARIO_BIN_NUM_COLUMNS] = {
+    SCENARIO_BIN_COLUMNS(COLUMN_SIZE_ENTRY)
+};
+
+static uint64_t align_up(uint64_t offset) {
+    return (offset + (SCENARIO_BIN_ALIGN - 1U)) & ~((uint64_t)SCENARIO_BIN_ALIGN - 1U);
+}
+
+static bool flush_section(FILE* out, section_writer_t* section) {
+    if (section->fill == 0U) {
+        return true;
+    }
+    
+    if ((fseek(out, (long)section->file_offset, SEEK_SET) != 0) ||
+        (fwrite(section->buf, 1U, section->fill, out) != section->fill)) {
+        return false;
+    }
+    
+    section->file_offset += section->fill;
+    section->fill = 0U;
+    return true;
+}
+
+static bool append(FILE* out, section_writer_t* section, const void* data, size_t len) {
+    if (((size_t)section->fill + len) > COMPILE_BUF_SIZE) {
+        if (!flush_section(out, section)) {
+            return false;
+        }
+    }
+    
+    memcpy(&section->buf[section->fill], data, len);
+    section->fill += (uint32_t)len;
+    return true;
+}
+
+static bool count_rows(const char* path, scenario_bin_header_t* hdr) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    
+    if (!scenario_reader_open(&reader, path)) {
+        return false;
+    }
+    hdr->channels = scenario_reader_channels(&reader);
+    
+    while (scenario_reader_next(&reader, &row)) {
+        if (row.sampled != (uint32_t)SCENARIO_SAMPLED_ALL) {
+            /* Compiled columns have no notion of a missing sample. */
+            fprintf(stderr, "Row %u is multi-rate (empty cells); only full-rate "
+                    "recordings can be compiled\n", hdr->row_count);
+            scenario_reader_close(&reader);
+            return false;
+        }
+        if (hdr->row_count == UINT32_MAX) {
+            scenario_reader_close(&reader);
+            return false;
+        }
+        hdr->row_count++;
+        if (row.voice_cmd[0] != '\0') {
+            hdr->voice_count++;
+            hdr->voice_strings_len += strlen(row.voice_cmd) + 1U;
+        }
+    }
+    
+    scenario_reader_close(&reader);
+    return true;
+}
+
+static void lay_out(scenario_bin_header_t* hdr) {
+    uint64_t offset = align_up(sizeof(scenario_bin_header_t));
+    uint32_t c = 0U;
+    
+    memcpy(hdr->magic, SCENARIO_BIN_MAGIC, 4U);
+    hdr->version = SCENARIO_BIN_VERSION;
+    hdr->byte_order = SCENARIO_BIN_BYTE_ORDER;
+    hdr->num_columns = (uint32_t)SCENARIO_BIN_NUM_COLUMNS;
+    
+    for (c = 0U; c < (uint32_t)SCENARIO_BIN_NUM_COLUMNS; c++) {
+        hdr->column_offset[c] = offset;
+        columns[c].file_offset = offset;
+        offset = align_up(offset + ((uint64_t)hdr->row_count * column_size[c]));
+    }
+    
+    hdr->voice_index_offset = offset;
+    voice_index.file_offset = offset;
+    offset = align_up(offset + ((uint64_t)hdr->voice_count * sizeof(scenario_bin_voice_t)));
+    
+    hdr->voice_strings_offset = offset;
+    voice_strings.file_offset = offset;
+    hdr->file_size = offset + hdr->voice_strings_len;
+}
+
+#define APPEND_COLUMN(name, type) \
+    value_##name = (type)row.name; \
+    ok = ok && append(out, &columns[SCENARIO_COL_##name], &value_##name, sizeof(type));
+#define DECLARE_COLUMN(name, type) type value_##name = 0;
+
+static bool write_rows(const char* path, FILE* out) {
+    scenario_reader_t reader;
+    scenario_row_t row;
+    scenario_bin_voice_t voice;
+    uint32_t row_index = 0U;
+    uint32_t string_offset = 0U;
+    size_t voice_len = 0U;
+    bool ok = true;
+    uint32_t c = 0U;
+    SCENARIO_BIN_COLUMNS(DECLARE_COLUMN)
+    
+    if (!scenario_reader_open(&reader, path)) {
+        return false;
+    }
+    
+    while (ok && scenario_reader_next(&reader, &row)) {
+        SCENARIO_BIN_COLUMNS(APPEND_COLUMN)
+        
+        if (row.voice_cmd[0] != '\0') {
+            voice_len = strlen(row.voice_cmd) + 1U;
+            voice.row = row_index;
+            voice.string_offset = string_offset;
+            ok = ok && append(out, &voice_index, &voice, sizeof(voice));
+            ok = ok && append(out, &voice_strings, row.voice_cmd, voice_len);
+            string_offset += (uint32_t)voice_len;
+        }
+        row_index++;
+    }
+    scenario_reader_close(&reader);
+    
+    for (c = 0U; c < (uint32_t)SCENARIO_BIN_NUM_COLUMNS; c++) {
+        ok = ok && flush_section(out, &columns[c]);
+    }
+    ok = ok && flush_section(out, &voice_index);
+    ok = ok && flush_section(out, &voice_strings);
+    
+    return ok;
+}
+
+/* Pads the file out to file_size so the last column's alignment gap and an
+ * empty voice table still leave a file of the advertised length. */
+static bool finish_file(FILE* out, const scenario_bin_header_t* hdr) {
+    static const uint8_t zero = 0U;
+    
+    if (fseek(out, 0L, SEEK_END) != 0) {
+        return false;
+    }
+    while ((uint64_t)ftell(out) < hdr->file_size) {
+        if (fwrite(&zero, 1U, 1U, out) != 1U) {
+            return false;
+        }
+    }
+    
+    return (fseek(out, 0L, SEEK_SET) == 0) &&
+           (fwrite(hdr, sizeof(scenario_bin_header_t), 1U, out) == 1U);
+}
+
+int main(int argc, char* argv[]) {
+    scenario_bin_header_t hdr;
+    FILE* out = NULL;
+    bool ok = false;
+    
+    if (argc != 3) {
+        printf("Usage: %s <scenario.csv> <scenario.scnb>\n", argv[0]);
+        return 1;
+    }
+    
+    memset(&hdr, 0, sizeof(hdr));
+    if (!count_rows(argv[1], &hdr)) {
+        fprintf(stderr, "Cannot read scenario %s\n", argv[1]);
+        return 1;
+    }
+    lay_out(&hdr);
+    
+    out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot create %s\n", argv[2]);
+        return 1;
+    }
+    
+    ok = write_rows(argv[1], out) && finish_file(out, &hdr);
+    if (fclose(out) != 0) {
+        ok = false;
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "Failed writing %s\n", argv[2]);
+        (void)remove(argv[2]);
+        return 1;
+    }
+    
+    printf("%s: %u rows, %u voice commands, %llu bytes\n", argv[2],
+           hdr.row_count, hdr.voice_count, (unsigned long long)hdr.file_size);
+    return 0;
+}